@@ -130,6 +130,7 @@ globCopy(project_root + "/Libraries/pd-else/Abstractions/Extra/*.pd_lua", "./Abs
 copyFile(project_root + "/Resources/Patches/lua.pd_lua", "./Abstractions/else")
 copyFile(project_root + "/Resources/Patches/playhead.pd", "./Abstractions")
 copyFile(project_root + "/Resources/Patches/param.pd", "./Abstractions")
+copyFile(project_root + "/Resources/Patches/param~.pd", "./Abstractions")
 copyFile(project_root + "/Resources/Patches/daw_storage.pd", "./Abstractions")
 copyFile(project_root + "/Resources/Patches/plugin_latency.pd", "./Abstractions")
 # copyFile("../../Patches/beat.pd", "./Abstractions")
@@ -140,6 +141,7 @@ copyFile(project_root + "/Libraries/pd-else/Documentation/Extra-files/f2s~-help.
 
 # copyFile("../../Patches/beat-help.pd", "./Documentation/5.reference")
 copyFile(project_root + "/Resources/Patches/param-help.pd", "./Documentation/5.reference")
+copyFile(project_root + "/Resources/Patches/param~-help.pd", "./Documentation/5.reference")
 copyFile(project_root + "/Resources/Patches/playhead-help.pd", "./Documentation/5.reference")
 copyFile(project_root + "/Resources/Patches/daw_storage-help.pd", "./Documentation/5.reference")
 copyFile(project_root + "/Resources/Patches/plugin_latency-help.pd", "./Documentation/5.reference")
@@ -356,7 +358,7 @@ resources = [
     project_root + "/Resources/Fonts/RobotoMono-Bold.ttf",
     project_root + "/Resources/Icons/plugdata_large_logo.png",
     project_root + "/Resources/Icons/plugdata_logo.png",
-    "Documentation.bin",
+    "DocumentationIndex.bin",
     "Filesystem"
 ]
 
@@ -1,17 +1,149 @@
-# Converts our json documentation to a compact binary format
+# Converts our json documentation to a flat binary index, that plugdata can memory-map and read without parsing
+#
+# All integers are little-endian uint32. Section offsets are from the start of the file, string offsets are from the start of the string section
+#
+#   header:     magic "PDDI", version, number of objects, offsets of the object, item, iolet, category, name index and
+#               string sections, capacity of the name index, size of the string section, reserved
+#   objects:    title, description, origin, first category, number of categories, first inlet, number of inlets,
+#               first outlet, number of outlets, first argument, number of arguments, first method, number of methods,
+#               first flag, number of flags
+#   items:      type, description. Used for arguments, methods, flags and iolet messages
+#   iolets:     tooltip, repeating, first message, number of messages
+#   categories: name
+#   name index: open addressing hash table of (FNV-1a hash of the name, object index + 1), where 0 means the slot is empty
+#   strings:    deduplicated, NUL-terminated UTF-8
 
 import os
 import sys
-import lzma
 import json
+import struct
 
-def writeInt(stream, n):
-    stream += n.to_bytes(4, 'little')
+MAGIC = b"PDDI"
+VERSION = 1
+HEADER_SIZE = 12 * 4
+OBJECT_SIZE = 15 * 4
+ITEM_SIZE = 2 * 4
+IOLET_SIZE = 4 * 4
 
-def writeString(stream, s):
-    stream += s.encode('utf-8') + b'\x00'
+class DocumentationIndex:
+    def __init__(self):
+        self.objects = []
+        self.items = []
+        self.iolets = []
+        self.categories = []
+        self.names = {}
+        self.strings = bytearray(b"\x00")
+        self.string_offsets = { "": 0 }
 
-def writeObjectReferenceTable(stream, json_dir):
+    def addString(self, s):
+        if s not in self.string_offsets:
+            self.string_offsets[s] = len(self.strings)
+            self.strings += s.encode('utf-8') + b'\x00'
+        return self.string_offsets[s]
+
+    def addItems(self, items):
+        first = len(self.items)
+        for item_type, description in items:
+            self.items.append((self.addString(item_type), self.addString(description)))
+        return first, len(items)
+
+    def addIolets(self, iolets):
+        first = len(self.iolets)
+        for iolet in iolets:
+            messages = iolet.get("messages", [])
+            tooltip = ""
+            for msg in messages:
+                tooltip += "(" + msg.get("type", "") + ") " + msg.get("description", "") + "\n"
+            first_message, num_messages = self.addItems([(msg.get("type", ""), msg.get("description", "")) for msg in messages])
+            self.iolets.append((self.addString(tooltip), int(iolet.get("repeat", False)), first_message, num_messages))
+        return first, len(iolets)
+
+    # Same rules plugdata used when it built this index at runtime
+    def addNames(self, title, origin, index):
+        if origin == "":
+            self.names[fnv1a(title)] = index
+        elif origin == "Gem":
+            self.names[fnv1a(origin + "/" + title)] = index
+        elif origin == "MERDA":
+            self.names[fnv1a("ELSE/" + title)] = index
+        elif fnv1a(title) in self.names:
+            self.names[fnv1a(origin + "/" + title)] = index
+        else:
+            self.names[fnv1a(title)] = index
+            self.names[fnv1a(origin + "/" + title)] = index
+
+    def addObject(self, title, obj):
+        origin = obj.get("origin", "")
+
+        first_category = len(self.categories)
+        categories = obj.get("categories", [])
+        for cat in categories:
+            self.categories.append(self.addString(cat))
+
+        inlets = self.addIolets(obj.get("inlets", []))
+        outlets = self.addIolets(obj.get("outlets", []))
+
+        item_lists = []
+        for key in ("arguments", "methods", "flags"):
+            items = []
+            for item in obj.get(key, []):
+                description = item.get("description", "")
+                default = item.get("default", "")
+                if default and not "(default:" in description:
+                    description += " (default: " + default + ")"
+                items.append((item.get("type", "") or item.get("name", ""), description))
+            item_lists.append(self.addItems(items))
+
+        self.addNames(title, origin, len(self.objects))
+        self.objects.append((self.addString(title), self.addString(obj.get("description", "")), self.addString(origin),
+            first_category, len(categories), *inlets, *outlets, *item_lists[0], *item_lists[1], *item_lists[2]))
+
+    def write(self, path):
+        capacity = 16
+        while capacity < len(self.names) * 2:
+            capacity *= 2
+
+        name_index = [(0, 0)] * capacity
+        for name_hash, index in self.names.items():
+            slot = name_hash & (capacity - 1)
+            while name_index[slot][1] != 0:
+                slot = (slot + 1) & (capacity - 1)
+            name_index[slot] = (name_hash, index + 1)
+
+        objects_offset = HEADER_SIZE
+        items_offset = objects_offset + len(self.objects) * OBJECT_SIZE
+        iolets_offset = items_offset + len(self.items) * ITEM_SIZE
+        categories_offset = iolets_offset + len(self.iolets) * IOLET_SIZE
+        name_index_offset = categories_offset + len(self.categories) * 4
+        strings_offset = name_index_offset + capacity * 8
+
+        stream = bytearray()
+        stream += MAGIC
+        stream += struct.pack("<11I", VERSION, len(self.objects), objects_offset, items_offset, iolets_offset, categories_offset,
+            name_index_offset, strings_offset, capacity, len(self.strings), 0)
+        for record in self.objects:
+            stream += struct.pack("<15I", *record)
+        for record in self.items:
+            stream += struct.pack("<2I", *record)
+        for record in self.iolets:
+            stream += struct.pack("<4I", *record)
+        for category in self.categories:
+            stream += struct.pack("<I", category)
+        for entry in name_index:
+            stream += struct.pack("<2I", *entry)
+        stream += self.strings
+
+        with open(path, "wb") as f:
+            f.write(stream)
+
+def fnv1a(s):
+    result = 0x811c9dc5
+    for byte in s.encode('utf-8'):
+        result ^= byte
+        result = (result * 0x01000193) & 0xffffffff
+    return result
+
+def parseObjectReferenceTables(index, json_dir):
     for filename in os.listdir(json_dir):
         if not filename.endswith(b".json"):
             continue
@@ -23,50 +155,17 @@ def writeObjectReferenceTable(stream, json_dir):
             titles = [titles]
 
         for title in titles:
-            writeString(stream, title)
-            writeString(stream, obj.get("description", ""))
-            writeString(stream, obj.get("origin", ""))
-
-            categories = obj.get("categories", [])
-            writeInt(stream, len(categories))
-            for cat in categories:
-                writeString(stream, cat)
-
-            for key in ("inlets", "outlets"):
-                iolets = obj.get(key, [])
-                writeInt(stream, len(iolets))
-                for iolet in iolets:
-                    stream += int(iolet.get("repeat", False)).to_bytes(1, 'little')
-                    messages = iolet.get("messages", [])
-                    writeInt(stream, len(messages))
-                    tooltip = ""
-                    for msg in messages:
-                        tooltip += "(" + msg.get("type", "") + ") " + msg.get("description", "") + "\n";
-                        writeString(stream, msg.get("type", ""))
-                        writeString(stream, msg.get("description", ""))
-                    writeString(stream, tooltip)
-
-            for key in ("arguments", "methods", "flags"):
-                items = obj.get(key, [])
-                writeInt(stream, len(items))
-                for item in items:
-                    writeString(stream, item.get("type", "") or item.get("name", ""))
-                    description = item.get("description", "")
-                    default = item.get("default", "")
-                    if default and not "(default:" in description:
-                        description += " (default: " + default + ")"
-                    writeString(stream, description)
+            index.addObject(title, obj)
 
 def parseFilesInDir(dir):
     directory = os.fsencode(dir)
-    stream = bytearray()
+    index = DocumentationIndex()
     for origin in os.listdir(directory):
         originPath = os.path.join(directory, origin)
         if os.path.isdir(originPath):
-            writeObjectReferenceTable(stream, originPath)
+            parseObjectReferenceTables(index, originPath)
 
     output_dir = sys.argv[1]
-    with lzma.open(output_dir + "/Documentation.bin", "wb", preset=9) as compressed_file:
-        compressed_file.write(stream)
+    index.write(output_dir + "/DocumentationIndex.bin")
 
 parseFilesInDir("../Documentation")
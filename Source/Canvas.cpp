@@ -803,7 +803,9 @@ void Canvas::performRender(NVGcontext* nvg, Rectangle<int> invalidRegion)
 
 void Canvas::renderAllObjects(NVGcontext* nvg, Rectangle<int> const area)
 {
-    for (auto* obj : objects) {
+    objectSpatialIndex.query(area, visibleObjects);
+
+    for (auto* obj : visibleObjects) {
         {
             auto b = obj->getBounds();
             if (b.intersects(area) && obj->isVisible()) {
@@ -826,7 +828,9 @@ void Canvas::renderAllConnections(NVGcontext* nvg, Rectangle<int> const area)
     SmallArray<Connection*> connectionsToDrawSelected;
     Connection* hovered = nullptr;
 
-    for (auto* connection : connections) {
+    connectionSpatialIndex.query(area, visibleConnections);
+
+    for (auto* connection : visibleConnections) {
         NVGScopedState scopedState(nvg);
         if (connection->intersectsRectangle(area) && connection->isVisible()) {
             if (connection->isMouseHovering())
@@ -1077,6 +1081,32 @@ void Canvas::synchroniseSplitCanvas()
 
 // Synchronise state with pure-data
 // Used for loading and for complicated actions like undo/redo
+// Plain text boxes have no state in pd other than their position, width, text and iolets, and the font size of the patch
+// So for those, we can tell whether anything changed without updating them. Other objects get an empty state, and are always updated
+static void getTextObjectState(t_gobj* gobj, int const fontSize, Object::SyncedState& state)
+{
+    state.clear();
+    if (!gobj || !pd::Interface::isTextObject(gobj))
+        return;
+
+    auto* obj = pd::Interface::checkObject(gobj);
+    if (!obj)
+        return;
+
+    auto const argc = obj->te_binbuf ? binbuf_getnatom(obj->te_binbuf) : 0;
+    auto const* argv = obj->te_binbuf ? binbuf_getvec(obj->te_binbuf) : nullptr;
+
+    // The fields themselves rather than a hash of them, so no change can ever be mistaken for no change
+    state.add_array(std::initializer_list<int64> { obj->te_xpix, obj->te_ypix, obj->te_width, obj->te_type, fontSize, pd::Interface::numInlets(obj), pd::Interface::numOutlets(obj), argc });
+    for (int i = 0; i < argc; i++) {
+        state.add(argv[i].a_type);
+        if (argv[i].a_type == A_FLOAT)
+            state.add(std::bit_cast<uint32>(static_cast<float>(argv[i].a_w.w_float)));
+        else
+            state.add(static_cast<int64>(reinterpret_cast<intptr_t>(argv[i].a_w.w_symbol)));
+    }
+}
+
 void Canvas::performSynchronise()
 {
     static bool alreadyFlushed = false;
@@ -1112,66 +1142,119 @@ void Canvas::performSynchronise()
     auto pdObjects = patch.getObjects();
     objects.reserve(pdObjects.size());
 
-    for (auto object : pdObjects) {
-        auto const* it = std::ranges::find_if(objects, [&object](Object const* b) { return b->getPointer() && b->getPointer() == object.getRawUnchecked<void>(); });
+    // Index our objects by their pd pointer, so we don't need to search through all objects for every pd object
+    objectIndex.clear();
+    for (auto* object : objects) {
+        if (auto* ptr = object->getPointer())
+            objectIndex[ptr] = object;
+    }
+
+    // Restacking and sorting is expensive, so only do it when objects we already had changed order in pd, or when new objects
+    // were inserted below existing ones. Deleting objects, or adding them on top, keeps our order the same as pd's
+    bool orderChanged = false;
+    {
+        bool hadNewObject = false;
+        int lastPosition = -1;
+        for (int i = 0; i < pdObjects.size() && !orderChanged; i++) {
+            auto* ptr = pdObjects[i].getRawUnchecked<void>();
+            if (!pdObjects[i].isValid() || !objectIndex.contains(ptr)) {
+                hadNewObject = true;
+                continue;
+            }
+
+            auto const lastSync = pdObjectPositions.find(ptr);
+            orderChanged = hadNewObject || lastSync == pdObjectPositions.end() || lastSync->second < lastPosition;
+            if (lastSync != pdObjectPositions.end())
+                lastPosition = lastSync->second;
+        }
+    }
+
+    pdObjectPositions.clear();
+    lastSyncedOrder.clear();
+
+    auto const fontSize = glist_getfont(patch.getRawPointer());
+    Object::SyncedState syncedState;
+    for (auto& object : pdObjects) {
+        auto* ptr = object.getRawUnchecked<void>();
+        pdObjectPositions[ptr] = lastSyncedOrder.size();
+        lastSyncedOrder.add(ptr);
+
         if (!object.isValid())
             continue;
 
-        if (it == objects.end()) {
+        if (auto const it = objectIndex.find(ptr); it == objectIndex.end()) {
             auto* newObject = objects.add(object, this);
+            objectIndex[ptr] = newObject;
+            getTextObjectState(object.getRaw<t_gobj>(), fontSize, newObject->lastSyncedState);
             newObject->toFront(false);
 
             if (newObject->gui && newObject->gui->getLabel())
                 newObject->gui->getLabel()->toFront(false);
         } else {
-            auto* object = *it;
+            auto* existingObject = it->second;
 
-            // Check if number of inlets/outlets is correct
-            object->updateIolets();
-            object->updateBounds();
+            if (orderChanged) {
+                existingObject->toFront(false);
+                if (existingObject->gui && existingObject->gui->getLabel())
+                    existingObject->gui->getLabel()->toFront(false);
+            }
+
+            // Text boxes that didn't change in pd don't need to be updated
+            getTextObjectState(object.getRaw<t_gobj>(), fontSize, syncedState);
+            if (!syncedState.empty() && syncedState == existingObject->lastSyncedState)
+                continue;
 
-            object->toFront(false);
-            if (object->gui && object->gui->getLabel())
-                object->gui->getLabel()->toFront(false);
+            std::swap(existingObject->lastSyncedState, syncedState);
 
-            if (object->gui)
-                object->gui->updateProperties();
+            // Check if number of inlets/outlets is correct
+            existingObject->updateIolets();
+            existingObject->updateBounds();
+
+            if (existingObject->gui)
+                existingObject->gui->updateProperties();
         }
     }
 
-    // Make sure objects have the same order
-    std::ranges::sort(objects,
-        [&pdObjects](Object const* first, Object const* second) mutable {
-            return pdObjects.index_of(first->getPointer()) < pdObjects.index_of(second->getPointer());
-        });
+    if (orderChanged) {
+        // Make sure objects have the same order
+        std::ranges::sort(objects,
+            [this](Object const* first, Object const* second) {
+                auto const firstPosition = pdObjectPositions.find(first->getPointer());
+                auto const secondPosition = pdObjectPositions.find(second->getPointer());
+                return (firstPosition == pdObjectPositions.end() ? -1 : firstPosition->second) < (secondPosition == pdObjectPositions.end() ? -1 : secondPosition->second);
+            });
+
+        // Spatial index queries return objects in this order, so rendering keeps the same stacking
+        // Otherwise, new objects were added on top, which is where the spatial index puts them already
+        for (int i = 0; i < objects.size(); i++) {
+            objectSpatialIndex.setOrder(objects[i], i);
+        }
+    }
 
     auto pdConnections = isGraph ? pd::Connections() : patch.getConnections();
     connections.reserve(pdConnections.size());
 
+    connectionIndex.clear();
+    for (auto* connection : connections) {
+        connectionIndex[connection->getPointer()] = connection;
+    }
+
     for (auto& connection : pdConnections) {
         auto& [ptr, inno, inobj, outno, outobj] = connection;
 
         Iolet *inlet = nullptr, *outlet = nullptr;
 
         // Find the objects that this connection is connected to
-        for (auto* obj : objects) {
-            if (outobj && &outobj->te_g == obj->getPointer()) {
-
-                // Check if we have enough outlets, should never return false
-                if (isPositiveAndBelow(obj->numInputs + outno, obj->iolets.size())) {
-                    outlet = obj->iolets[obj->numInputs + outno];
-                } else {
-                    break;
-                }
+        if (auto const it = outobj ? objectIndex.find(&outobj->te_g) : objectIndex.end(); it != objectIndex.end()) {
+            // Check if we have enough outlets, should never return false
+            if (auto* obj = it->second; isPositiveAndBelow(obj->numInputs + outno, obj->iolets.size())) {
+                outlet = obj->iolets[obj->numInputs + outno];
             }
-            if (inobj && &inobj->te_g == obj->getPointer()) {
-
-                // Check if we have enough inlets, should never return false
-                if (isPositiveAndBelow(inno, obj->iolets.size())) {
-                    inlet = obj->iolets[inno];
-                } else {
-                    break;
-                }
+        }
+        if (auto const it = inobj ? objectIndex.find(&inobj->te_g) : objectIndex.end(); it != objectIndex.end()) {
+            // Check if we have enough inlets, should never return false
+            if (auto* obj = it->second; isPositiveAndBelow(inno, obj->iolets.size())) {
+                inlet = obj->iolets[inno];
             }
         }
 
@@ -1181,23 +1264,16 @@ void Canvas::performSynchronise()
             continue;
         }
 
-        auto const* it = std::ranges::find_if(connections,
-            [c_ptr = ptr](auto* c) {
-                return c_ptr == c->getPointer();
-            });
-
-        if (it == connections.end()) {
+        if (auto const it = connectionIndex.find(ptr); it == connectionIndex.end()) {
             connections.add(this, inlet, outlet, ptr);
-        } else {
+        } else if (auto* c = it->second; c->inlet != inlet || c->outlet != outlet) {
             // This is necessary to make resorting a subpatchers iolets work
             // And it can't hurt to check if the connection is valid anyway
-            if (auto& c = **it; c.inlet != inlet || c.outlet != outlet) {
-                int const idx = connections.index_of(*it);
-                connections.remove_one(*it);
-                connections.insert(idx, this, inlet, outlet, ptr);
-            } else {
-                c.popPathState();
-            }
+            int const idx = connections.index_of(c);
+            connections.remove_one(c);
+            connections.insert(idx, this, inlet, outlet, ptr);
+        } else {
+            c->popPathState();
         }
     }
 
@@ -1213,7 +1289,7 @@ void Canvas::performSynchronise()
 
     needsSearchUpdate = true;
 
-    pd->updateObjectImplementations();
+    pd->updateObjectImplementations(patch.getUncheckedPointer());
     cancelPendingUpdate(); // if an update got retriggered, cancel it
 }
 
@@ -1407,8 +1483,10 @@ void Canvas::mouseDrag(MouseEvent const& e)
         bool hasToggled = false;
 
         // Behaviour for dragging over toggles, bang and radiogroup to toggle them
-        for (auto const* object : objects) {
-            if (!object->getBounds().contains(e.getEventRelativeTo(this).getPosition()) || !object->gui)
+        auto const position = e.getEventRelativeTo(this).getPosition();
+        objectSpatialIndex.query(position, visibleObjects);
+        for (auto const* object : visibleObjects) {
+            if (!object->getBounds().contains(position) || !object->gui)
                 continue;
 
             if (auto* obj = object->gui.get()) {
@@ -2652,27 +2730,36 @@ void Canvas::findLassoItemsInArea(Array<WeakReference<Component>>& itemsFound, R
 {
     auto const lassoBounds = area.withWidth(jmax(2, area.getWidth())).withHeight(jmax(2, area.getHeight()));
 
+    auto const anyModifiersDown = ModifierKeys::getCurrentModifiers().isAnyModifierKeyDown();
+
+    // Only items that are inside the lasso, or that are still selected, need to be checked
     if (!altDown) { // Alt enable connection only mode
-        for (auto* object : objects) {
+        objectSpatialIndex.query(lassoBounds, visibleObjects);
+        for (auto* object : visibleObjects) {
             if (lassoBounds.intersects(object->getSelectableBounds())) {
                 itemsFound.add(object);
-            } else if (!ModifierKeys::getCurrentModifiers().isAnyModifierKeyDown()) {
-                setSelected(object, false, false);
+            }
+        }
+
+        if (!anyModifiersDown) {
+            for (auto* object : getSelectionOfType<Object>()) {
+                if (!lassoBounds.intersects(object->getSelectableBounds()))
+                    setSelected(object, false, false);
             }
         }
     }
 
-    auto const anyModifiersDown = ModifierKeys::getCurrentModifiers().isAnyModifierKeyDown();
     auto const canSelectConnections = itemsFound.isEmpty() || anyModifiersDown;
 
-    for (auto const& connection : connections) {
-        // If total bounds don't intersect, there can't be an intersection with the line
-        // This is cheaper than checking the path intersection, so do this first
-        if (!connection->getBounds().intersects(lassoBounds)) {
+    // If total bounds don't intersect, there can't be an intersection with the line
+    // This is cheaper than checking the path intersection, so do this first
+    for (auto* connection : getSelectionOfType<Connection>()) {
+        if (!connection->getBounds().intersects(lassoBounds))
             setSelected(connection, false, false);
-            continue;
-        }
+    }
 
+    connectionSpatialIndex.query(lassoBounds, visibleConnections);
+    for (auto* connection : visibleConnections) {
         // Check if path intersects with lasso
         if (canSelectConnections && connection->intersects(lassoBounds.toFloat())) {
             itemsFound.add(connection);
@@ -2713,7 +2800,7 @@ bool Canvas::panningModifierDown() const
     return isPanDragKeysActive || ModifierKeys::getCurrentModifiers().isMiddleButtonDown();
 }
 
-void Canvas::receiveMessage(t_symbol* symbol, SmallArray<pd::Atom> const& atoms)
+void Canvas::receiveMessage(t_symbol* symbol, std::span<pd::Atom const> atoms)
 {
     switch (hash(symbol->s_name)) {
     case hash("sync"):
@@ -26,6 +26,7 @@ using namespace juce::gl;
 #include "NVGSurface.h"
 #include "Utility/NVGUtils.h"
 #include "Utility/GlobalMouseListener.h"
+#include "Utility/SpatialIndex.h"
 
 namespace pd {
 class Patch;
@@ -180,7 +181,7 @@ public:
 
     ObjectParameters& getInspectorParameters();
 
-    void receiveMessage(t_symbol* symbol, SmallArray<pd::Atom> const& atoms) override;
+    void receiveMessage(t_symbol* symbol, std::span<pd::Atom const> atoms) override;
 
     void activateCanvasSearchHighlight(Point<float> viewPos, Object* obj);
     void removeCanvasSearchHighlight();
@@ -216,6 +217,11 @@ public:
 
     // Needs to be allocated before object and connection so they can deselect themselves in the destructor
     SelectedItemSet<WeakReference<Component>> selectedComponents;
+
+    // Needs to be allocated before object and connection so they can remove themselves in the destructor
+    SpatialIndex<Object> objectSpatialIndex;
+    SpatialIndex<Connection> connectionSpatialIndex;
+
     PooledPtrArray<Object> objects;
     PooledPtrArray<Connection> connections;
     PooledPtrArray<ConnectionBeingCreated> connectionsBeingCreated;
@@ -347,5 +353,15 @@ private:
 
     std::unique_ptr<CanvasSearchHighlight> canvasSearchHighlight;
 
+    // Lookup tables for performSynchronise, kept around so we don't need to reallocate them on every sync
+    UnorderedMap<void*, Object*> objectIndex;
+    UnorderedMap<void*, int> pdObjectPositions;
+    UnorderedMap<t_outconnect*, Connection*> connectionIndex;
+    HeapArray<void*> lastSyncedOrder;
+
+    // Scratch space for spatial index queries while rendering
+    SmallArray<Object*> visibleObjects;
+    SmallArray<Connection*> visibleConnections;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Canvas)
 };
@@ -20,6 +20,7 @@ using namespace juce::gl;
 #include "PluginProcessor.h"
 #include "PluginEditor.h" // might not need this?
 #include "CanvasViewport.h"
+#include "Utility/ConnectionRouter.h"
 #include "Pd/Patch.h"
 #include "Components/ConnectionMessageDisplay.h"
 
@@ -117,6 +118,20 @@ Connection::~Connection()
     if (inobj) {
         inobj->removeComponentListener(this);
     }
+
+    cnv->connectionSpatialIndex.remove(this);
+}
+
+void Connection::moved()
+{
+    DrawablePath::moved();
+    cnv->connectionSpatialIndex.update(this, getBounds());
+}
+
+void Connection::resized()
+{
+    DrawablePath::resized();
+    cnv->connectionSpatialIndex.update(this, getBounds());
 }
 
 void Connection::changeListenerCallback(ChangeBroadcaster* source)
@@ -1064,206 +1079,91 @@ void Connection::findPath()
     if (!outlet || !inlet)
         return;
 
-    auto pstart = getStartPoint();
-    auto pend = getEndPoint();
-
-    auto pathStack = PathPlan();
-    auto bestPath = PathPlan();
-
-    pathStack.reserve(8);
-
-    auto numFound = 0;
-
-    auto const distance = pstart.getDistanceFrom(pend);
-    auto const distanceX = std::abs(pstart.x - pend.x);
-    auto const distanceY = std::abs(pstart.y - pend.y);
-
-    int const maxXResolution = std::clamp<int>(distanceX / 10, 6, 14);
-    int const maxYResolution = std::clamp<int>(distanceY / 10, 6, 14);
-
-    int resolutionX = 6;
-    int resolutionY = 6;
-
-    auto obstacles = SmallArray<Rectangle<float>>();
-    auto const searchBounds = Rectangle<float>(pstart, pend);
-
-    for (auto const* object : cnv->objects) {
-        if (object->getBounds().toFloat().intersects(searchBounds)) {
-            obstacles.add(object->getBounds().toFloat());
-        }
-    }
-
-    // Look for paths at an increasing resolution
-    while (!numFound && resolutionX < maxXResolution && distance > 40) {
-
-        // Find paths on a resolution*resolution lattice ObjectGrid
-        float incrementX = std::max<float>(1, distanceX / resolutionX);
-        float incrementY = std::max<float>(1, distanceY / resolutionY);
-
-        numFound = findLatticePaths(bestPath, pathStack, pend, pstart, { incrementX, incrementY });
-
-        if (resolutionX < maxXResolution)
-            resolutionX++;
-        if (resolutionY < maxXResolution)
-            resolutionY++;
-
-        if (resolutionX > maxXResolution || resolutionY > maxYResolution)
-            break;
-
-        pathStack.clear();
-    }
-
-    PathPlan simplifiedPath;
-
-    if (!bestPath.empty()) {
-        simplifiedPath.add(bestPath.front());
-
-        bool direction = approximatelyEqual(bestPath[0].x, bestPath[1].x);
-
-        if (!direction)
-            simplifiedPath.add(bestPath.front());
-
-        for (int n = 1; n < bestPath.size(); n++) {
-            if ((bestPath[n].x != bestPath[n - 1].x && direction) || (bestPath[n].y != bestPath[n - 1].y && !direction)) {
-                simplifiedPath.add(bestPath[n - 1]);
-                direction = !direction;
-            }
-        }
+    auto const pstart = getStartPoint();
+    auto const pend = getEndPoint();
 
-        simplifiedPath.add(bestPath.back());
+    ConnectionRouter router;
+    router.setObstacles(ConnectionPathUpdater::getObstacles(cnv, getRoutingArea()));
 
-        if (!direction)
-            simplifiedPath.add(bestPath.back());
-    } else {
-        if (pend.y < pstart.y) {
-            int const xHalfDistance = (pstart.x - pend.x) / 2;
-
-            simplifiedPath.add(pend); // double to make it draggable
-            simplifiedPath.add(pend);
-            simplifiedPath.emplace_back(pend.x + xHalfDistance, pend.y);
-            simplifiedPath.emplace_back(pend.x + xHalfDistance, pstart.y);
-            simplifiedPath.add(pstart);
-            simplifiedPath.add(pstart);
-        } else {
-            int const yHalfDistance = (pstart.y - pend.y) / 2;
-            simplifiedPath.add(pend);
-            simplifiedPath.emplace_back(pend.x, pend.y + yHalfDistance);
-            simplifiedPath.emplace_back(pstart.x, pend.y + yHalfDistance);
-            simplifiedPath.add(pstart);
-        }
-    }
-    std::ranges::reverse(simplifiedPath);
+    auto path = router.route(pstart, pend, outobj->getBounds(), inobj->getBounds());
+    if (path.empty())
+        path = ConnectionRouter::getDefaultPath(pstart, pend);
 
-    currentPlan = simplifiedPath;
+    currentPlan = path;
 
     pushPathState();
 }
 
-int Connection::findLatticePaths(PathPlan& bestPath, PathPlan& pathStack, Point<float> pend, Point<float> pstart, Point<float> increment)
+// Area that the router might need to look at to find a path for this connection
+Rectangle<int> Connection::getRoutingArea() const
 {
-    auto obstacles = SmallArray<Object*>();
-    auto const searchBounds = Rectangle<float>(pend, pstart);
-
-    for (auto* object : cnv->objects) {
-        if (object->getBounds().toFloat().intersects(searchBounds)) {
-            obstacles.add(object);
-        }
-    }
-
-    // Stop after we've found a path
-    if (!bestPath.empty())
-        return 0;
+    auto const area = outobj->getBounds().getUnion(inobj->getBounds()).toFloat().getUnion(Rectangle<float>(getStartPoint(), getEndPoint()));
+    return area.expanded(ConnectionRouter::searchMargin + ConnectionRouter::clearance).getSmallestIntegerContainer();
+}
 
-    // Add point to path
-    pathStack.add(pend);
+SmallArray<Rectangle<int>> ConnectionPathUpdater::getObstacles(Canvas* cnv, Rectangle<int> const area)
+{
+    SmallArray<Object*> objects;
+    cnv->objectSpatialIndex.query(area, objects);
 
-    // Check if it intersects any object
-    if (pathStack.size() > 1 && straightLineIntersectsObject(Line<float>(pathStack.back(), *(pathStack.end() - 2)), obstacles)) {
-        return 0;
+    SmallArray<Rectangle<int>> obstacles;
+    obstacles.reserve(objects.size());
+    for (auto const* object : objects) {
+        obstacles.add(object->getBounds());
     }
+    return obstacles;
+}
 
-    bool const endVertically = pathStack[0].y > pstart.y;
+void ConnectionPathUpdater::routeConnections(SmallArray<Connection*> const& connections)
+{
+    RoutingBatch batch;
+    Rectangle<int> area;
 
-    // Check if we've reached the destination
-    if (std::abs(pend.x - pstart.x) < increment.x * 0.5 && std::abs(pend.y - pstart.y) < increment.y * 0.5) {
-        bestPath = pathStack;
-        return 1;
+    for (auto* connection : connections) {
+        if (!connection->inlet || !connection->outlet)
+            continue;
+
+        auto const start = connection->getStartPoint();
+        auto const end = connection->getEndPoint();
+        batch.requests.add({ connection, start, end, connection->outobj->getBounds(), connection->inobj->getBounds() });
+        area = area.isEmpty() ? connection->getRoutingArea() : area.getUnion(connection->getRoutingArea());
     }
 
-    // Count the number of found paths
-    int count = 0;
+    if (batch.requests.empty())
+        return;
 
-    // Get current stack to revert to after each trial
-    auto pathCopy = pathStack;
+    // Gather the obstacles once for the whole batch, so the router thread doesn't need to touch any components
+    batch.obstacles = getObstacles(canvas, area);
 
-    auto followLine = [this, &count, &pathCopy, &bestPath, &pathStack, &increment](Point<float> currentOutlet, Point<float> const currentInlet, bool const isX) {
-        auto& coord1 = isX ? currentOutlet.x : currentOutlet.y;
-        auto const& coord2 = isX ? currentInlet.x : currentInlet.y;
-        auto const& incr = isX ? increment.x : increment.y;
+    routerPool->addJob([canvas = Component::SafePointer(canvas), batch = std::move(batch)]() mutable {
+        ConnectionRouter router;
+        router.setObstacles(batch.obstacles);
 
-        if (std::abs(coord1 - coord2) >= incr) {
-            coord1 > coord2 ? coord1 -= incr : coord1 += incr;
-            count += findLatticePaths(bestPath, pathStack, currentOutlet, currentInlet, increment);
-            pathStack = pathCopy;
+        for (auto& request : batch.requests) {
+            request.path = router.route(request.start, request.end, request.startObject, request.endObject);
+            if (request.path.empty())
+                request.path = ConnectionRouter::getDefaultPath(request.start, request.end);
         }
-    };
 
-    // If we're halfway on the axis, change preferred direction by inverting search order
-    // This will make it do a staircase effect
-    if (endVertically) {
-        if (std::abs(pend.y - pstart.y) >= std::abs(pathStack[0].y - pstart.y) * 0.5) {
-            followLine(pend, pstart, false);
-            followLine(pend, pstart, true);
-        } else {
-            followLine(pend, pstart, true);
-            followLine(pend, pstart, false);
-        }
-    } else {
-        if (std::abs(pend.x - pstart.x) >= std::abs(pathStack[0].x - pstart.x) * 0.5) {
-            followLine(pend, pstart, true);
-            followLine(pend, pstart, false);
-        } else {
-            followLine(pend, pstart, false);
-            followLine(pend, pstart, true);
-        }
-    }
+        MessageManager::callAsync([canvas, requests = std::move(batch.requests)] {
+            if (!canvas)
+                return;
 
-    return count;
-}
-
-bool Connection::straightLineIntersectsObject(Line<float> const toCheck, SmallArray<Object*>& objects) const
-{
+            for (auto const& request : requests) {
+                auto* connection = request.connection.getComponent();
 
-    for (auto const& object : objects) {
-        auto bounds = object->getBounds().expanded(1);
-
-        if (object == outobj || object == inobj || !bounds.intersects(getBounds()))
-            continue;
-
-        auto intersectV = [](Line<float> first, Line<float> second) {
-            if (first.getStartY() > first.getEndY()) {
-                first = { first.getEnd(), first.getStart() };
-            }
-
-            return first.getStartX() > second.getStartX() && first.getStartX() < second.getEndX() && second.getStartY() > first.getStartY() && second.getStartY() < first.getEndY();
-        };
+                // Skip connections that were moved while we were busy, the path would no longer fit
+                if (!connection || !connection->inlet || !connection->outlet || connection->getStartPoint() != request.start || connection->getEndPoint() != request.end)
+                    continue;
 
-        auto intersectH = [](Line<float> first, Line<float> second) {
-            if (first.getStartX() > first.getEndX()) {
-                first = { first.getEnd(), first.getStart() };
+                connection->segmented = true;
+                connection->currentPlan = request.path;
+                connection->updatePath();
+                connection->repaint();
+                connection->pushPathState();
             }
-
-            return first.getStartY() > second.getStartY() && first.getStartY() < second.getEndY() && second.getStartX() > first.getStartX() && second.getStartX() < first.getEndX();
-        };
-
-        bool const intersectsV = toCheck.isVertical() && (intersectV(toCheck, Line<float>(bounds.getTopLeft().toFloat(), bounds.getTopRight().toFloat())) || intersectV(toCheck, Line<float>(bounds.getBottomRight().toFloat(), bounds.getBottomLeft().toFloat())));
-
-        bool const intersectsH = toCheck.isHorizontal() && (intersectH(toCheck, Line<float>(bounds.getTopRight().toFloat(), bounds.getBottomRight().toFloat())) || intersectH(toCheck, Line<float>(bounds.getTopLeft().toFloat(), bounds.getBottomLeft().toFloat())));
-        if (intersectsV || intersectsH) {
-            return true;
-        }
-    }
-    return false;
+        });
+    });
 }
 
 void ConnectionPathUpdater::timerCallback()
@@ -1321,14 +1221,14 @@ void ConnectionPathUpdater::timerCallback()
     canvas->patch.endUndoSequence("SetConnectionPaths");
 }
 
-void Connection::receiveMessage(t_symbol* symbol, SmallArray<pd::Atom> const& atoms)
+void Connection::receiveMessage(t_symbol* symbol, std::span<pd::Atom const> atoms)
 {
     if (cnv->shouldShowConnectionActivity()) {
         activityStateAnimator.start();
     }
 
     outobj->triggerOverlayActiveState();
-    lastValue = atoms;
+    lastValue.assign(atoms.begin(), atoms.end());
     lastSelector = symbol;
 }
 
@@ -64,6 +64,9 @@ public:
 
     bool hitTest(int x, int y) override;
 
+    void moved() override;
+    void resized() override;
+
     void mouseDown(MouseEvent const& e) override;
     void mouseMove(MouseEvent const& e) override;
     void mouseDrag(MouseEvent const& e) override;
@@ -90,15 +93,13 @@ public:
     void componentMovedOrResized(Component& component, bool wasMoved, bool wasResized) override;
 
     // Pathfinding
-    int findLatticePaths(PathPlan& bestPath, PathPlan& pathStack, Point<float> start, Point<float> end, Point<float> increment);
-
     void findPath();
 
     void applyBestPath();
 
-    bool straightLineIntersectsObject(Line<float> toCheck, SmallArray<Object*>& objects) const;
+    Rectangle<int> getRoutingArea() const;
 
-    void receiveMessage(t_symbol* symbol, SmallArray<pd::Atom> const& atoms) override;
+    void receiveMessage(t_symbol* symbol, std::span<pd::Atom const> atoms) override;
 
     bool isSelected() const;
 
@@ -328,11 +329,34 @@ public:
 };
 
 // Helper class to group connection path changes together into undoable/redoable actions
+// Also finds paths for batches of connections on a background thread
 class ConnectionPathUpdater final : public Timer {
     Canvas* canvas;
 
     moodycamel::ReaderWriterQueue<std::pair<Component::SafePointer<Connection>, t_symbol*>> connectionUpdateQueue = moodycamel::ReaderWriterQueue<std::pair<Component::SafePointer<Connection>, t_symbol*>>(4096);
 
+    struct RoutingRequest {
+        Component::SafePointer<Connection> connection;
+        Point<float> start, end;
+        Rectangle<int> startObject, endObject;
+        PathPlan path;
+    };
+
+    struct RoutingBatch {
+        SmallArray<RoutingRequest> requests;
+        SmallArray<Rectangle<int>> obstacles;
+    };
+
+    // One routing thread shared by all canvases
+    struct RouterThreadPool final : public ThreadPool {
+        RouterThreadPool()
+            : ThreadPool(1)
+        {
+        }
+    };
+
+    SharedResourcePointer<RouterThreadPool> routerPool;
+
 public:
     explicit ConnectionPathUpdater(Canvas* cnv)
         : canvas(cnv)
@@ -345,5 +369,10 @@ public:
         startTimer(50);
     }
 
+    // Finds new paths for all connections in the background, and applies them as a single undoable action when done
+    void routeConnections(SmallArray<Connection*> const& connections);
+
+    static SmallArray<Rectangle<int>> getObstacles(Canvas* cnv, Rectangle<int> area);
+
     void timerCallback() override;
 };
@@ -188,12 +188,7 @@ public:
         if (toolchainDir.exists())
             toolchainDir.deleteRecursively();
 
-#if JUCE_LINUX || JUCE_WINDOWS
-        int expectedSize = 800 * 1024 * 1024;
-#else
-        int expectedSize = 500 * 1024 * 1024;
-#endif
-        auto success = Decompress::extractTarXz((uint8_t const*)toolchainData.getData(), toolchainData.getSize(), toolchainDir.getParentDirectory(), expectedSize);
+        auto success = Decompress::extractTarXz((uint8_t const*)toolchainData.getData(), toolchainData.getSize(), toolchainDir.getParentDirectory());
 
         if (!success || statusCode >= 400) {
             MessageManager::callAsync([this] {
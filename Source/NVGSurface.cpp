@@ -324,6 +324,9 @@ void NVGSurface::render()
         return;
     }
 
+    // Let objects read their state from Pd, so what we render this frame is up to date
+    editor->pollScheduler.poll();
+
     // Do this right before rendering, so that it doesn't show a frame with the last rendered content skewed to the new view size
     if (getBounds() != currentBounds) {
         setBounds(currentBounds);
@@ -73,6 +73,7 @@ Object::~Object()
 {
     hideEditor(); // Make sure the editor is not still open, that could lead to issues with listeners attached to the editor (i.e. suggestioncomponent)
     cnv->selectedComponents.removeChangeListener(this);
+    cnv->objectSpatialIndex.remove(this);
 }
 
 Rectangle<int> Object::getObjectBounds() const
@@ -454,7 +455,7 @@ void Object::setType(String const& newType, pd::WeakReference existingObject)
     editor->updateCommandStatus();
 
     cnv->synchroniseSplitCanvas();
-    cnv->pd->updateObjectImplementations();
+    cnv->pd->updateObjectImplementations(cnv->patch.getUncheckedPointer());
 }
 
 SmallArray<Rectangle<float>> Object::getCorners() const
@@ -503,6 +504,8 @@ void Object::moved()
     {
         cnv->suggestor->updateBounds();
     }
+
+    updateSpatialIndex();
 }
 
 void Object::resized()
@@ -518,6 +521,20 @@ void Object::resized()
     }
 
     updateIoletGeometry();
+    updateSpatialIndex();
+}
+
+// Labels are rendered together with their object, so they're part of the area the object occupies
+void Object::updateSpatialIndex()
+{
+    auto bounds = getBounds();
+    if (gui) {
+        for (auto const* label : gui->labels) {
+            bounds = bounds.getUnion(label->getBounds());
+        }
+    }
+
+    cnv->objectSpatialIndex.update(this, bounds);
 }
 
 void Object::updateIoletGeometry()
@@ -53,6 +53,7 @@ public:
     void resized() override;
 
     void updateIoletGeometry();
+    void updateSpatialIndex();
 
     bool keyPressed(KeyPress const& key, Component* component) override;
 
@@ -127,6 +128,10 @@ public:
 
     Rectangle<int> originalBounds;
 
+    // What this object looked like in pd at the last canvas sync, or empty if it always needs to be updated
+    using SyncedState = SmallArray<int64, 32>;
+    SyncedState lastSyncedState;
+
     bool isSelected() const;
 
     void hideHandles(bool const shouldHide)
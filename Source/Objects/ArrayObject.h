@@ -6,6 +6,8 @@
 #pragma once
 
 #include "Components/PropertiesPanel.h"
+#include "Utility/MinMaxPyramid.h"
+#include "Utility/AudioFileImporter.h"
 
 extern "C" {
 void garray_arraydialog(t_fake_garray* x, t_symbol* name, t_floatarg fsize, t_floatarg fflags, t_floatarg deleteit);
@@ -46,7 +48,7 @@ public:
         , pd(instance)
     {
         vec.reserve(8192);
-        read(vec);
+        read();
 
         updateParameters();
 
@@ -67,40 +69,16 @@ public:
         pd->unregisterMessageListener(this);
     }
 
-    static HeapArray<float> rescale(HeapArray<float> const& v, unsigned const newSize)
+    // Creates the path for the samples in visibleRange. When there are more samples than pixels, we draw the minimum and maximum
+    // of the samples under every pixel, which we get from the pyramid. That way, drawing huge arrays only costs O(pixels)
+    static Path createArrayPath(std::span<float const> samples, MinMaxPyramid const& pyramid, Range<int> const visibleRange, DrawType style, StackArray<float, 2> scale, float const width, float const height, float const lineWidth)
     {
-        if (v.empty()) {
-            return { };
-        }
-
-        HeapArray<float> result(newSize);
-        std::size_t const oldSize = v.size();
-        for (unsigned i = 0; i < newSize; i++) {
-            auto const idx = i * (oldSize - 1) / newSize;
-            auto const mod = i * (oldSize - 1) % newSize;
+        auto const points = samples.subspan(visibleRange.getStart(), visibleRange.getLength());
 
-            if (mod == 0)
-                result[i] = v[idx];
-            else {
-                auto const part = static_cast<float>(mod) / static_cast<float>(newSize);
-                result[i] = v[idx] * (1.0 - part) + v[idx + 1] * part;
-            }
-        }
-        return result;
-    }
-
-    static Path createArrayPath(HeapArray<float> points, DrawType style, StackArray<float, 2> scale, float const width, float const height, float const lineWidth)
-    {
         // Need at least 4 points to draw a bezier curve
         if (points.size() <= 2 && style == Curve)
             style = Polygon;
 
-        // For curve or polyon style, resample the array to the width in pixels
-        // Especially for curve style, that can save a lot of curve calculations
-        if ((style == Curve || style == Polygon) && points.size() > width) {
-            points = rescale(points, width);
-        }
-
         float const pointOffset = style == Points;
         float const dh = (height - 2) / (scale[0] - scale[1]);
 
@@ -108,11 +86,43 @@ public:
             return (y - scale[1]) * dh + 1 - pointOffset;
         };
 
+        Path result;
+
+        if (points.size() > width) {
+            auto const numColumns = static_cast<int>(width);
+            auto const samplesPerColumn = static_cast<double>(points.size()) / numColumns;
+
+            for (int x = 0; x < numColumns; x++) {
+                auto const start = visibleRange.getStart() + static_cast<size_t>(x * samplesPerColumn);
+                auto const end = std::max(start + 1, visibleRange.getStart() + static_cast<size_t>((x + 1) * samplesPerColumn));
+                auto const [min, max] = pyramid.getMinMax(samples, start, end);
+
+                auto const y1 = yToCoords(min);
+                auto const y2 = yToCoords(max);
+                if (!std::isfinite(y1) || !std::isfinite(y2))
+                    continue;
+
+                auto const top = std::min(y1, y2);
+                auto const bottom = std::max(y1, y2);
+
+                if (style == Points) {
+                    result.addRectangle(x - 0.33f, top, 1.33f, bottom - top + lineWidth);
+                } else {
+                    if (result.isEmpty())
+                        result.startNewSubPath(x, top);
+                    else
+                        result.lineTo(x, top);
+                    result.lineTo(x, bottom);
+                }
+            }
+
+            return result;
+        }
+
         auto const* pointPtr = points.data();
         auto const numPoints = points.size();
 
         StackArray<float, 6> control = { 0 };
-        Path result;
         if (std::isfinite(pointPtr[0])) {
             result.startNewSubPath(0, yToCoords(pointPtr[0]));
         }
@@ -207,7 +217,7 @@ public:
     {
         if (arrayNeedsUpdate) {
             if (vec.not_empty()) {
-                arrayPath = createArrayPath(vec, static_cast<DrawType>(getValue<int>(drawMode) - 1), getScale(), getWidth(), getHeight(), getLineWidth());
+                arrayPath = createArrayPath(vec, pyramid, getVisibleRange(), static_cast<DrawType>(getValue<int>(drawMode) - 1), getScale(), getWidth(), getHeight(), getLineWidth());
             }
             arrayNeedsUpdate = false;
         }
@@ -223,7 +233,7 @@ public:
         auto const arrDrawMode = static_cast<DrawType>(getValue<int>(drawMode) - 1);
         if (arrayNeedsUpdate) {
             if (vec.not_empty()) {
-                arrayPath = createArrayPath(vec, arrDrawMode, getScale(), getWidth(), getHeight(), getLineWidth());
+                arrayPath = createArrayPath(vec, pyramid, getVisibleRange(), arrDrawMode, getScale(), getWidth(), getHeight(), getLineWidth());
             }
             cachedPath.clear();
             arrayNeedsUpdate = false;
@@ -262,7 +272,7 @@ public:
         }
     }
 
-    void receiveMessage(t_symbol* symbol, SmallArray<pd::Atom> const& atoms) override
+    void receiveMessage(t_symbol* symbol, std::span<pd::Atom const> atoms) override
     {
         switch (hash(symbol->s_name)) {
         case hash("edit"): {
@@ -340,6 +350,20 @@ public:
         {
             nvgDrawRoundedRect(nvg, 0, 0, getWidth(), getHeight(), nvgRGBA(0, 0, 0, 0), nvgColour(PlugDataColours::dataColour), Corners::objectCornerRadius);
         }
+
+        if (importer) {
+            auto const progressBounds = getLocalBounds().reduced(8).withSizeKeepingCentre(getWidth() - 16, 4).toFloat();
+            nvgFillColor(nvg, nvgColour(PlugDataColours::guiObjectInternalOutlineColour));
+            nvgFillRect(nvg, progressBounds.getX(), progressBounds.getY(), progressBounds.getWidth(), progressBounds.getHeight());
+            nvgFillColor(nvg, nvgColour(PlugDataColours::dataColour));
+            nvgFillRect(nvg, progressBounds.getX(), progressBounds.getY(), progressBounds.getWidth() * importer->getProgress(), progressBounds.getHeight());
+
+            nvgFontSize(nvg, 11);
+            nvgFontFace(nvg, "Inter-Regular");
+            nvgTextAlign(nvg, NVG_ALIGN_CENTER | NVG_ALIGN_BOTTOM);
+            nvgFillColor(nvg, nvgColour(PlugDataColours::canvasTextColour));
+            nvgText(nvg, progressBounds.getCentreX(), progressBounds.getY() - 4, "Importing, click to cancel", nullptr);
+        }
     }
 
     void paint(Graphics& g) override
@@ -356,6 +380,15 @@ public:
             g.setColour(PlugDataColours::dataColour);
             g.drawRoundedRectangle(getLocalBounds().toFloat(), Corners::objectCornerRadius, 1.0f);
         }
+
+        if (importer) {
+            auto const progressBounds = getLocalBounds().reduced(8).withSizeKeepingCentre(getWidth() - 16, 4).toFloat();
+            g.setColour(PlugDataColours::guiObjectInternalOutlineColour);
+            g.fillRect(progressBounds);
+            g.setColour(PlugDataColours::dataColour);
+            g.fillRect(progressBounds.withWidth(progressBounds.getWidth() * importer->getProgress()));
+            Fonts::drawText(g, "Importing, click to cancel", progressBounds.translated(0, -18).withHeight(14).toNearestInt(), PlugDataColours::canvasTextColour, 11, Justification::centred);
+        }
     }
 
     void resized() override
@@ -365,33 +398,32 @@ public:
 
     void mouseDown(MouseEvent const& e) override
     {
+        // Clicking while importing a file cancels the import
+        if (importer) {
+            importer->cancel();
+            return;
+        }
+
         if (error || !editable || !e.mods.isLeftButtonDown())
             return;
         edited = true;
 
-        auto const s = static_cast<float>(vec.size() - 1);
-        auto const w = static_cast<float>(getWidth());
-        auto const x = static_cast<float>(e.x);
-
-        lastIndex = std::round(std::clamp(x / w, 0.f, 1.f) * s);
+        lastIndex = getSampleIndex(e.x);
 
         mouseDrag(e);
     }
 
     void mouseDrag(MouseEvent const& e) override
     {
-        if (error || !editable || !e.mods.isLeftButtonDown())
+        if (error || !editable || importer || !e.mods.isLeftButtonDown())
             return;
 
-        auto const s = static_cast<float>(vec.size() - 1);
-        auto const w = static_cast<float>(getWidth());
         auto const h = static_cast<float>(getHeight());
-        auto const x = static_cast<float>(e.x);
         auto const y = static_cast<float>(e.y);
 
         StackArray<float, 2> scale = getScale();
 
-        int const index = static_cast<int>(std::round(std::clamp(x / w, 0.f, 1.f) * s));
+        int const index = getSampleIndex(e.x);
 
         float const start = vec[lastIndex];
         float const current = (1.f - std::clamp(y / h, 0.f, 1.f)) * (scale[1] - scale[0]) + scale[0];
@@ -407,6 +439,8 @@ public:
             vec[n] = jmap<float>(n, interpStart, interpEnd + 1, min, max);
         }
 
+        pyramid.update(vec, interpStart, interpEnd + 1);
+
         // Don't want to touch vec on the other thread, so we copy the vector into the lambda
         auto changed = HeapArray<float>(vec.begin() + interpStart, vec.begin() + interpEnd + 1);
 
@@ -418,13 +452,14 @@ public:
             }
             pd->sendDirectMessage(ptr.get(), "array");
         }
+        markWritten({ interpStart, interpEnd + 1 });
 
         updateArrayPath();
     }
 
     void mouseUp(MouseEvent const& e) override
     {
-        if (error || !editable || !e.mods.isLeftButtonDown())
+        if (error || !editable || importer || !e.mods.isLeftButtonDown())
             return;
 
         if (auto ptr = arr.get<t_fake_garray>()) {
@@ -438,8 +473,8 @@ public:
     {
         setValueExcludingListener(size, var(getArraySize()), this);
 
-        if (!edited) {
-            if (read(vec)) {
+        if (!edited && !importer) {
+            if (read()) {
                 updateArrayPath();
             }
         }
@@ -631,25 +666,134 @@ public:
         }
     }
 
-    // Gets the values from the array.
-    bool read(HeapArray<float>& output) const
+    // Called for every redraw of the array in pd. Redraws that follow our own writes only need to re-read what we wrote,
+    // any other redraw could have changed every sample, so then we compare the whole array against our copy
+    void arrayRedrawn()
     {
-        bool changed = false;
-        if (auto ptr = arr.get<t_garray>()) {
-            int const size = garray_getarray(ptr.get())->a_n;
-            changed = size != vec.size();
-            output.resize(static_cast<size_t>(size));
+        if (!ownWritesPending)
+            numLeftToCompare = static_cast<int>(vec.size());
+    }
+
+    bool isComparing() const
+    {
+        return numLeftToCompare > 0;
+    }
+
+    // Copies the values that changed from the array, and updates the pyramid for them
+    // The samples we wrote ourselves are re-read right away. The full compare after a redraw from pd is done one slice
+    // per call, so a huge array never holds the Pd lock for long. Call this until isComparing() returns false
+    bool read()
+    {
+        static constexpr int chunkSize = 4096;
+        static constexpr int compareSliceSize = 65536;
+
+        auto ptr = arr.get<t_garray>();
+        if (!ptr)
+            return false;
+
+        auto const size = garray_getarray(ptr.get())->a_n;
+        auto const* words = reinterpret_cast<t_word*>(garray_vec(ptr.get()));
 
-            auto const* atoms = reinterpret_cast<t_word*>(garray_vec(ptr.get()));
+        if (size != vec.size()) {
+            vec.resize(static_cast<size_t>(size));
             for (int i = 0; i < size; i++) {
-                changed = changed || output[i] != atoms[i].w_float;
-                output[i] = atoms[i].w_float;
+                vec[i] = words[i].w_float;
             }
+            pyramid.build(vec);
+
+            dirtyRange = {};
+            ownWritesPending = false;
+            compareStart = 0;
+            numLeftToCompare = 0;
+            return true;
         }
 
+        bool changed = false;
+        if (auto const dirty = dirtyRange.getIntersectionWith({ 0, size }); !dirty.isEmpty()) {
+            for (int i = dirty.getStart(); i < dirty.getEnd(); i++) {
+                vec[i] = words[i].w_float;
+            }
+            pyramid.update(vec, dirty.getStart(), dirty.getEnd());
+            changed = true;
+        }
+        dirtyRange = {};
+        ownWritesPending = false;
+
+        // We compare in chunks, so a small change in a huge array only needs a small part of the pyramid to be rebuilt
+        auto const sliceEnd = std::min(compareStart + std::min(numLeftToCompare, compareSliceSize), size);
+        for (int chunkStart = compareStart; chunkStart < sliceEnd; chunkStart += chunkSize) {
+            auto const chunkEnd = std::min(chunkStart + chunkSize, sliceEnd);
+
+            auto firstChange = chunkStart;
+            while (firstChange < chunkEnd && vec[firstChange] == words[firstChange].w_float)
+                firstChange++;
+
+            if (firstChange == chunkEnd)
+                continue;
+
+            for (int i = firstChange; i < chunkEnd; i++) {
+                vec[i] = words[i].w_float;
+            }
+            pyramid.update(vec, firstChange, chunkEnd);
+            changed = true;
+        }
+
+        numLeftToCompare = std::max(0, numLeftToCompare - (sliceEnd - compareStart));
+        compareStart = sliceEnd < size ? sliceEnd : 0;
+
         return changed;
     }
 
+    // Range of samples that is currently shown, ArrayEditorDialog can zoom in on a part of the array
+    Range<int> getVisibleRange() const
+    {
+        auto const fullRange = Range<int>(0, static_cast<int>(vec.size()));
+        auto const range = visibleRange.getIntersectionWith(fullRange);
+        return range.isEmpty() ? fullRange : range;
+    }
+
+    int getSampleIndex(int const x) const
+    {
+        auto const range = getVisibleRange();
+        auto const position = std::clamp(static_cast<float>(x) / static_cast<float>(getWidth()), 0.f, 1.f);
+        return range.getStart() + static_cast<int>(std::round(position * static_cast<float>(std::max(range.getLength() - 1, 0))));
+    }
+
+    void mouseWheelMove(MouseEvent const& e, MouseWheelDetails const& wheel) override
+    {
+        if (!zoomable) {
+            Component::mouseWheelMove(e, wheel);
+            return;
+        }
+
+        auto const numSamples = static_cast<int>(vec.size());
+        auto const range = getVisibleRange();
+        if (numSamples < 2)
+            return;
+
+        // Scroll horizontally, zoom around the mouse position when scrolling vertically
+        if (!approximatelyEqual(wheel.deltaX, 0.0f)) {
+            auto const offset = roundToInt(-wheel.deltaX * range.getLength());
+            visibleRange = range.movedToStartAt(std::clamp(range.getStart() + offset, 0, numSamples - range.getLength()));
+        } else {
+            auto const anchor = getSampleIndex(e.x);
+            auto const zoom = std::pow(2.0f, -wheel.deltaY * 2.0f);
+            auto const newLength = std::clamp(roundToInt(range.getLength() * zoom), std::min(numSamples, 8), numSamples);
+            auto const anchorRatio = static_cast<float>(anchor - range.getStart()) / static_cast<float>(range.getLength());
+            auto const newStart = std::clamp(anchor - roundToInt(anchorRatio * newLength), 0, numSamples - newLength);
+            visibleRange = { newStart, newStart + newLength };
+        }
+
+        updateArrayPath();
+    }
+
+    // Remembers which samples we wrote to the array ourselves, so the redraw that follows doesn't need to compare all of them
+    void markWritten(Range<int> const range)
+    {
+        dirtyRange = dirtyRange.isEmpty() ? range : dirtyRange.getUnionWith(range);
+        ownWritesPending = true;
+    }
+
     // Writes a value to the array.
     static void write(t_garray* garray, size_t const pos, float const input)
     {
@@ -683,70 +827,98 @@ public:
         repaint();
     }
 
+    // Imports the dropped file on a background thread, resampled to Pd's sample rate. Hold alt to keep the file's own sample rate
+    // Files with more than one channel first show a menu to pick the channel to import
     void filesDropped (const StringArray& files, int x, int y) override
     {
         isDraggingFile = false;
         repaint();
 
-        if (files.size() != 1)
+        if (files.size() != 1 || importer)
             return;
 
         File const audioFile(files[0]);
         if (!audioFile.existsAsFile())
             return;
 
+        auto const resampleToPd = !ModifierKeys::getCurrentModifiers().isAltDown();
+
         AudioFormatManager formatManager;
         formatManager.registerBasicFormats();
-
         std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(audioFile));
+        auto const numChannels = reader ? static_cast<int>(reader->numChannels) : 0;
 
-        if (!reader)
+        if (numChannels <= 1) {
+            importFile(audioFile, { 0, resampleToPd });
             return;
+        }
 
-        // Limit to a sane maximum so we never allocate gigabytes
-        constexpr int maxSamples = 1 << 24;   // ~16 M samples
-        auto const numSamples = static_cast<int>(std::min<int64>(reader->lengthInSamples, maxSamples));
+        PopupMenu menu;
+        menu.addSectionHeader("Import channel");
+        for (int channel = 0; channel < numChannels; channel++) {
+            menu.addItem(channel + 1, "Channel " + String(channel + 1));
+        }
 
-        if (numSamples == 0)
-            return;
+        menu.showMenuAsync(PopupMenu::Options().withTargetScreenArea(localAreaToGlobal(Rectangle<int>(x, y, 1, 1))), [_this = SafePointer(this), audioFile, resampleToPd](int const item) {
+            if (item && _this && !_this->importer)
+                _this->importFile(audioFile, { item - 1, resampleToPd });
+        });
+    }
 
-        AudioBuffer<float> audioBuffer(static_cast<int>(reader->numChannels), numSamples);
-        reader->read(&audioBuffer, 0, numSamples, 0, true, false);
+    void importFile(File const& audioFile, AudioFileImporter::Options const options)
+    {
+        importer = std::make_unique<AudioFileImporter>(arr, audioFile, options);
 
-        HeapArray<float> leftChannel(numSamples);
-        if(audioBuffer.getNumChannels() >= 1) {
-            auto const* src = audioBuffer.getReadPointer(0);
-            for (int i = 0; i < numSamples; ++i)
-                leftChannel[i] = src[i];
-        }
+        importer->onProgress = [this](float) {
+            repaint();
+        };
 
-        if (auto garray = arr.get<t_garray>()) {
-            garray_resize_long(garray.get(), static_cast<long>(numSamples));
-        }
+        importer->onFinished = [this](bool const completed) {
+            if (completed) {
+                std::swap(vec, importer->samples);
+                std::swap(pyramid, importer->pyramid);
 
-        vec.resize(static_cast<size_t>(numSamples));
-        setValueExcludingListener(size, var(numSamples), this);
+                // These are exactly the samples that were written, so there is nothing to read back after the redraw
+                dirtyRange = {};
+                ownWritesPending = true;
+                numLeftToCompare = 0;
+            } else {
+                read();
+            }
+            importer.reset();
 
-        if (auto ptr = arr.get<t_garray>()) {
-            for (int i = 0; i < numSamples; ++i) {
-                float const s = leftChannel[i];
-                write(ptr.get(), static_cast<size_t>(i), s);
-                vec[i] = s;
+            if (auto ptr = arr.get<t_garray>()) {
+                pd->sendDirectMessage(ptr.get(), "array");
             }
-            pd->sendDirectMessage(ptr.get(), "array");
-        }
 
-        updateArrayPath();
-        repaint();
+            setValueExcludingListener(size, var(static_cast<int>(vec.size())), this);
+            visibleRange = {};
+            updateArrayPath();
+            repaint();
+        };
+
+        importer->startThread();
     }
 
     pd::WeakReference arr;
 
     HeapArray<float> vec;
+    MinMaxPyramid pyramid;
+    Range<int> visibleRange;
+    bool zoomable = false;
+    std::unique_ptr<AudioFileImporter> importer;
     AtomicValue<bool> edited;
     bool error = false;
     int lastIndex = 0;
 
+    // Samples that we wrote to the array ourselves since the last read
+    Range<int> dirtyRange;
+    bool ownWritesPending = false;
+
+    // Progress of comparing the whole array against our copy, after a redraw that we didn't cause
+    int compareStart = 0;
+    int numLeftToCompare = 0;
+
     PluginProcessor* pd;
     bool editable = true;
     bool isDraggingFile = false;
@@ -1000,6 +1172,7 @@ public:
     {
         for (auto* arr : arrays) {
             auto* graph = graphs.add(new GraphicalArray(pd, arr, parent));
+            graph->zoomable = true;
             addChildComponent(graph);
 
             auto* list = lists.add(new ArrayListView(pd, arr));
@@ -1097,6 +1270,14 @@ public:
         }
     }
 
+    void arrayRedrawn()
+    {
+        for (auto* graph : graphs) {
+            graph->arrayRedrawn();
+        }
+        updateGraphs();
+    }
+
     void updateGraphs()
     {
         pd->lockAudioThread();
@@ -1149,7 +1330,8 @@ public:
     }
 };
 
-class ArrayObject final : public ObjectBase {
+class ArrayObject final : public ObjectBase
+    , public PollScheduler::Poller {
 public:
     SafePointer<ArrayPropertiesPanel> propertiesPanel = nullptr;
     Value sizeProperty = SynchronousValue();
@@ -1185,6 +1367,14 @@ public:
         });
 
         updateLabel();
+
+        // Only polls after a redraw message
+        cnv->editor->pollScheduler.addPoller(this, this, -1);
+    }
+
+    ~ArrayObject() override
+    {
+        cnv->editor->pollScheduler.removePoller(this);
     }
 
     bool canReceiveMouseEvent(int const x, int const y) override
@@ -1271,13 +1461,41 @@ public:
     void updateGraphs()
     {
         pd->lockAudioThread();
+        pollSnapshot();
+        pd->unlockAudioThread();
+    }
 
+    void pollSnapshot() override
+    {
         for (auto* graph : graphs) {
             // Update values
             graph->update();
         }
 
-        pd->unlockAudioThread();
+        // The dialog updates its graphs on every redraw, we only need to help them finish comparing
+        if (dialog) {
+            for (auto* graph : dialog->graphs) {
+                if (graph->isComparing())
+                    graph->update();
+            }
+        }
+    }
+
+    void pollApply() override
+    {
+        // Large arrays are compared a slice per frame, so keep polling until all graphs are done
+        bool isComparing = false;
+        for (auto* graph : graphs) {
+            isComparing = isComparing || graph->isComparing();
+        }
+        if (dialog) {
+            for (auto* graph : dialog->graphs) {
+                isComparing = isComparing || graph->isComparing();
+            }
+        }
+
+        if (isComparing)
+            requestPoll();
     }
 
     void updateLabel() override
@@ -1292,7 +1510,7 @@ public:
             int constexpr fontHeight = 14.0f;
             ObjectLabel* label;
             if (labels.isEmpty()) {
-                label = labels.add(new ObjectLabel());
+                label = labels.add(new ObjectLabel(object));
             } else {
                 label = labels[0];
             }
@@ -1429,13 +1647,17 @@ public:
         });
     }
 
-    void receiveObjectMessage(hash32 const symbol, SmallArray<pd::Atom> const& atoms) override
+    void receiveObjectMessage(hash32 const symbol, std::span<pd::Atom const> atoms) override
     {
         switch (symbol) {
         case hash("redraw"): {
-            updateGraphs();
+            // Arrays can get redrawn many times per frame, so we let the poll scheduler update them once before the next frame
+            for (auto* graph : graphs) {
+                graph->arrayRedrawn();
+            }
+            requestPoll();
             if (dialog) {
-                dialog->updateGraphs();
+                dialog->arrayRedrawn();
             }
             break;
         }
@@ -1528,7 +1750,7 @@ public:
         }
     }
 
-    void receiveObjectMessage(hash32 symbol, SmallArray<pd::Atom> const& atoms) override
+    void receiveObjectMessage(hash32 symbol, std::span<pd::Atom const> atoms) override
     {
     }
 };
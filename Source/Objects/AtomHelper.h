@@ -267,7 +267,7 @@ public:
         if (text.isNotEmpty()) {
             ObjectLabel* label;
             if (labels.isEmpty()) {
-                label = labels.add(new ObjectLabel());
+                label = labels.add(new ObjectLabel(object));
             } else {
                 label = labels[0];
             }
@@ -614,7 +614,7 @@ public:
         graph.saveProperties();
     }
 
-    void receiveObjectMessage(hash32 const symbol, SmallArray<pd::Atom> const& atoms) override
+    void receiveObjectMessage(hash32 const symbol, std::span<pd::Atom const> atoms) override
     {
         switch (symbol) {
         case hash("allpass"): {
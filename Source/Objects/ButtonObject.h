@@ -340,7 +340,7 @@ public:
         }
     }
 
-    void receiveObjectMessage(hash32 const symbol, SmallArray<pd::Atom> const& atoms) override
+    void receiveObjectMessage(hash32 const symbol, std::span<pd::Atom const> atoms) override
     {
         switch (symbol) {
         case hash("bgcolor"): {
@@ -117,7 +117,7 @@ public:
         newCanvas->patch.setCurrentFile(URL(path));
     }
 
-    void receiveObjectMessage(hash32 const symbol, SmallArray<pd::Atom> const& atoms) override
+    void receiveObjectMessage(hash32 const symbol, std::span<pd::Atom const> atoms) override
     {
         switch (symbol) {
         case hash("vis"): {
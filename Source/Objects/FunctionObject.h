@@ -441,7 +441,7 @@ public:
         return sSymbol.isNotEmpty() && sSymbol != "empty";
     }
 
-    void receiveObjectMessage(hash32 const symbol, SmallArray<pd::Atom> const& atoms) override
+    void receiveObjectMessage(hash32 const symbol, std::span<pd::Atom const> atoms) override
     {
         switch (symbol) {
         case hash("send"): {
@@ -78,7 +78,7 @@ public:
         objectParams.addParamInt("Height", cLabel, &labelHeight, labelHeightY, true, 4);
     }
 
-    bool receiveObjectMessage(hash32 const symbol, SmallArray<pd::Atom> const& atoms)
+    bool receiveObjectMessage(hash32 const symbol, std::span<pd::Atom const> atoms)
     {
         auto setColour = [this](Value& targetValue, pd::Atom const& atom) {
             if (atom.isSymbol()) {
@@ -248,7 +248,7 @@ public:
         if (text.isNotEmpty()) {
             ObjectLabel* label;
             if (labels.isEmpty()) {
-                label = labels.add(new ObjectLabel());
+                label = labels.add(new ObjectLabel(object));
                 object->cnv->addChildComponent(label);
             } else {
                 label = labels[0];
@@ -130,69 +130,143 @@ ObjectImplementationManager::ObjectImplementationManager(pd::Instance* processor
 
 void ObjectImplementationManager::handleAsyncUpdate()
 {
-    SmallArray<std::pair<t_canvas const*, t_canvas const*>> allCanvases;
-    SmallArray<std::pair<t_canvas const*, t_gobj*>> allImplementations;
-    UnorderedSet<t_gobj const*> allObjects;
+    // Pd clears the weak references of objects when it frees them, so we can remove their implementations without a lock
+    for (auto it = objectImplementations.begin(); it != objectImplementations.end();) {
+        if (it->second->ptr.isDeleted()) {
+            it = objectImplementations.erase(it);
+        } else {
+            ++it;
+        }
+    }
 
-    pd->setThis();
+    for (auto it = knownCanvases.begin(); it != knownCanvases.end();) {
+        if (it->second->ref.isDeleted()) {
+            it = knownCanvases.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto it = knownClones.begin(); it != knownClones.end();) {
+        if (it->second->ref.isDeleted()) {
+            it = knownClones.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Only look at the canvases that changed, and at canvases we haven't seen before
+    // For canvases we already know, we only need to check their direct children: their subpatches and clone instances tell us
+    // themselves when something was created in them, through synchronising, dynamic patching or resizing the clone
+    SmallArray<std::pair<t_canvas const*, t_gobj*>> newObjects;
 
+    pd->setThis();
     pd->lockAudioThread();
     for (auto* topLevelCnv = pd_getcanvaslist(); topLevelCnv; topLevelCnv = topLevelCnv->gl_next) {
-        allCanvases.add({ topLevelCnv, topLevelCnv });
-        getSubCanvases(topLevelCnv, topLevelCnv, allCanvases);
+        if (!knownCanvases.contains(topLevelCnv)) {
+            scanNewCanvas(topLevelCnv, topLevelCnv, newObjects);
+        }
     }
 
-    for (auto& [top, glist] : allCanvases) {
-        for (t_gobj* y = glist->gl_list; y; y = y->g_next) {
-            auto const* name = pd::Interface::getObjectClassName(&y->g_pd);
-            if (ImplementationBase::hasImplementation(name)) {
-                allImplementations.add({ top, y });
-                allObjects.insert(y);
-            }
+    for (auto const* canvas : changedCanvases) {
+        if (auto const it = knownCanvases.find(canvas); it != knownCanvases.end()) {
+            scanCanvas(it->second->top, canvas, newObjects);
         }
     }
     pd->unlockAudioThread();
 
-    for (auto it = objectImplementations.cbegin(); it != objectImplementations.cend();) {
-        auto& [ptr, implementation] = *it;
+    changedCanvases.clear();
 
-        if (!allObjects.contains(ptr)) {
-            it = objectImplementations.erase(it); // Erase and move iterator forward.
-        } else {
-            ++it;
-        }
-    }
-
-    for (auto& [cnv, obj] : allImplementations) {
-        if (!objectImplementations.count(obj)) {
+    for (auto& [cnv, obj] : newObjects) {
+        if (!objectImplementations.contains(obj)) {
             auto const name = String::fromUTF8(pd::Interface::getObjectClassName(&obj->g_pd));
             objectImplementations[obj] = std::unique_ptr<ImplementationBase>(ImplementationBase::createImplementation(name, obj, cnv, pd));
         }
+    }
 
-        objectImplementations[obj]->update();
+    // Let all implementations find the canvas they belong to again, since tabs might have been opened or closed
+    for (auto& [obj, implementation] : objectImplementations) {
+        implementation->update();
     }
 }
 
-void ObjectImplementationManager::updateObjectImplementations()
+void ObjectImplementationManager::updateObjectImplementations(t_canvas const* changedPatch)
 {
+    if (changedPatch)
+        changedCanvases.insert(changedPatch);
+
+    triggerAsyncUpdate();
+}
+
+void ObjectImplementationManager::rescanAllPatches()
+{
+    knownCanvases.clear();
+    knownClones.clear();
     triggerAsyncUpdate();
 }
 
-void ObjectImplementationManager::getSubCanvases(t_canvas const* top, t_canvas const* canvas, SmallArray<std::pair<t_canvas const*, t_canvas const*>>& allCanvases)
+void ObjectImplementationManager::scanCanvas(t_canvas const* top, t_canvas const* canvas, SmallArray<std::pair<t_canvas const*, t_gobj*>>& newObjects)
 {
     for (t_gobj* y = canvas->gl_list; y; y = y->g_next) {
         if (pd_class(&y->g_pd) == canvas_class) {
-            allCanvases.add({ top, reinterpret_cast<t_glist const*>(y) });
-            getSubCanvases(top, reinterpret_cast<t_glist*>(y), allCanvases);
+            auto const* subpatch = reinterpret_cast<t_canvas const*>(y);
+            if (!knownCanvases.contains(subpatch)) {
+                scanNewCanvas(top, subpatch, newObjects);
+            }
         } else if (pd_class(&y->g_pd) == clone_class) {
+            // Resizing the clone creates instances that we need to scan, so the clone tells us when it gets resized
+            if (!knownClones.contains(y)) {
+                knownClones[y] = std::make_unique<ChangeListener>(*this, y, top, canvas);
+            }
+
             for (int i = 0; i < clone_get_n(y); i++) {
-                allCanvases.add({ top, reinterpret_cast<t_glist const*>(y) });
-                getSubCanvases(top, clone_get_instance(y, i), allCanvases);
+                auto const* instance = clone_get_instance(y, i);
+                if (!knownCanvases.contains(instance)) {
+                    scanNewCanvas(top, instance, newObjects);
+                }
             }
+        } else if (!objectImplementations.contains(y) && ImplementationBase::hasImplementation(pd::Interface::getObjectClassName(&y->g_pd))) {
+            newObjects.add({ top, y });
         }
     }
 }
 
+void ObjectImplementationManager::scanNewCanvas(t_canvas const* top, t_canvas const* canvas, SmallArray<std::pair<t_canvas const*, t_gobj*>>& newObjects)
+{
+    knownCanvases[canvas] = std::make_unique<ChangeListener>(*this, const_cast<t_canvas*>(canvas), top, canvas);
+    scanCanvas(top, canvas, newObjects);
+}
+
+ObjectImplementationManager::ChangeListener::ChangeListener(ObjectImplementationManager& manager, void* target, t_canvas const* top, t_canvas const* canvas)
+    : manager(manager)
+    , ref(target, manager.pd)
+    , top(top)
+    , canvas(canvas)
+{
+    manager.pd->registerMessageListener(target, this);
+}
+
+ObjectImplementationManager::ChangeListener::~ChangeListener()
+{
+    manager.pd->unregisterMessageListener(this);
+}
+
+void ObjectImplementationManager::ChangeListener::receiveMessage(t_symbol* symbol, std::span<pd::Atom const> atoms)
+{
+    switch (hash(symbol->s_name)) {
+    case hash("obj"):
+    case hash("paste"):
+    case hash("duplicate"):
+    case hash("undo"):
+    case hash("redo"):
+    case hash("resize"):
+        manager.updateObjectImplementations(canvas);
+        break;
+    default:
+        break;
+    }
+}
+
 void ObjectImplementationManager::clearObjectImplementationsForPatch(t_canvas const* patch)
 {
     for (t_gobj* y = patch->gl_list; y; y = y->g_next) {
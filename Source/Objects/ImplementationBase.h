@@ -38,18 +38,43 @@ class ObjectImplementationManager final : public AsyncUpdater {
 public:
     explicit ObjectImplementationManager(pd::Instance* pd);
 
-    void updateObjectImplementations();
+    // Call this when the content of a patch has changed, so we can look for new objects that need an implementation
+    // Without a patch, we only check for patches that have been opened
+    void updateObjectImplementations(t_canvas const* changedPatch = nullptr);
+
+    // Scans all patches again, for changes that could have created objects in patches that aren't open (like reloading abstractions)
+    void rescanAllPatches();
+
     void clearObjectImplementationsForPatch(t_canvas const* patch);
 
     void handleAsyncUpdate() override;
 
 private:
-    static void getSubCanvases(t_canvas const* top, t_canvas const* patch, SmallArray<std::pair<t_canvas const*, t_canvas const*>>& allCanvases);
+    // Listens to a canvas or a [clone] for messages that can create objects without the canvas being synchronised,
+    // like dynamic patching or resizing the clone, so we know which canvas to scan again
+    class ChangeListener final : public pd::MessageListener {
+    public:
+        ChangeListener(ObjectImplementationManager& manager, void* target, t_canvas const* top, t_canvas const* canvas);
+        ~ChangeListener() override;
+
+        void receiveMessage(t_symbol* symbol, std::span<pd::Atom const> atoms) override;
+
+        ObjectImplementationManager& manager;
+        pd::WeakReference ref;
+        t_canvas const* top;
+        t_canvas const* canvas;
+    };
+
+    void scanCanvas(t_canvas const* top, t_canvas const* canvas, SmallArray<std::pair<t_canvas const*, t_gobj*>>& newObjects);
+    void scanNewCanvas(t_canvas const* top, t_canvas const* canvas, SmallArray<std::pair<t_canvas const*, t_gobj*>>& newObjects);
 
     PluginProcessor* pd;
 
     UnorderedSegmentedMap<t_gobj const*, std::unique_ptr<ImplementationBase>> objectImplementations;
-    SmallArray<std::pair<t_canvas const*, t_gobj const*>> targetImplementations;
-    UnorderedSegmentedSet<t_gobj const*> targetObjects;
-    CriticalSection objectImplementationLock;
+
+    // Every canvas we have scanned, and every clone in them, with the top-level patch they belong to
+    // When Pd frees a canvas or an object, their weak references are cleared, so we never have to look for deleted objects
+    UnorderedMap<t_canvas const*, std::unique_ptr<ChangeListener>> knownCanvases;
+    UnorderedMap<t_gobj const*, std::unique_ptr<ChangeListener>> knownClones;
+    UnorderedSet<t_canvas const*> changedCanvases;
 };
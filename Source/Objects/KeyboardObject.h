@@ -7,7 +7,7 @@
 
 // ELSE keyboard
 class KeyboardObject final : public ObjectBase
-    , public Timer {
+    , public PollScheduler::Poller {
 
     Value lowC = SynchronousValue();
     Value octaves = SynchronousValue();
@@ -23,6 +23,9 @@ class KeyboardObject final : public ObjectBase
     UnorderedSet<int> heldKeys;
     UnorderedSet<int> toggledKeys;
 
+    // Notes copied from the keyboard while holding the audio lock
+    StackArray<int, 256> polledNotes = {};
+
     static constexpr uint8 whiteNotes[] = { 0, 2, 4, 5, 7, 9, 11 };
     static constexpr uint8 blackNotes[] = { 1, 3, 6, 8, 10 };
 
@@ -38,7 +41,12 @@ public:
         objectParameters.addParamReceiveSymbol(&receiveSymbol);
         objectParameters.addParamSendSymbol(&sendSymbol);
 
-        startTimer(50);
+        cnv->editor->pollScheduler.addPoller(this, this, 50);
+    }
+
+    ~KeyboardObject() override
+    {
+        cnv->editor->pollScheduler.removePoller(this);
     }
 
     void onConstrainerCreate() override
@@ -238,12 +246,16 @@ public:
         }
     }
 
-    void updateValue()
+    void pollSnapshot() override
     {
-        StackArray<int, 256> notes;
-        if (auto obj = ptr.get<t_fake_keyboard>()) {
-            memcpy(notes.data(), obj->x_tgl_notes + 12, 244 * sizeof(int));
+        if (auto* obj = ptr.getRaw<t_fake_keyboard>()) {
+            memcpy(polledNotes.data(), obj->x_tgl_notes + 12, 244 * sizeof(int));
         }
+    }
+
+    void pollApply() override
+    {
+        auto const& notes = polledNotes;
 
         auto const numOctaves = getValue<int>(octaves) * 12;
         auto const lowest = getValue<int>(lowC) * 12;
@@ -279,7 +291,7 @@ public:
         repaint();
     }
 
-    void receiveNotesOn(SmallArray<pd::Atom> const& atoms, bool const isOn)
+    void receiveNotesOn(std::span<pd::Atom const> atoms, bool const isOn)
     {
         for (int at = 0; at < atoms.size(); at++) {
             if (isOn)
@@ -290,7 +302,7 @@ public:
         repaint();
     }
 
-    void receiveObjectMessage(hash32 const symbol, SmallArray<pd::Atom> const& atoms) override
+    void receiveObjectMessage(hash32 const symbol, std::span<pd::Atom const> atoms) override
     {
         auto elseKeyboard = ptr.get<t_fake_keyboard>();
 
@@ -444,11 +456,6 @@ public:
         return sSymbol.isNotEmpty() && sSymbol != "empty";
     }
 
-    void timerCallback() override
-    {
-        updateValue();
-    }
-
     float getWhiteKeyWidth() const
     {
         return getValue<int>(keyWidth);
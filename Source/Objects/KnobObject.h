@@ -674,7 +674,7 @@ public:
         }
     }
 
-    void receiveObjectMessage(hash32 const symbol, SmallArray<pd::Atom> const& atoms) override
+    void receiveObjectMessage(hash32 const symbol, std::span<pd::Atom const> atoms) override
     {
         switch (symbol) {
         case hash("float"):
@@ -978,7 +978,7 @@ public:
     {
         ObjectLabel* label = nullptr;
         if (labels.isEmpty()) {
-            label = labels.add(new ObjectLabel());
+            label = labels.add(new ObjectLabel(object));
             object->cnv->addChildComponent(label);
         } else {
             label = labels[0];
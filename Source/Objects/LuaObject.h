@@ -570,7 +570,7 @@ public:
         }
     }
 
-    void receiveObjectMessage(hash32 const symbol, SmallArray<pd::Atom> const& atoms) override
+    void receiveObjectMessage(hash32 const symbol, std::span<pd::Atom const> atoms) override
     {
         if (symbol == hash("open_textfile") && atoms.size() >= 1) {
             openTextEditor(File(atoms[0].toString()));
@@ -673,7 +673,7 @@ public:
         }
     }
 
-    void receiveObjectMessage(hash32 const symbol, SmallArray<pd::Atom> const& atoms) override
+    void receiveObjectMessage(hash32 const symbol, std::span<pd::Atom const> atoms) override
     {
         if (symbol == hash("open_textfile") && atoms.size() >= 1) {
             openTextEditor(File(atoms[0].toString()));
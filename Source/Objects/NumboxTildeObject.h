@@ -7,12 +7,13 @@
 #include "Components/DraggableNumber.h"
 
 class NumboxTildeObject final : public ObjectBase
-    , public Timer {
+    , public PollScheduler::Poller {
 
     DraggableNumber input;
 
     int nextInterval = 100;
     int mode = 0;
+    float polledValue = 0.0f;
 
     Value interval = SynchronousValue();
     Value ramp = SynchronousValue();
@@ -53,7 +54,7 @@ public:
         };
         input.setPrecision(5);
 
-        startTimer(nextInterval);
+        cnv->editor->pollScheduler.addPoller(this, this, nextInterval);
         repaint();
 
         objectParameters.addParamSize(&sizeProperty);
@@ -66,6 +67,11 @@ public:
         objectParameters.addParamColourBG(&secondaryColour);
     }
 
+    ~NumboxTildeObject() override
+    {
+        cnv->editor->pollScheduler.removePoller(this);
+    }
+
     void update() override
     {
         if (input.isShowing())
@@ -255,15 +261,22 @@ public:
         }
     }
 
-    void timerCallback() override
+    void pollSnapshot() override
     {
-        auto const val = getValue();
+        if (auto* nbx = ptr.getRaw<t_fake_numbox>()) {
+            mode = nbx->x_outmode;
+            nextInterval = nbx->x_rate;
+            polledValue = mode ? nbx->x_display : nbx->x_in_val;
+        }
+    }
 
+    void pollApply() override
+    {
         if (!mode) {
-            input.setText(input.formatNumber(val), dontSendNotification);
+            input.setText(input.formatNumber(polledValue), dontSendNotification);
         }
 
-        startTimer(nextInterval);
+        setPollInterval(nextInterval);
     }
 
     float getValue()
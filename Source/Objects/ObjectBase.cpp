@@ -98,6 +98,17 @@ public:
     void setPdBounds(Rectangle<int> newBounds) override { }
 };
 
+void ObjectLabel::moved()
+{
+    object->updateSpatialIndex();
+}
+
+void ObjectLabel::resized()
+{
+    Label::resized();
+    object->updateSpatialIndex();
+}
+
 ObjectBase::ObjectSizeListener::ObjectSizeListener(Object* obj)
     : object(obj)
 {
@@ -541,12 +552,9 @@ void ObjectBase::stopEdition()
 
 void ObjectBase::sendFloatValue(float const newValue)
 {
-    t_atom atom;
-    SETFLOAT(&atom, newValue);
-
-    if (auto obj = ptr.get<t_pd>()) {
-        pd_typedmess(obj.get(), cnv->patch.instance->generateSymbol("set"), 1, &atom);
-        pd_bang(obj.get());
+    // Goes through the direct message queue, so dragging a slider never has to wait for the audio thread
+    if (auto* obj = ptr.getRaw<t_pd>()) {
+        pd->sendDirectFloatValue(obj, newValue);
     }
 }
 
@@ -788,7 +796,7 @@ bool ObjectBase::canReceiveMouseEvent(int x, int y)
     return true;
 }
 
-void ObjectBase::receiveMessage(t_symbol* symbol, SmallArray<pd::Atom> const& atoms)
+void ObjectBase::receiveMessage(t_symbol* symbol, std::span<pd::Atom const> atoms)
 {
     object->triggerOverlayActiveState();
 
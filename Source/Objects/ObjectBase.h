@@ -34,10 +34,12 @@ class ObjectLabel : public Label
     NVGImage image;
     float lastScale = 1.0f;
     bool updateColour = false;
+    Object* object;
 
 public:
-    explicit ObjectLabel()
+    explicit ObjectLabel(Object* parent)
         : NVGComponent(this)
+        , object(parent)
     {
         setJustificationType(Justification::centredLeft);
         setBorderSize(BorderSize<int>(0, 0, 0, 0));
@@ -47,6 +49,10 @@ public:
         setColour(Label::textColourId, Colours::white);
     }
 
+    // Labels are part of the area that the object takes up on the canvas
+    void moved() override;
+    void resized() override;
+
     void setLabelColour(Colour c)
     {
         setColour(Label::textColourId, c);
@@ -184,7 +190,7 @@ public:
     virtual void onConstrainerCreate() { }
 
     // Called whenever the object receives a pd message
-    virtual void receiveObjectMessage(hash32 symbol, SmallArray<pd::Atom> const& atoms) { }
+    virtual void receiveObjectMessage(hash32 symbol, std::span<pd::Atom const> atoms) { }
 
     // Close any tabs with opened subpatchers
     void closeOpenedSubpatchers();
@@ -193,7 +199,7 @@ public:
     // Attempt to send "click" message to object. Returns false if the object has no such method
     bool click(Point<int> position, bool shift, bool alt);
 
-    void receiveMessage(t_symbol* symbol, SmallArray<pd::Atom> const& atoms) override;
+    void receiveMessage(t_symbol* symbol, std::span<pd::Atom const> atoms) override;
 
     static ObjectBase* createGui(pd::WeakReference ptr, Object* parent);
 
@@ -426,7 +426,7 @@ public:
         mouseMove(e);
     }
 
-    void receiveMessage(t_symbol* symbol, SmallArray<pd::Atom> const& atoms) override
+    void receiveMessage(t_symbol* symbol, std::span<pd::Atom const> atoms) override
     {
         if (!cnv || pd->isPerformingGlobalSync)
             return;
@@ -702,7 +702,7 @@ public:
         pd->unregisterMessageListener(this);
     }
 
-    void receiveMessage(t_symbol* symbol, SmallArray<pd::Atom> const& atoms) override
+    void receiveMessage(t_symbol* symbol, std::span<pd::Atom const> atoms) override
     {
         if (pd->isPerformingGlobalSync)
             return;
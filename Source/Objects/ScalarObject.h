@@ -52,7 +52,7 @@ public:
         pd->unregisterMessageListener(this);
     }
 
-    void receiveMessage(t_symbol* symbol, SmallArray<pd::Atom> const& atoms) override
+    void receiveMessage(t_symbol* symbol, std::span<pd::Atom const> atoms) override
     {
         if (hash(symbol->s_name) == hash("redraw")) {
             triggerAsyncUpdate();
@@ -1166,7 +1166,7 @@ struct ScalarObject final : public ObjectBase {
         return { };
     }
 
-    void receiveObjectMessage(hash32 const symbol, SmallArray<pd::Atom> const& atoms) override
+    void receiveObjectMessage(hash32 const symbol, std::span<pd::Atom const> atoms) override
     {
         if (symbol == hash("redraw")) {
             updateDrawables();
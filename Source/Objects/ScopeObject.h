@@ -6,11 +6,18 @@
 #pragma once
 
 class ScopeObject final : public ObjectBase
-    , public Timer {
+    , public PollScheduler::Poller {
 
     HeapArray<float> x_buffer;
     HeapArray<float> y_buffer;
 
+    // State copied from the scope while holding the audio lock
+    int scopeMode = 0;
+    int scopeBufferSize = 0;
+    float scopeMin = 0.0f;
+    float scopeMax = 1.0f;
+    bool hasNewSnapshot = false;
+
     Value gridColour = SynchronousValue();
     Value triggerMode = SynchronousValue();
     Value triggerValue = SynchronousValue();
@@ -43,7 +50,12 @@ public:
 
         objectParameters.addParamReceiveSymbol(&receiveSymbol);
 
-        startTimerHz(25);
+        cnv->editor->pollScheduler.addPoller(this, this, 1000 / 25);
+    }
+
+    ~ScopeObject() override
+    {
+        cnv->editor->pollScheduler.removePoller(this);
     }
 
     void updateSizeProperty() override
@@ -173,33 +185,43 @@ public:
         }
     }
 
-    void timerCallback() override
+    void pollSnapshot() override
     {
         if (freezeScope)
             return;
 
-        int mode = 0;
-        int bufsize = 0;
-        float min = 0.0f;
-        float max = 1.0f;
+        if (auto* scope = ptr.getRaw<t_fake_scope>()) {
+            scopeBufferSize = scope->x_bufsize;
+            scopeMin = scope->x_min;
+            scopeMax = scope->x_max;
+            scopeMode = scope->x_xymode;
 
-        if (object->iolets.size() == 3)
-            object->iolets[2]->setVisible(false);
-
-        if (auto scope = ptr.get<t_fake_scope>()) {
-            bufsize = scope->x_bufsize;
-            min = scope->x_min;
-            max = scope->x_max;
-            mode = scope->x_xymode;
-
-            if (x_buffer.size() != bufsize) {
-                x_buffer.resize(bufsize);
-                y_buffer.resize(bufsize);
+            if (x_buffer.size() != scopeBufferSize) {
+                x_buffer.resize(scopeBufferSize);
+                y_buffer.resize(scopeBufferSize);
             }
 
-            std::copy_n(scope->x_xbuflast, bufsize, x_buffer.data());
-            std::copy_n(scope->x_ybuflast, bufsize, y_buffer.data());
+            std::copy_n(scope->x_xbuflast, scopeBufferSize, x_buffer.data());
+            std::copy_n(scope->x_ybuflast, scopeBufferSize, y_buffer.data());
+            hasNewSnapshot = true;
         }
+    }
+
+    void pollApply() override
+    {
+        // Normalising happens in place, so only do it once for every snapshot
+        if (!hasNewSnapshot)
+            return;
+
+        hasNewSnapshot = false;
+
+        if (object->iolets.size() == 3)
+            object->iolets[2]->setVisible(false);
+
+        auto const mode = scopeMode;
+        auto const bufsize = scopeBufferSize;
+        auto min = scopeMin;
+        auto max = scopeMax;
 
         // Normalise the buffers
         if (min > max) {
@@ -308,7 +330,7 @@ public:
         }
     }
 
-    void receiveObjectMessage(hash32 const symbol, SmallArray<pd::Atom> const& atoms) override
+    void receiveObjectMessage(hash32 const symbol, std::span<pd::Atom const> atoms) override
     {
         switch (symbol) {
         case hash("receive"): {
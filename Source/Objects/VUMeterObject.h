@@ -15,7 +15,8 @@ class VUScale final : public ObjectLabel {
     NVGcontext* lastContext = nullptr;
 
 public:
-    VUScale()
+    explicit VUScale(Object* parent)
+        : ObjectLabel(parent)
     {
     }
 
@@ -130,8 +131,8 @@ public:
         ObjectLabel* label = nullptr;
         VUScale* vuScale = nullptr;
         if (labels.isEmpty()) {
-            label = labels.add(new ObjectLabel());
-            vuScale = reinterpret_cast<VUScale*>(labels.add(new VUScale()));
+            label = labels.add(new ObjectLabel(object));
+            vuScale = reinterpret_cast<VUScale*>(labels.add(new VUScale(object)));
             object->cnv->addChildComponent(label);
             object->cnv->addChildComponent(vuScale);
         } else {
@@ -260,7 +261,7 @@ public:
         nvgDrawRoundedRect(nvg, b.getX(), b.getY(), b.getWidth(), b.getHeight(), nvgRGBA(0, 0, 0, 0), object->isSelected() ? cnv->selectedOutlineCol : cnv->objectOutlineCol, Corners::objectCornerRadius);
     }
 
-    void receiveObjectMessage(hash32 const symbol, SmallArray<pd::Atom> const& atoms) override
+    void receiveObjectMessage(hash32 const symbol, std::span<pd::Atom const> atoms) override
     {
         switch (symbol) {
         case hash("float"): {
@@ -0,0 +1,141 @@
+/*
+ // Copyright (c) 2025 Timothy Schoen.
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+#pragma once
+
+#include "Instance.h"
+
+namespace pd {
+
+// Preallocated single-producer, single-consumer ring of messages from the GUI to Pd objects
+// The message thread is the only producer. Consuming requires holding the Pd lock, so the audio thread
+// (at the start of a block) and any thread that calls lockAudioThread() take turns as the single consumer
+// Pushing and draining never allocate: atoms and selectors are stored inline, and each slot keeps its
+// weak reference registered until the slot gets reused for a different object
+class DirectMessageQueue {
+public:
+    static constexpr int Capacity = 512;
+    static constexpr int MaxAtoms = 16;
+    static constexpr int MaxSelectorLength = 64;
+
+    enum Type : uint8_t {
+        Float,
+        Symbol,
+        List,
+        Message,
+        SetAndBang
+    };
+
+    struct Command {
+        void* target = nullptr;
+        pd_weak_reference alive = false;
+        Type type = Float;
+        bool coalesce = false;
+        bool superseded = false;
+        int numAtoms = 0;
+        StackArray<char, MaxSelectorLength> selector;
+        StackArray<pd::Atom, MaxAtoms> atoms;
+    };
+
+    explicit DirectMessageQueue(Instance* parent)
+        : instance(parent)
+        , commands(Capacity)
+    {
+        coalescedTargets.reserve(Capacity);
+    }
+
+    ~DirectMessageQueue()
+    {
+        for (auto& command : commands) {
+            if (command.target && command.alive)
+                instance->unregisterWeakReference(command.target, &command.alive);
+        }
+    }
+
+    // Message thread only. Returns false if the command doesn't fit, in which case the caller should send it synchronously
+    bool push(void* target, Type const type, char const* selector, pd::Atom const* atoms, int const numAtoms, bool const coalesce = false)
+    {
+        auto const selectorLength = selector ? std::strlen(selector) : 0;
+        if (!target || numAtoms > MaxAtoms || selectorLength >= MaxSelectorLength)
+            return false;
+
+        auto const write = tail.load(std::memory_order_relaxed);
+        auto const used = static_cast<int>(write - head.load(std::memory_order_acquire));
+        if (EXPECT_UNLIKELY(used >= Capacity)) {
+            numOverflowed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        auto& command = commands[write & (Capacity - 1)];
+
+        // Slots stay registered to their last target, so repeatedly messaging the same object doesn't touch the weak reference map
+        if (command.target != target || !command.alive) {
+            if (command.target && command.alive)
+                instance->unregisterWeakReference(command.target, &command.alive);
+
+            command.target = target;
+            command.alive = true;
+            instance->registerWeakReference(target, &command.alive);
+        }
+
+        command.type = type;
+        command.coalesce = coalesce;
+        command.superseded = false;
+        command.numAtoms = numAtoms;
+        std::copy_n(atoms, numAtoms, command.atoms.data());
+        std::copy_n(selector ? selector : "", selectorLength + 1, command.selector.data());
+
+        tail.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool hasPendingMessages() const
+    {
+        return head.load(std::memory_order_relaxed) != tail.load(std::memory_order_relaxed);
+    }
+
+    // Pd lock must be held. Only the newest coalescing command per target is delivered
+    template<typename Callback>
+    void drain(Callback const& processCommand)
+    {
+        auto const read = head.load(std::memory_order_relaxed);
+        auto const write = tail.load(std::memory_order_acquire);
+        if (read == write)
+            return;
+
+        coalescedTargets.clear();
+        for (auto i = write; i != read; --i) {
+            auto& command = commands[(i - 1) & (Capacity - 1)];
+            command.superseded = command.coalesce && !coalescedTargets.insert(command.target).second;
+        }
+
+        for (auto i = read; i != write; ++i) {
+            auto& command = commands[i & (Capacity - 1)];
+            if (!command.superseded && command.alive)
+                processCommand(command);
+
+            // Hand the slot back to the producer as soon as we're done with it
+            head.store(i + 1, std::memory_order_release);
+        }
+    }
+
+    // Number of messages that didn't fit since the last call, those were sent synchronously instead
+    int takeNumOverflowed()
+    {
+        return numOverflowed.exchange(0, std::memory_order_relaxed);
+    }
+
+private:
+    Instance* instance;
+    HeapArray<Command> commands;
+    UnorderedSet<void*> coalescedTargets;
+
+    std::atomic<uint32_t> head = 0;
+    std::atomic<uint32_t> tail = 0;
+
+    std::atomic<int> numOverflowed = 0;
+};
+
+}
@@ -8,13 +8,14 @@
 
 #include "Utility/Config.h"
 #include "Utility/Fonts.h"
-#include "Utility/CachedStringWidth.h"
+#include "Utility/ConsoleHistory.h"
 #include "Dialogs/Dialogs.h"
 
 #include <algorithm>
 #include "Instance.h"
 #include "Patch.h"
 #include "MessageListener.h"
+#include "DirectMessageQueue.h"
 #include "Objects/ImplementationBase.h"
 #include "Utility/SettingsFile.h"
 
@@ -43,23 +44,6 @@ public:
         startTimerHz(30);
     }
 
-    void addMessage(void* object, String const& message, bool type)
-    {
-        if (consoleMessages.size()) {
-            auto& [lastObject, lastMessage, lastType, lastLength, numMessages] = consoleMessages.back();
-            if (object == lastObject && message == lastMessage && static_cast<int>(type) == lastType) {
-                numMessages++;
-            } else {
-                consoleMessages.emplace_back(object, message, type, CachedStringWidth<14>::calculateStringWidth(message) + 40, 1);
-            }
-        } else {
-            consoleMessages.emplace_back(object, message, type, CachedStringWidth<14>::calculateStringWidth(message) + 40, 1);
-        }
-
-        if (consoleMessages.size() > 800)
-            consoleMessages.pop_front();
-    }
-
     void logMessage(void* object, SmallString const& message)
     {
         pendingMessages.enqueue({ object, message, false });
@@ -75,56 +59,57 @@ public:
         pendingMessages.enqueue({ object, error, true });
     }
 
+    // Called from Pd's print hook, which can run on the audio thread, so this only copies into preallocated buffers
     void processPrint(void* object, char const* message)
     {
-        std::function<void(SmallString const&)> const forwardMessage =
-            [this, object](SmallString const& message) {
-                if (message.startsWith("error")) {
-                    logError(object, message.substring(7));
-                } else if (message.startsWith("verbose(0):") || message.startsWith("verbose(1):")) {
-                    logError(object, message.substring(12));
-                } else {
-                    if (message.startsWith("verbose(")) {
-                        logMessage(object, message.substring(12));
-                    } else {
-                        logMessage(object, message);
-                    }
-                }
-            };
-
-        printConcatBuffer[messageLength] = '\0';
-
-        int len = static_cast<int>(strlen(message));
-        while (messageLength + len >= 2048) {
-            int const d = 2048 - 1 - messageLength;
-            strncat(printConcatBuffer.data(), message, d);
-
-            // Send concatenated line to plugdata!
-            forwardMessage(SmallString(printConcatBuffer.data()));
-
-            message += d;
-            len -= d;
-            messageLength = 0;
-            printConcatBuffer[0] = '\0';
+        auto length = strlen(message);
+        while (length) {
+            auto const numToCopy = std::min(length, printConcatBuffer.size() - 1 - messageLength);
+            std::copy_n(message, numToCopy, printConcatBuffer.data() + messageLength);
+            messageLength += numToCopy;
+            message += numToCopy;
+            length -= numToCopy;
+
+            // Pd prints a line in parts, the line is complete once it ends with a newline
+            auto const endOfLine = printConcatBuffer[messageLength - 1] == '\n';
+            if (endOfLine || messageLength == printConcatBuffer.size() - 1) {
+                printLine(object, endOfLine ? messageLength - 1 : messageLength);
+                messageLength = 0;
+            }
         }
+    }
 
-        strncat(printConcatBuffer.data(), message, len);
-        messageLength += len;
-
-        if (messageLength > 0 && printConcatBuffer[messageLength - 1] == '\n') {
-            printConcatBuffer[messageLength - 1] = '\0';
-
-            // Send concatenated line to plugdata!
-            forwardMessage(SmallString(printConcatBuffer.data()));
+    ConsoleHistory history;
 
-            messageLength = 0;
+private:
+    void printLine(void* object, size_t length)
+    {
+        auto const* line = printConcatBuffer.data();
+        auto const startsWith = [line, length](char const* prefix) {
+            auto const prefixLength = strlen(prefix);
+            return length >= prefixLength && std::equal(prefix, prefix + prefixLength, line);
+        };
+        auto const skip = [&line, &length](size_t const numChars) {
+            auto const n = std::min(numChars, length);
+            line += n;
+            length -= n;
+        };
+
+        bool isError = false;
+        if (startsWith("error")) {
+            isError = true;
+            skip(7);
+        } else if (startsWith("verbose(0):") || startsWith("verbose(1):")) {
+            isError = true;
+            skip(12);
+        } else if (startsWith("verbose(")) {
+            skip(12);
         }
-    }
 
-    std::deque<std::tuple<void*, String, int, int, int>> consoleMessages;
-    std::deque<std::tuple<void*, String, int, int, int>> consoleHistory;
+        if (!printRing.write(object, isError, line, length))
+            numDroppedLines++;
+    }
 
-private:
     void timerCallback() override
     {
         auto item = std::tuple<void*, SmallString, bool>();
@@ -133,22 +118,44 @@ private:
 
         while (pendingMessages.try_dequeue(item)) {
             auto& [object, message, type] = item;
-            addMessage(object, message.toString(), type);
+            history.add(object, type, message.data(), message.length());
 
             numReceived++;
             newWarning = newWarning || type;
         }
 
-        // Check if any item got assigned
+        numReceived += printRing.read([this, &newWarning](void* object, int const type, char const* text, size_t const length) {
+            history.add(object, type, text, length);
+            newWarning = newWarning || type;
+        });
+
+        if (auto const numDropped = numDroppedLines.exchange(0)) {
+            auto const warning = String(numDropped) + " console messages were dropped, because they were printed faster than the console could keep up";
+            history.add(nullptr, 1, warning.toRawUTF8(), warning.getNumBytesAsUTF8());
+            numReceived++;
+            newWarning = true;
+        }
+
+        if (auto const numOverflowed = instance->directMessageQueue ? instance->directMessageQueue->takeNumOverflowed() : 0) {
+            auto const warning = String(numOverflowed) + " GUI messages didn't fit in the message queue, and had to wait for the audio thread";
+            history.add(nullptr, 1, warning.toRawUTF8(), warning.getNumBytesAsUTF8());
+            numReceived++;
+            newWarning = true;
+        }
+
         if (numReceived) {
             instance->updateConsole(numReceived, newWarning);
         }
     }
 
     StackArray<char, 2048> printConcatBuffer = { };
+    size_t messageLength = 0;
+
+    ConsolePrintRing printRing;
+    std::atomic<int> numDroppedLines = 0;
 
+    // Messages from plugdata itself, these can come from any thread
     moodycamel::ConcurrentQueue<std::tuple<void*, SmallString, bool>> pendingMessages = moodycamel::ConcurrentQueue<std::tuple<void*, SmallString, bool>>(512);
-    int messageLength = 0;
 };
 
 struct Instance::dmessage {
@@ -252,6 +259,7 @@ struct Instance::internal {
 
 Instance::Instance()
     : messageDispatcher(std::make_unique<MessageDispatcher>())
+    , directMessageQueue(std::make_unique<DirectMessageQueue>(this))
     , consoleMessageHandler(std::make_unique<ConsoleMessageHandler>(this))
 {
     pd::Setup::initialisePd();
@@ -268,6 +276,7 @@ Instance::~Instance()
     }
 
     objectImplementations.reset(nullptr); // Make sure it gets deallocated before pd instance gets deleted
+    directMessageQueue.reset(nullptr);    // Unregisters its weak references, so needs to go before pdWeakReferences
 
     libpd_set_instance(static_cast<t_pdinstance*>(instance));
     pd_free(static_cast<t_pd*>(messageReceiver));
@@ -275,6 +284,7 @@ Instance::~Instance()
     gensym("#plugdata_print")->s_thing = nullptr; // In case any object tries to print during shutdown
     pd_free(static_cast<t_pd*>(printReceiver));
     pd_free(static_cast<t_pd*>(parameterReceiver));
+    pd_free(static_cast<t_pd*>(playheadReceiver));
     pd_free(static_cast<t_pd*>(pluginLatencyReceiver));
     pd_free(static_cast<t_pd*>(dataBufferReceiver));
 
@@ -325,6 +335,9 @@ void Instance::initialisePd(String& pdlua_version)
     parameterReceiver = pd::Setup::createReceiver(this, "__param", reinterpret_cast<t_plugdata_banghook>(internal::instance_multi_bang), reinterpret_cast<t_plugdata_floathook>(internal::instance_multi_float), reinterpret_cast<t_plugdata_symbolhook>(internal::instance_multi_symbol),
         reinterpret_cast<t_plugdata_listhook>(internal::instance_multi_list), reinterpret_cast<t_plugdata_messagehook>(internal::instance_multi_message));
 
+    playheadReceiver = pd::Setup::createReceiver(this, "__playhead_refresh", reinterpret_cast<t_plugdata_banghook>(internal::instance_multi_bang), reinterpret_cast<t_plugdata_floathook>(internal::instance_multi_float), reinterpret_cast<t_plugdata_symbolhook>(internal::instance_multi_symbol),
+        reinterpret_cast<t_plugdata_listhook>(internal::instance_multi_list), reinterpret_cast<t_plugdata_messagehook>(internal::instance_multi_message));
+
     pluginLatencyReceiver = pd::Setup::createReceiver(this, "__latency_compensation", reinterpret_cast<t_plugdata_banghook>(internal::instance_multi_bang), reinterpret_cast<t_plugdata_floathook>(internal::instance_multi_float), reinterpret_cast<t_plugdata_symbolhook>(internal::instance_multi_symbol),
         reinterpret_cast<t_plugdata_listhook>(internal::instance_multi_list), reinterpret_cast<t_plugdata_messagehook>(internal::instance_multi_message));
 
@@ -965,8 +978,22 @@ void Instance::enqueueGuiMessage(Message const& message)
     }
 }
 
+bool Instance::enqueueDirectMessage(void* object, int const type, char const* selector, pd::Atom const* atoms, int const numAtoms, bool const coalesce)
+{
+    // The queue only has a single producer, other threads have to take the lock
+    if (!MessageManager::existsAndIsCurrentThread())
+        return false;
+
+    return directMessageQueue->push(object, static_cast<DirectMessageQueue::Type>(type), selector, atoms, numAtoms, coalesce);
+}
+
+// If the message doesn't fit in the queue, we fall back to sending it under the lock
+// lockAudioThread() delivers everything that's still queued first, so the order is preserved
 void Instance::sendDirectMessage(void* object, SmallString const& msg, SmallArray<Atom> const&& list)
 {
+    if (enqueueDirectMessage(object, DirectMessageQueue::Message, msg.data(), list.data(), list.size()))
+        return;
+
     lockAudioThread();
     processSend(dmessage(this, object, SmallString(), msg, std::move(list)));
     unlockAudioThread();
@@ -974,6 +1001,9 @@ void Instance::sendDirectMessage(void* object, SmallString const& msg, SmallArra
 
 void Instance::sendDirectMessage(void* object, SmallArray<Atom> const&& list)
 {
+    if (enqueueDirectMessage(object, DirectMessageQueue::List, nullptr, list.data(), list.size()))
+        return;
+
     lockAudioThread();
     processSend(dmessage(this, object, SmallString(), "list", std::move(list)));
     unlockAudioThread();
@@ -981,6 +1011,9 @@ void Instance::sendDirectMessage(void* object, SmallArray<Atom> const&& list)
 
 void Instance::sendDirectMessage(void* object, SmallString const& msg)
 {
+    if (enqueueDirectMessage(object, DirectMessageQueue::Symbol, msg.data(), nullptr, 0))
+        return;
+
     lockAudioThread();
     processSend(dmessage(this, object, SmallString(), "symbol", SmallArray<Atom>(1, generateSymbol(msg))));
     unlockAudioThread();
@@ -988,11 +1021,73 @@ void Instance::sendDirectMessage(void* object, SmallString const& msg)
 
 void Instance::sendDirectMessage(void* object, float const msg)
 {
+    auto const atom = Atom(msg);
+    if (enqueueDirectMessage(object, DirectMessageQueue::Float, nullptr, &atom, 1))
+        return;
+
     lockAudioThread();
     processSend(dmessage(this, object, String(), "float", SmallArray<Atom>(1, msg)));
     unlockAudioThread();
 }
 
+void Instance::sendDirectFloatValue(void* object, float const value)
+{
+    auto const atom = Atom(value);
+    if (enqueueDirectMessage(object, DirectMessageQueue::SetAndBang, nullptr, &atom, 1, true))
+        return;
+
+    t_atom argv;
+    SETFLOAT(&argv, value);
+
+    lockAudioThread();
+    pd_typedmess(static_cast<t_pd*>(object), generateSymbol("set"), 1, &argv);
+    pd_bang(static_cast<t_pd*>(object));
+    unlockAudioThread();
+}
+
+// Pd lock must be held when calling this
+void Instance::processDirectMessages()
+{
+    if (!directMessageQueue || isProcessingDirectMessages || !directMessageQueue->hasPendingMessages())
+        return;
+
+    // Delivering a message could end up calling lockAudioThread() again
+    isProcessingDirectMessages = true;
+
+    directMessageQueue->drain([this](DirectMessageQueue::Command const& command) {
+        auto* object = static_cast<t_pd*>(command.target);
+
+        StackArray<t_atom, DirectMessageQueue::MaxAtoms> argv;
+        for (int i = 0; i < command.numAtoms; i++) {
+            if (command.atoms[i].isFloat())
+                SETFLOAT(argv.data() + i, command.atoms[i].getFloat());
+            else
+                SETSYMBOL(argv.data() + i, command.atoms[i].getSymbol());
+        }
+
+        switch (command.type) {
+        case DirectMessageQueue::Float:
+            pd_float(object, command.atoms[0].getFloat());
+            break;
+        case DirectMessageQueue::Symbol:
+            pd_symbol(object, gensym(command.selector.data()));
+            break;
+        case DirectMessageQueue::List:
+            pd_list(object, &s_list, command.numAtoms, argv.data());
+            break;
+        case DirectMessageQueue::Message:
+            pd_typedmess(object, gensym(command.selector.data()), command.numAtoms, argv.data());
+            break;
+        case DirectMessageQueue::SetAndBang:
+            pd_typedmess(object, gensym("set"), command.numAtoms, argv.data());
+            pd_bang(object);
+            break;
+        }
+    });
+
+    isProcessingDirectMessages = false;
+}
+
 void Instance::handleAsyncUpdate()
 {
     Message mess;
@@ -1012,6 +1107,9 @@ void Instance::handleAsyncUpdate()
         case hash("__param"):
             handleParameterMessage(mess.list);
             break;
+        case hash("__playhead_refresh"):
+            resendPlayhead();
+            break;
         case hash("__to_daw_databuffer"):
             fillDataBuffer(mess.list);
             break;
@@ -1025,6 +1123,14 @@ void Instance::sendMessagesFromQueue()
 {
     libpd_set_instance(static_cast<t_pdinstance*>(instance));
 
+    // Deliver everything the GUI sent with sendDirectMessage since the last block, under a single lock
+    // This used to be sent right away, so it goes before functions that were queued in the meantime
+    if (directMessageQueue->hasPendingMessages()) {
+        sys_lock();
+        processDirectMessages();
+        sys_unlock();
+    }
+
     std::function<void()> callback;
     while (functionQueue.try_dequeue(callback)) {
         callback();
@@ -1082,14 +1188,9 @@ void Instance::logWarning(String const& warning)
     consoleMessageHandler->logWarning(nullptr, warning);
 }
 
-std::deque<std::tuple<void*, String, int, int, int>>& Instance::getConsoleMessages() const
-{
-    return consoleMessageHandler->consoleMessages;
-}
-
-std::deque<std::tuple<void*, String, int, int, int>>& Instance::getConsoleHistory() const
+ConsoleHistory& Instance::getConsoleHistory() const
 {
-    return consoleMessageHandler->consoleHistory;
+    return consoleMessageHandler->history;
 }
 
 void Instance::createPanel(int const type, char const* snd, char const* location, char const* callbackName, int openMode)
@@ -1198,6 +1299,9 @@ void Instance::lockAudioThread()
 {
     setThis();
     sys_lock();
+
+    // Make sure queued GUI messages arrive before anything the caller is about to do with the lock held
+    processDirectMessages();
 }
 
 void Instance::unlockAudioThread()
@@ -1205,9 +1309,14 @@ void Instance::unlockAudioThread()
     sys_unlock();
 }
 
-void Instance::updateObjectImplementations()
+void Instance::updateObjectImplementations(t_glist const* changedPatch)
+{
+    objectImplementations->updateObjectImplementations(changedPatch);
+}
+
+void Instance::rescanObjectImplementations()
 {
-    objectImplementations->updateObjectImplementations();
+    objectImplementations->rescanAllPatches();
 }
 
 void Instance::clearObjectImplementationsForPatch(pd::Patch const* p)
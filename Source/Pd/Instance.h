@@ -16,6 +16,7 @@ extern "C" {
 #include "Patch.h"
 
 class ObjectImplementationManager;
+class ConsoleHistory;
 
 namespace pd {
 class ConsoleMessageHandler;
@@ -152,6 +153,7 @@ private:
 
 class MessageListener;
 class MessageDispatcher;
+class DirectMessageQueue;
 class Patch;
 class Instance : public AsyncUpdater {
     struct Message {
@@ -246,10 +248,15 @@ public:
     void sendDirectMessage(void* object, SmallString const& msg);
     void sendDirectMessage(void* object, float msg);
 
-    void updateObjectImplementations();
+    // Sends "set" followed by a bang, only the newest value per object gets delivered each block
+    void sendDirectFloatValue(void* object, float value);
+
+    void updateObjectImplementations(t_glist const* changedPatch = nullptr);
+    void rescanObjectImplementations();
     void clearObjectImplementationsForPatch(pd::Patch const* p);
 
     virtual void handleParameterMessage(SmallArray<pd::Atom> const& atoms) = 0;
+    virtual void resendPlayhead() = 0;
     virtual void performLatencyCompensationChange(float value) = 0;
 
     virtual void fillDataBuffer(SmallArray<pd::Atom> const& list) = 0;
@@ -259,11 +266,11 @@ public:
     void logError(String const& message);
     void logWarning(String const& message);
 
-    std::deque<std::tuple<void*, String, int, int, int>>& getConsoleMessages() const;
-    std::deque<std::tuple<void*, String, int, int, int>>& getConsoleHistory() const;
+    ConsoleHistory& getConsoleHistory() const;
 
     void sendMessagesFromQueue();
     void processSend(dmessage const& mess);
+    void processDirectMessages();
 
     Patch::Ptr openPatch(File const& toOpen);
 
@@ -282,6 +289,7 @@ public:
     void* instance = nullptr;
     void* messageReceiver = nullptr;
     void* parameterReceiver = nullptr;
+    void* playheadReceiver = nullptr;
     void* pluginLatencyReceiver = nullptr;
     void* midiReceiver = nullptr;
     void* printReceiver = nullptr;
@@ -294,12 +302,16 @@ public:
     CriticalSection const audioLock;
     CriticalSection const weakReferenceLock;
     std::unique_ptr<pd::MessageDispatcher> messageDispatcher;
+    std::unique_ptr<pd::DirectMessageQueue> directMessageQueue;
 
     // All opened patches
     SmallArray<pd::Patch::Ptr, 16> patches;
 
 private:
+    bool enqueueDirectMessage(void* object, int type, char const* selector, pd::Atom const* atoms, int numAtoms, bool coalesce = false);
+
     UnorderedMap<void*, SmallArray<pd_weak_reference*>> pdWeakReferences;
+    bool isProcessingDirectMessages = false; // Only accessed while holding the Pd lock
 
     moodycamel::ConcurrentQueue<std::function<void()>> functionQueue = moodycamel::ConcurrentQueue<std::function<void()>>(4096);
     moodycamel::ConcurrentQueue<Message> guiMessageQueue = moodycamel::ConcurrentQueue<Message>(64);
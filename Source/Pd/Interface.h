@@ -729,6 +729,15 @@ struct Interface {
     }
 
     static void getCanvasContent(t_canvas* cnv, char** buf, int* bufsize)
+    {
+        t_binbuf* b = getCanvasBinbuf(cnv);
+        binbuf_gettext(b, buf, bufsize);
+        binbuf_free(b);
+    }
+
+    // Serialises a canvas into a new binbuf, which is owned by the caller
+    // Needs the audio lock, but converting the result to text doesn't, so callers can do that after releasing it
+    static t_binbuf* getCanvasBinbuf(t_canvas* cnv)
     {
         t_binbuf* b = binbuf_new();
 
@@ -797,8 +806,7 @@ struct Interface {
                     static_cast<t_float>(cnv->gl_isgraph));
         }
 
-        binbuf_gettext(b, buf, bufsize);
-        binbuf_free(b);
+        return b;
     }
 
     static int numOutlets(t_object const* x)
@@ -14,7 +14,6 @@
 
 #include "Utility/OSUtils.h"
 #include "Utility/SettingsFile.h"
-#include "Utility/Decompress.h"
 
 extern "C" {
 #include <m_pd.h>
@@ -42,15 +41,17 @@ namespace pd {
 Library::Library(pd::Instance* instance)
     : Thread("Library Index Thread")
     , pd(instance)
+    , allObjects(std::make_shared<StringArray const>())
 {
-    watcher.addFolder(ProjectInfo::appDataDir);
+    watcher.addFolder(ProjectInfo::appDataDir, false);
     watcher.addListener(this);
+    patchDirectoryWatcher.addListener(this);
 
     // Needs to be async, otherwise LV2 validation fails
-    MessageManager::callAsync([this, pd = juce::WeakReference(pd)] {
-        if (pd.get()) {
+    MessageManager::callAsync([library = juce::WeakReference(this), pd = juce::WeakReference(pd)] {
+        if (library.get() && pd.get()) {
             pd->setThis();
-            updateLibrary();
+            library->updateLibrary();
         }
     });
 
@@ -60,13 +61,16 @@ Library::Library(pd::Instance* instance)
 Library::~Library()
 {
     appDirChanged = nullptr;
+    signalThreadShouldExit();
+    notify();
     waitForThreadToExit(-1);
 }
 
+// Only takes a snapshot of the objects that Pd knows about while holding the audio lock
+// Scanning the search paths happens on the library thread
 void Library::updateLibrary()
 {
-    auto const settingsTree = ValueTree::fromXml(ProjectInfo::appDataDir.getChildFile(".settings").loadFileAsString());
-    auto const pathTree = settingsTree.getChildWithName("Paths");
+    StringArray objects;
 
     pd->lockAudioThread();
     pd->setThis();
@@ -77,7 +81,7 @@ void Library::updateLibrary()
     auto* mlist = static_cast<t_methodentry*>(libpd_get_class_methods(o));
     t_methodentry* m;
 
-    allObjects.clear();
+    objects.ensureStorageAllocated(o->c_nmethod);
 
     int i;
     for (i = o->c_nmethod, m = mlist; i--; m++) {
@@ -86,246 +90,543 @@ void Library::updateLibrary()
 
         auto newName = String::fromUTF8(m->me_name->s_name);
         if (!(newName.startsWith("else/") || newName.startsWith("cyclone/") || newName.endsWith("_aliased") || newName.endsWith(":gfx"))) {
-            allObjects.add(newName);
+            objects.add(newName);
         }
     }
 
-    // Find patches in our search tree
+    pd->unlockAudioThread();
+
+    {
+        ScopedLock lock(pdObjectsLock);
+        pdObjects = std::move(objects);
+    }
+
+    notify();
+}
+
+void Library::updateObjectIndex()
+{
+    StringArray objects;
+    {
+        ScopedLock lock(pdObjectsLock);
+        objects = pdObjects;
+    }
+
+    auto const settingsTree = ValueTree::fromXml(ProjectInfo::appDataDir.getChildFile(".settings").loadFileAsString());
+    auto const pathTree = settingsTree.getChildWithName("Paths");
+
+    // Find patches in our search tree, only rescanning folders that changed since the last update
+    UnorderedMap<hash32, DirectoryIndex> newDirectoryIndex;
     for (auto path : pathTree) {
         auto filePath = path.getProperty("Path").toString();
 
         auto file = File(filePath);
-        if (!file.exists() || !file.isDirectory())
+        if (!file.isDirectory())
+            continue;
+
+        auto const pathHash = hash(file.getFullPathName());
+        auto const lastModified = file.getLastModificationTime();
+        if (newDirectoryIndex.count(pathHash))
             continue;
 
-        for (auto const& file : OSUtils::iterateDirectory(file, false, true)) {
-            if (file.hasFileExtension("pd") || file.hasFileExtension("pd_lua")) {
-                auto filename = file.getFileNameWithoutExtension();
-                if (!filename.startsWith("help-") && !filename.endsWith("-help")) {
-                    allObjects.add(filename);
+        auto& entry = newDirectoryIndex[pathHash];
+        if (auto const existing = directoryIndex.find(pathHash); existing != directoryIndex.end() && existing->second.lastModified == lastModified) {
+            entry = std::move(existing->second);
+        } else {
+            entry.lastModified = lastModified;
+            for (auto const& child : OSUtils::iterateDirectory(file, false, true)) {
+                if (child.hasFileExtension("pd") || child.hasFileExtension("pd_lua")) {
+                    auto filename = child.getFileNameWithoutExtension();
+                    if (!filename.startsWith("help-") && !filename.endsWith("-help")) {
+                        entry.patches.add(filename);
+                    }
                 }
             }
         }
+
+        objects.addArray(entry.patches);
     }
+    directoryIndex = std::move(newDirectoryIndex);
 
     // These can't be created by name in Pd, but plugdata allows it
-    allObjects.add("graph");
-    allObjects.add("garray");
+    objects.add("graph");
+    objects.add("garray");
 
     // These aren't in there but should be
-    allObjects.add("float");
-    allObjects.add("symbol");
-    allObjects.add("list");
+    objects.add("float");
+    objects.add("symbol");
+    objects.add("list");
 
-    pd->unlockAudioThread();
+    // Sort so we can find prefix matches with a binary search
+    objects.sort(false);
+    objects.strings.removeRange(static_cast<int>(std::unique(objects.begin(), objects.end()) - objects.begin()), objects.size());
+
+    auto newObjects = std::make_shared<StringArray const>(std::move(objects));
+
+    SpinLock::ScopedLockType lock(allObjectsLock);
+    allObjects = std::move(newObjects);
 }
 
-Library::ObjectReferenceTable Library::parseObjectEntry(ValueTree const& objectEntry)
+std::shared_ptr<StringArray const> Library::getObjectList() const
 {
-    ObjectReferenceTable table;
+    SpinLock::ScopedLockType lock(allObjectsLock);
+    return allObjects;
+}
 
-    auto parseReferenceItem = [](ValueTree const& node) -> ObjectReferenceTable::ReferenceItem {
-        return {
-            node.getProperty("type").toString(),
-            node.getProperty("description").toString()
-        };
+std::shared_ptr<StringArray const> Library::getPatchesInDirectory(File const& directory)
+{
+    auto const directoryHash = hash(directory.getFullPathName());
+
+    ScopedLock lock(patchDirectoryCacheLock);
+    if (auto const cached = patchDirectoryCache.find(directoryHash); cached != patchDirectoryCache.end())
+        return cached->second;
+
+    StringArray patches;
+    for (auto const& file : OSUtils::iterateDirectory(directory, false, true)) {
+        auto filename = file.getFileNameWithoutExtension();
+        if ((file.hasFileExtension("pd") || file.hasFileExtension("pd_lua")) && !filename.startsWith("help-") && !filename.endsWith("-help")) {
+            patches.add(filename);
+        }
+    }
+    patches.sort(false);
+
+    if (watchedPatchDirectories.insert(directoryHash).second)
+        patchDirectoryWatcher.addFolder(directory, false);
+
+    auto result = std::make_shared<StringArray const>(std::move(patches));
+    patchDirectoryCache[directoryHash] = result;
+    return result;
+}
+
+std::span<String const> Library::findPrefixMatches(StringArray const& sortedNames, String const& prefix)
+{
+    auto const* first = std::lower_bound(sortedNames.begin(), sortedNames.end(), prefix, [](String const& name, String const& query) {
+        return name.compare(query) < 0;
+    });
+
+    auto const* last = first;
+    while (last != sortedNames.end() && last->startsWith(prefix))
+        ++last;
+
+    return { first, last };
+}
+
+// FNV-1a over the UTF-8 bytes, like parse_documentation.py. Unlike hash(), this doesn't depend on whether char is signed
+static hash32 hashDocumentationName(char const* name)
+{
+    hash32 result = EMPTY_HASH;
+    for (auto const* byte = reinterpret_cast<uint8 const*>(name); *byte; byte++) {
+        result ^= *byte;
+        result *= 0x01000193;
+    }
+    return result;
+}
+
+Library::Documentation::Documentation()
+    : Thread("Documentation Index Thread")
+{
+    if (!openIndex()) {
+        jassertfalse; // The documentation index is missing or doesn't match this version of plugdata
+        data = nullptr;
+        dataSize = 0;
+        header = {};
+    }
+
+    tables.resize(header[NumObjects]);
+
+#if ENABLE_GEM
+    for (uint32 i = 0; i < header[NumObjects]; i++) {
+        if (std::strcmp(getString(readField(ObjectsOffset, ObjectSize, i, Origin)), "Gem") == 0)
+            gemObjects.insert(hash(getString(readField(ObjectsOffset, ObjectSize, i, Title))));
+    }
+#endif
+
+    startThread();
+}
+
+Library::Documentation::~Documentation()
+{
+    stopThread(-1);
+}
+
+bool Library::Documentation::openIndex()
+{
+    auto const resourceFile = BinaryData::getResourceFile();
+    auto const& resource = BinaryData::resources[BinaryData::DocumentationIndex_bin];
+    auto const range = Range<int64>(resource.offset, static_cast<int64>(resource.offset) + resource.size);
+
+    mappedIndex = std::make_unique<MemoryMappedFile>(resourceFile, range, MemoryMappedFile::readOnly);
+    if (mappedIndex->getData() && mappedIndex->getRange().contains(range)) {
+        // The mapped range starts at a page boundary
+        data = static_cast<uint8 const*>(mappedIndex->getData()) + (range.getStart() - mappedIndex->getRange().getStart());
+    } else {
+        mappedIndex.reset();
+        loadedIndex = BinaryData::getResource(BinaryData::DocumentationIndex_bin);
+        data = reinterpret_cast<uint8 const*>(loadedIndex.data());
+    }
+    dataSize = resource.size;
+
+    if (dataSize < HeaderSize * sizeof(uint32))
+        return false;
+
+    for (int i = 0; i < HeaderSize; i++) {
+        header[i] = readInt(i * sizeof(uint32));
+    }
+
+    if (header[Magic] != indexMagic || header[Version] != indexVersion)
+        return false;
+
+    auto const capacity = header[NameIndexCapacity];
+    auto fits = [this](uint64 const offset, uint64 const size) {
+        return offset + size <= dataSize;
     };
 
-    table.title = objectEntry.getProperty("name");
-    table.description = objectEntry.getProperty("description");
+    return fits(header[ObjectsOffset], static_cast<uint64>(header[NumObjects]) * ObjectSize * sizeof(uint32))
+        && fits(header[NameIndexOffset], static_cast<uint64>(capacity) * 2 * sizeof(uint32))
+        && fits(header[StringsOffset], header[StringsSize])
+        && isPowerOfTwo(capacity) && header[StringsSize] > 0
+        && data[header[StringsOffset] + header[StringsSize] - 1] == 0;
+}
+
+uint32 Library::Documentation::readInt(size_t const offset) const
+{
+    if (offset + sizeof(uint32) > dataSize)
+        return 0;
+
+    return ByteOrder::littleEndianInt(data + offset);
+}
+
+uint32 Library::Documentation::readField(uint32 const section, uint32 const recordSize, uint32 const record, uint32 const field) const
+{
+    return readInt(header[section] + (static_cast<size_t>(record) * recordSize + field) * sizeof(uint32));
+}
+
+char const* Library::Documentation::getString(uint32 const offset) const
+{
+    if (offset >= header[StringsSize])
+        return "";
+
+    return reinterpret_cast<char const*>(data + header[StringsOffset] + offset);
+}
+
+HeapArray<Library::ObjectReferenceTable::ReferenceItem> Library::Documentation::decodeItems(uint32 const first, uint32 const count) const
+{
+    HeapArray<ObjectReferenceTable::ReferenceItem> items;
+    items.reserve(count);
+    for (uint32 i = first; i < first + count; i++) {
+        items.add({ String::fromUTF8(getString(readField(ItemsOffset, 2, i, 0))), String::fromUTF8(getString(readField(ItemsOffset, 2, i, 1))) });
+    }
+    return items;
+}
 
-    auto parseIolet = [&](ValueTree const& node) -> ObjectReferenceTable::IoletReference {
+Library::ObjectReferenceTable::IoletsReference Library::Documentation::decodeIolets(uint32 const first, uint32 const count) const
+{
+    ObjectReferenceTable::IoletsReference iolets;
+    iolets.reserve(count);
+    for (uint32 i = first; i < first + count; i++) {
         ObjectReferenceTable::IoletReference iolet;
-        iolet.tooltip = node.getProperty("tooltip").toString();
-        iolet.repeating = static_cast<bool>(node.getProperty("variable"));
+        iolet.tooltip = String::fromUTF8(getString(readField(IoletsOffset, 4, i, 0)));
+        iolet.repeating = readField(IoletsOffset, 4, i, 1) != 0;
+        iolet.messages = decodeItems(readField(IoletsOffset, 4, i, 2), readField(IoletsOffset, 4, i, 3));
+        iolets.add(iolet);
+    }
+    return iolets;
+}
 
-        for (int i = 0; i < node.getNumChildren(); ++i) {
-            auto msg = node.getChild(i);
-            if (msg.getType() == Identifier("message"))
-                iolet.messages.add(parseReferenceItem(msg));
-        }
-        return iolet;
+std::unique_ptr<Library::ObjectReferenceTable> Library::Documentation::decodeTable(uint32 const object) const
+{
+    auto field = [this, object](ObjectField const f) {
+        return readField(ObjectsOffset, ObjectSize, object, f);
     };
 
-    for (int i = 0; i < objectEntry.getNumChildren(); ++i) {
-        auto section = objectEntry.getChild(i);
-        auto sectionType = section.getType();
-
-        if (sectionType == Identifier("iolets")) {
-            for (int j = 0; j < section.getNumChildren(); ++j) {
-                auto iolet = section.getChild(j);
-                auto ioletType = iolet.getType();
+    auto table = std::make_unique<ObjectReferenceTable>();
+    table->title = String::fromUTF8(getString(field(Title)));
+    table->description = String::fromUTF8(getString(field(Description)));
+    table->origin = String::fromUTF8(getString(field(Origin)));
 
-                if (ioletType == Identifier("inlet"))
-                    table.inlets.add(parseIolet(iolet));
-                else if (ioletType == Identifier("outlet"))
-                    table.outlets.add(parseIolet(iolet));
-            }
-        } else if (sectionType == Identifier("categories")) {
-            for (int j = 0; j < section.getNumChildren(); ++j) {
-                auto category = section.getChild(j);
-                table.categories.add(category.getProperty("name").toString());
-            }
-        } else if (sectionType == Identifier("arguments")) {
-            for (int j = 0; j < section.getNumChildren(); ++j)
-                table.arguments.add(parseReferenceItem(section.getChild(j)));
-        } else if (sectionType == Identifier("methods")) {
-            for (int j = 0; j < section.getNumChildren(); ++j)
-                table.methods.add(parseReferenceItem(section.getChild(j)));
-        } else if (sectionType == Identifier("flags")) {
-            for (int j = 0; j < section.getNumChildren(); ++j) {
-                auto flag = section.getChild(j);
-                table.flags.add({ flag.getProperty("name").toString(),
-                    flag.getProperty("description").toString() });
-            }
-        }
+    for (uint32 i = field(FirstCategory); i < field(FirstCategory) + field(NumCategories); i++) {
+        table->categories.add(String::fromUTF8(getString(readField(CategoriesOffset, 1, i, 0))));
     }
 
+    table->inlets = decodeIolets(field(FirstInlet), field(NumInlets));
+    table->outlets = decodeIolets(field(FirstOutlet), field(NumOutlets));
+    table->arguments = decodeItems(field(FirstArgument), field(NumArguments));
+    table->methods = decodeItems(field(FirstMethod), field(NumMethods));
+    table->flags = decodeItems(field(FirstFlag), field(NumFlags));
     return table;
 }
 
-void Library::run()
+Library::ObjectReferenceTable const* Library::Documentation::find(String const& name)
 {
-    HeapArray<uint8_t> decodedDocs;
-    decodedDocs.reserve(2 * 1024 * 1024);
-    {
-        auto documentation = BinaryData::getResource(BinaryData::Documentation_bin);
-        Decompress::extractXz((uint8_t*)documentation.data(), documentation.size(), decodedDocs);
-    }
-
-    MemoryInputStream stream(decodedDocs.data(), decodedDocs.size(), false);
-
-    while (!stream.isExhausted()) {
-        ObjectReferenceTable table;
-        table.title = stream.readString();
-        table.description = stream.readString();
-        table.origin = stream.readString();
-        int numCategories = stream.readInt();
-        for (int i = 0; i < numCategories; ++i)
-            table.categories.add(stream.readString());
-
-        for (auto* iolets : { &table.inlets, &table.outlets }) {
-            int count = stream.readInt();
-            for (int i = 0; i < count; ++i) {
-                ObjectReferenceTable::IoletReference iolet;
-                iolet.repeating = stream.readBool();
-                int count = stream.readInt();
-                for (int i = 0; i < count; ++i)
-                    iolet.messages.add({ stream.readString(), stream.readString() });
-                iolet.tooltip = stream.readString();
-                iolets->add(iolet);
-            }
-        }
-        for (auto* items : { &table.arguments, &table.methods, &table.flags }) {
-            int count = stream.readInt();
-            for (int i = 0; i < count; ++i)
-                items->add({ stream.readString(), stream.readString() });
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    auto const capacity = header[NameIndexCapacity];
+    if (capacity == 0)
+        return nullptr;
+
+    auto const nameHash = hashDocumentationName(name.toRawUTF8());
+    for (auto slot = nameHash & (capacity - 1);; slot = (slot + 1) & (capacity - 1)) {
+        auto const object = readField(NameIndexOffset, 2, slot, 1);
+        if (object == 0 || object > header[NumObjects])
+            return nullptr;
+
+        if (readField(NameIndexOffset, 2, slot, 0) != nameHash)
+            continue;
+
+#if !ENABLE_GEM
+        if (std::strcmp(getString(readField(ObjectsOffset, ObjectSize, object - 1, Origin)), "Gem") == 0)
+            return nullptr;
+#endif
+
+        auto& table = tables[object - 1];
+        if (!table)
+            table = decodeTable(object - 1);
+
+        return table.get();
+    }
+}
+
+StringArray Library::Documentation::search(String const& query, bool const waitForIndex)
+{
+    if (!searchIndexBuilt.wait(waitForIndex ? -1 : 0))
+        return {};
+
+    StringArray result;
+    for (auto const& match : searchDatabase.search(query.toStdString())) {
+        result.add(String::fromUTF8(getString(readField(ObjectsOffset, ObjectSize, match.key, Title))));
+    }
+    return result;
+}
+
+bool Library::Documentation::isGemObject(String const& name) const
+{
+    return gemObjects.contains(hash(name));
+}
+
+size_t Library::Documentation::getMemoryUsage() const
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    auto stringSize = [](String const& str) {
+        return sizeof(String) + str.getNumBytesAsUTF8() + 1;
+    };
+    auto itemsSize = [&](HeapArray<ObjectReferenceTable::ReferenceItem> const& items) {
+        size_t size = 0;
+        for (auto const& item : items)
+            size += stringSize(item.type) + stringSize(item.description);
+        return size;
+    };
+
+    size_t size = dataSize + tables.size() * sizeof(std::unique_ptr<ObjectReferenceTable>);
+    for (auto const& table : tables) {
+        if (!table)
+            continue;
+
+        size += sizeof(ObjectReferenceTable) + stringSize(table->title) + stringSize(table->description) + stringSize(table->origin);
+        for (auto const& category : table->categories)
+            size += stringSize(category);
+        for (auto const* iolets : { &table->inlets, &table->outlets }) {
+            for (auto const& iolet : *iolets)
+                size += sizeof(ObjectReferenceTable::IoletReference) + stringSize(iolet.tooltip) + itemsSize(iolet.messages);
         }
-        documentation.add(table);
+        size += itemsSize(table->arguments) + itemsSize(table->methods) + itemsSize(table->flags);
     }
 
+    return size;
+}
+
+void Library::Documentation::run()
+{
     auto weights = HeapArray<float>(2);
     weights[0] = 6.0f; // More weight for name
     weights[1] = 3.0f; // More weight for description
     searchDatabase.setWeights(weights.vector());
 
-    for (auto& doc : documentation) {
-        HeapArray<std::string> fields;
-        fields.add(doc.title.toStdString());
-        fields.add(doc.description.toStdString());
-        for (auto& str : doc.categories)
-            fields.add(str.toStdString());
-        for (auto& str : doc.inlets)
-            fields.add(str.tooltip.toStdString());
-        for (auto& str : doc.outlets)
-            fields.add(str.tooltip.toStdString());
-        for (auto& str : doc.arguments)
-            fields.add(str.description.toStdString());
-        for (auto& str : doc.flags)
-            fields.add(str.description.toStdString());
-        for (auto& str : doc.methods)
-            fields.add(str.description.toStdString());
-
-        if (doc.origin == "Gem") {
+    auto addItemDescriptions = [this](HeapArray<std::string>& fields, uint32 const first, uint32 const count) {
+        for (uint32 i = first; i < first + count; i++)
+            fields.add(getString(readField(ItemsOffset, 2, i, 1)));
+    };
+    auto addIoletTooltips = [this](HeapArray<std::string>& fields, uint32 const first, uint32 const count) {
+        for (uint32 i = first; i < first + count; i++)
+            fields.add(getString(readField(IoletsOffset, 4, i, 0)));
+    };
+
+    HeapArray<std::string> fields;
+    for (uint32 object = 0; object < header[NumObjects] && !threadShouldExit(); object++) {
+        auto field = [this, object](ObjectField const f) {
+            return readField(ObjectsOffset, ObjectSize, object, f);
+        };
+
 #if !ENABLE_GEM
+        if (std::strcmp(getString(field(Origin)), "Gem") == 0)
             continue;
-#else
-            gemObjects.add(doc.title);
 #endif
+
+        fields.clear();
+        fields.add(getString(field(Title)));
+        fields.add(getString(field(Description)));
+        for (uint32 i = field(FirstCategory); i < field(FirstCategory) + field(NumCategories); i++)
+            fields.add(getString(readField(CategoriesOffset, 1, i, 0)));
+        addIoletTooltips(fields, field(FirstInlet), field(NumInlets));
+        addIoletTooltips(fields, field(FirstOutlet), field(NumOutlets));
+        addItemDescriptions(fields, field(FirstArgument), field(NumArguments));
+        addItemDescriptions(fields, field(FirstFlag), field(NumFlags));
+        addItemDescriptions(fields, field(FirstMethod), field(NumMethods));
+
+        searchDatabase.addEntry(object, fields.vector());
+    }
+    searchDatabase.setThreshold(0.4f);
+
+    searchIndexBuilt.signal();
+}
+
+Library::Documentation& Library::getDocumentation()
+{
+    return *documentation;
+}
+
+void Library::run()
+{
+    updateHelpfileIndex();
+
+    // Keep the indices up to date whenever updateLibrary() takes a new snapshot
+    while (!threadShouldExit()) {
+        wait(-1);
+
+        if (threadShouldExit())
+            break;
+
+        updateObjectIndex();
+        updateHelpfileIndex();
+    }
+}
+
+// Normalises a helpfile path so it can be matched against names like "else/knob-help.pd"
+static String getHelpfileSearchPath(File const& file)
+{
+    auto pathName = file.getFullPathName().replace("\\", "/").trimCharactersAtEnd("/");
+    // Hack to make it find else/cyclone/Gem helpfiles...
+    pathName = pathName.replace("/9.else", "/else");
+    pathName = pathName.replace("/10.cyclone", "/cyclone");
+    pathName = pathName.replace("/14.gem", "/Gem");
+    return pathName;
+}
+
+// Rescans the help directories that changed since the last update, and publishes a new index if anything changed
+void Library::updateHelpfileIndex()
+{
+    ScopedLock lock(helpDirectoriesLock);
+
+    bool changed = false;
+    for (int i = 0; i < helpPaths.size(); i++) {
+        auto& directory = helpDirectories[i];
+        auto const lastModified = helpPaths[i].isDirectory() ? helpPaths[i].getLastModificationTime() : Time();
+        if (directory.scanned && directory.lastModified == lastModified)
+            continue;
+
+        directory.scanned = true;
+        directory.lastModified = lastModified;
+        directory.files.clear();
+        if (helpPaths[i].isDirectory()) {
+            for (auto const& file : OSUtils::iterateDirectory(helpPaths[i], false, true)) {
+                directory.files.add({ file, getHelpfileSearchPath(file) });
+            }
         }
+        changed = true;
+    }
 
-        searchDatabase.addEntry(&doc, fields.vector());
-        searchDatabase.setThreshold(0.4f);
-
-        if (doc.origin.isEmpty()) {
-            documentationIndex[hash(doc.title)] = &doc;
-        } else if (doc.origin == "Gem") {
-            documentationIndex[hash(doc.origin + "/" + doc.title)] = &doc;
-        } else if (doc.origin == "MERDA") {
-            documentationIndex[hash("ELSE/" + doc.title)] = &doc;
-        } else if (documentationIndex.count(hash(doc.title))) {
-            documentationIndex[hash(doc.origin + "/" + doc.title)] = &doc;
-        } else {
-            documentationIndex[hash(doc.title)] = &doc;
-            documentationIndex[hash(doc.origin + "/" + doc.title)] = &doc;
+    if (!changed)
+        return;
+
+    auto index = std::make_shared<HelpfileIndex>();
+    for (auto const& directory : helpDirectories) {
+        for (auto const& entry : directory.files) {
+            auto const entryIndex = static_cast<int>(index->entries.size());
+            index->entries.add(entry);
+
+            // Index the file name, and the file name with its parent directories, earlier help paths take precedence
+            auto path = entry.searchPath;
+            for (int depth = 0; depth < HelpfileIndex::maxDepth; depth++) {
+                auto const separator = path.lastIndexOfChar('/');
+                if (separator < 0)
+                    break;
+
+                index->files.try_emplace(hash(entry.searchPath.substring(separator + 1)), entryIndex);
+                path = path.substring(0, separator);
+            }
         }
     }
 
-    initWait.signal();
+    // Swap, so the old index gets freed after releasing the lock
+    std::shared_ptr<HelpfileIndex const> newIndex = std::move(index);
+    {
+        SpinLock::ScopedLockType lock(helpfileIndexLock);
+        std::swap(helpfileIndex, newIndex);
+    }
 }
 
-void Library::ensureDatabaseInitialised() const
+std::optional<File> Library::HelpfileIndex::find(String const& firstName, String const& secondName) const
 {
-    static bool isInitialised = false;
-    if (!isInitialised) {
-        initWait.wait();
-        isInitialised = true;
+    // Names with more directories than we index need a full search
+    if (firstName.removeCharacters("/").length() + maxDepth <= firstName.length())
+        return std::nullopt;
+
+    int bestMatch = -1;
+    for (auto const& name : { firstName, secondName }) {
+        auto const it = files.find(hash(name));
+        if (it != files.end() && entries[it->second].searchPath.endsWith("/" + name) && (bestMatch < 0 || it->second < bestMatch))
+            bestMatch = it->second;
     }
+
+    if (bestMatch < 0)
+        return File();
+
+    return entries[bestMatch].file;
 }
 
-bool Library::isGemObject(String const& query) const
+std::shared_ptr<Library::HelpfileIndex const> Library::getHelpfileIndex()
 {
-    ensureDatabaseInitialised();
+    SpinLock::ScopedLockType lock(helpfileIndexLock);
+    return helpfileIndex;
+}
 
-    return gemObjects.contains(query);
+bool Library::isGemObject(String const& query) const
+{
+    return documentation->isGemObject(query);
 }
 
-StringArray Library::autocomplete(String const& query, File const& patchDirectory) const
+StringArray Library::autocomplete(String const& query, File const& patchDirectory)
 {
-    ensureDatabaseInitialised();
+    auto& docs = getDocumentation();
 
     StringArray result;
     result.ensureStorageAllocated(20);
 
-    // First, look for non-help patches in the current patch directory
-    if (patchDirectory.isDirectory()) {
-        for (auto const& file : OSUtils::iterateDirectory(patchDirectory, false, true, 20)) {
-            auto filename = file.getFileNameWithoutExtension();
-            if ((file.hasFileExtension("pd") || file.hasFileExtension("pd_lua")) && filename.startsWith(query) && !filename.startsWith("help-") && !filename.endsWith("-help")) {
-                result.add(filename);
-            }
+    auto addMatches = [&result, &query](StringArray const& names) {
+        for (auto const& name : findPrefixMatches(names, query)) {
+            if (result.size() >= 20)
+                break;
+
+            result.addIfNotAlreadyThere(name);
         }
+    };
+
+    // First, look for non-help patches in the current patch directory
+    if (patchDirectory.getFullPathName().isNotEmpty()) {
+        addMatches(*getPatchesInDirectory(patchDirectory));
     }
 
     // Then, go over all regular objects for direct autocompletion
-    for (auto const& str : allObjects) {
-        if (result.size() >= 20)
-            break;
-
-        if (str.startsWith(query)) {
-            result.addIfNotAlreadyThere(str);
-        }
-    }
+    addMatches(*getObjectList());
 
     result.sort(true);
 
     // Finally, do a fuzzy search of all object documentation
-    auto const fuzzyResults = searchDatabase.search(query.toStdString());
-    for (auto& fuzzyMatch : fuzzyResults) {
+    // Don't wait for the search index here, autocompletion should never block
+    for (auto const& name : docs.search(query, false)) {
         if (result.size() >= 20)
             break;
 
-        auto const& name = fuzzyMatch.key->title;
         if (name.isNotEmpty()) {
             result.addIfNotAlreadyThere(name);
         }
@@ -336,24 +637,26 @@ StringArray Library::autocomplete(String const& query, File const& patchDirector
 
 StringArray Library::searchObjectDocumentation(String const& query)
 {
-    ensureDatabaseInitialised();
+    auto& docs = getDocumentation();
 
     StringArray result;
     result.ensureStorageAllocated(20);
 
-    for (auto const& str : allObjects) {
-        if (str.startsWith(query)) {
-            result.addIfNotAlreadyThere(str);
-        }
+    // The object list has no duplicates, so we only need to keep track of what we've added for the fuzzy results
+    UnorderedSet<hash32> added;
+
+    auto const objects = getObjectList();
+    for (auto const& str : findPrefixMatches(*objects, query)) {
+        result.add(str);
+        added.insert(hash(str));
     }
 
-    auto const fuzzyResults = searchDatabase.search(query.toStdString());
+    auto const fuzzyResults = docs.search(query, true);
     result.ensureStorageAllocated(result.size() + fuzzyResults.size());
 
-    for (auto& fuzzyMatch : fuzzyResults) {
-        auto const& name = fuzzyMatch.key->title;
-        if (name.isNotEmpty()) {
-            result.addIfNotAlreadyThere(name);
+    for (auto const& name : fuzzyResults) {
+        if (name.isNotEmpty() && added.insert(hash(name)).second) {
+            result.add(name);
         }
     }
 
@@ -362,15 +665,12 @@ StringArray Library::searchObjectDocumentation(String const& query)
 
 Library::ObjectReferenceTable const& Library::getObjectInfo(String const& name)
 {
-    ensureDatabaseInitialised();
-
     static Library::ObjectReferenceTable emptyObject = { };
 
-    auto hashName = hash(name);
-    if (!documentationIndex.contains(hashName))
-        return emptyObject;
+    if (auto const* table = getDocumentation().find(name))
+        return *table;
 
-    return *documentationIndex[hashName];
+    return emptyObject;
 }
 
 StackArray<StringArray, 2> Library::parseIoletTooltips(ObjectReferenceTable::IoletsReference const& inlets, ObjectReferenceTable::IoletsReference const& outlets, String const& name, int const numIn, int const numOut)
@@ -413,7 +713,27 @@ StackArray<StringArray, 2> Library::parseIoletTooltips(ObjectReferenceTable::Iol
 
 StringArray Library::getAllObjects()
 {
-    return allObjects;
+    return *getObjectList();
+}
+
+void Library::filesChanged(SmallArray<FileSystemWatcher::Change> const& changes)
+{
+    auto const settingsFile = ProjectInfo::appDataDir.getChildFile("settings.json");
+
+    bool objectsChanged = false;
+    {
+        ScopedLock lock(patchDirectoryCacheLock);
+        for (auto const& change : changes) {
+            patchDirectoryCache.erase(hash(change.file.getParentDirectory().getFullPathName()));
+            patchDirectoryCache.erase(hash(change.file.getFullPathName()));
+
+            // Changes in patch directories, or to our settings, don't affect the object list
+            objectsChanged = objectsChanged || (change.file.isAChildOf(ProjectInfo::appDataDir) && change.file != settingsFile);
+        }
+    }
+
+    if (objectsChanged)
+        triggerAsyncUpdate();
 }
 
 void Library::filesystemChanged()
@@ -464,22 +784,36 @@ String Library::getObjectOrigin(t_gobj* obj)
     return { };
 }
 
+// Looks up a helpfile in the helpfile index, or returns nothing if we need to search the help paths on disk
+static std::optional<File> findIndexedHelpfile(String const& firstName, String const& secondName)
+{
+    auto const index = Library::getHelpfileIndex();
+    if (!index)
+        return std::nullopt;
+
+    auto const file = index->find(firstName, secondName);
+
+    // The index might be a bit behind on changes in the help paths
+    if (file && *file != File() && !file->existsAsFile())
+        return std::nullopt;
+
+    return file;
+}
+
 File Library::findHelpfile(String const& helpName)
 {
     String const firstName = helpName + "-help.pd";
     String const secondName = "help-" + helpName + ".pd";
 
+    if (auto const file = findIndexedHelpfile(firstName, secondName))
+        return *file;
+
     for (auto& path : helpPaths) {
         if (!path.exists())
             continue;
 
         for (auto const& file : OSUtils::iterateDirectory(path, false, true)) {
-            auto pathName = file.getFullPathName().replace("\\", "/").trimCharactersAtEnd("/");
-            // Hack to make it find else/cyclone/Gem helpfiles...
-            pathName = pathName.replace("/9.else", "/else");
-            pathName = pathName.replace("/10.cyclone", "/cyclone");
-            pathName = pathName.replace("/14.gem", "/Gem");
-
+            auto const pathName = getHelpfileSearchPath(file);
             if (pathName.endsWith("/" + firstName) || pathName.endsWith("/" + secondName)) {
                 return file;
             }
@@ -531,21 +865,20 @@ File Library::findHelpfile(t_gobj* obj, File const& parentPatchFile)
         }
     }
 
-    for (auto path : helpPaths) {
-        patchHelpPaths.add(helpDir.isNotEmpty() ? path.getChildFile(helpDir) : path);
-    }
-
     String firstName = helpName + "-help.pd";
     String secondName = "help-" + helpName + ".pd";
 
+    // Without a help dir, the help paths are exactly what the helpfile index covers
+    auto const indexedHelpfile = helpDir.isEmpty() ? findIndexedHelpfile(firstName, secondName) : std::nullopt;
+    if (!indexedHelpfile) {
+        for (auto path : helpPaths) {
+            patchHelpPaths.add(helpDir.isNotEmpty() ? path.getChildFile(helpDir) : path);
+        }
+    }
+
     auto findHelpPatch = [&firstName, &secondName](File const& searchDir) -> File {
         for (auto const& file : OSUtils::iterateDirectory(searchDir, false, true)) {
-            auto pathName = file.getFullPathName().replace("\\", "/").trimCharactersAtEnd("/");
-            // Hack to make it find else/cyclone/Gem helpfiles...
-            pathName = pathName.replace("/9.else", "/else");
-            pathName = pathName.replace("/10.cyclone", "/cyclone");
-            pathName = pathName.replace("/14.gem", "/Gem");
-
+            auto const pathName = getHelpfileSearchPath(file);
             if (pathName.endsWith("/" + firstName) || pathName.endsWith("/" + secondName)) {
                 return file;
             }
@@ -563,6 +896,9 @@ File Library::findHelpfile(t_gobj* obj, File const& parentPatchFile)
         }
     }
 
+    if (indexedHelpfile && indexedHelpfile->existsAsFile())
+        return *indexedHelpfile;
+
     auto* rawHelpDir = class_gethelpdir(pd_class(&obj->g_pd));
     helpDir = String::fromUTF8(rawHelpDir);
 
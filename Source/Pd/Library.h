@@ -7,6 +7,8 @@
 #pragma once
 
 #include <m_pd.h>
+#include <span>
+#include <optional>
 #include "Utility/FileSystemWatcher.h"
 #include "Utility/Config.h"
 
@@ -42,19 +44,123 @@ public:
         HeapArray<ReferenceItem> flags;
     };
 
+    // Maps helpfile names to files in the help paths, so we don't need to search the disk every time we open help
+    struct HelpfileIndex {
+        struct Entry {
+            File file;
+            String searchPath;
+        };
+
+        // Deepest name we index, "Gem/pix_image-help.pd" has a depth of 2
+        static constexpr int maxDepth = 3;
+
+        // Returns an empty file if the helpfile doesn't exist, or nothing if the name is too deep to be indexed
+        std::optional<File> find(String const& firstName, String const& secondName) const;
+
+        HeapArray<Entry> entries;
+        UnorderedMap<hash32, int> files;
+    };
+
+    // Object documentation, shared by all plugdata instances in the process
+    // The documentation is a flat index generated at build time by parse_documentation.py, which we memory-map, so it's
+    // available right away. We only decode the tables of objects that are actually looked up. The fuzzy search index
+    // can't be stored in the file, so it's built on a background thread from the mapped strings
+    class Documentation final : public Thread {
+    public:
+        Documentation();
+        ~Documentation() override;
+
+        void run() override;
+
+        // Decodes the table on first lookup and caches it. The cache isn't locked, so this is only safe on
+        // the message thread, which all plugdata instances in the process share
+        ObjectReferenceTable const* find(String const& name);
+
+        // Titles of the objects that match the query. If the search index is still being built, this either waits
+        // for it, or returns nothing so that the caller can show the results it already has
+        StringArray search(String const& query, bool waitForIndex);
+
+        bool isGemObject(String const& name) const;
+
+        // The size of the index, plus a rough estimate of the tables we decoded from it. Message thread only, like find()
+        size_t getMemoryUsage() const;
+
+    private:
+        static constexpr uint32 indexMagic = 0x49444450; // "PDDI"
+        static constexpr uint32 indexVersion = 1;
+
+        // Field offsets in the index, these have to match parse_documentation.py
+        enum HeaderField {
+            Magic,
+            Version,
+            NumObjects,
+            ObjectsOffset,
+            ItemsOffset,
+            IoletsOffset,
+            CategoriesOffset,
+            NameIndexOffset,
+            StringsOffset,
+            NameIndexCapacity,
+            StringsSize,
+            HeaderSize = 12
+        };
+
+        enum ObjectField {
+            Title,
+            Description,
+            Origin,
+            FirstCategory,
+            NumCategories,
+            FirstInlet,
+            NumInlets,
+            FirstOutlet,
+            NumOutlets,
+            FirstArgument,
+            NumArguments,
+            FirstMethod,
+            NumMethods,
+            FirstFlag,
+            NumFlags,
+            ObjectSize
+        };
+
+        bool openIndex();
+        uint32 readInt(size_t offset) const;
+        uint32 readField(uint32 section, uint32 recordSize, uint32 record, uint32 field) const;
+        char const* getString(uint32 offset) const;
+
+        std::unique_ptr<ObjectReferenceTable> decodeTable(uint32 object) const;
+        HeapArray<ObjectReferenceTable::ReferenceItem> decodeItems(uint32 first, uint32 count) const;
+        ObjectReferenceTable::IoletsReference decodeIolets(uint32 first, uint32 count) const;
+
+        std::unique_ptr<MemoryMappedFile> mappedIndex;
+        std::vector<char> loadedIndex; // In case the resource file can't be mapped
+        uint8 const* data = nullptr;
+        size_t dataSize = 0;
+
+        StackArray<uint32, HeaderSize> header = {};
+        UnorderedSet<hash32> gemObjects;
+
+        // Decoded on first use, only accessed from the message thread
+        HeapArray<std::unique_ptr<ObjectReferenceTable>> tables;
+
+        fuzzysearch::Database<uint32> searchDatabase;
+        WaitableEvent searchIndexBuilt { true };
+    };
+
     explicit Library(pd::Instance* instance);
 
     ~Library() override;
 
     void run() override;
 
-    void ensureDatabaseInitialised() const;
+    Documentation& getDocumentation();
 
     void updateLibrary();
 
     bool isGemObject(String const& query) const;
 
-    StringArray autocomplete(String const& query, File const& patchDirectory) const;
+    StringArray autocomplete(String const& query, File const& patchDirectory);
     StringArray searchObjectDocumentation(String const& query);
 
     static File findPatch(String const& patchToFind);
@@ -62,9 +168,11 @@ public:
 
     static StackArray<StringArray, 2> parseIoletTooltips(ObjectReferenceTable::IoletsReference const& inlets, ObjectReferenceTable::IoletsReference const& outlets, String const& name, int numIn, int numOut);
 
+    void filesChanged(SmallArray<FileSystemWatcher::Change> const& changes) override;
     void filesystemChanged() override;
 
     static File findHelpfile(String const& name);
+    static std::shared_ptr<HelpfileIndex const> getHelpfileIndex();
     static File findHelpfile(t_gobj* obj, File const& parentPatchFile);
 
     Library::ObjectReferenceTable const& getObjectInfo(String const& name);
@@ -100,18 +208,57 @@ public:
     static inline StringArray objectOrigins = { "vanilla", "ELSE", "cyclone", "Gem", "heavylib", "pdlua", "MERDA" };
 
 private:
-    StringArray allObjects;
-    StringArray gemObjects;
+    struct DirectoryIndex {
+        Time lastModified;
+        StringArray patches;
+    };
+
+    void updateObjectIndex();
+    void updateHelpfileIndex();
+    std::shared_ptr<StringArray const> getObjectList() const;
+    std::shared_ptr<StringArray const> getPatchesInDirectory(File const& directory);
+
+    // All names in a sorted list that start with prefix
+    static std::span<String const> findPrefixMatches(StringArray const& sortedNames, String const& prefix);
+
+    // Snapshot of pd_objectmaker, taken on the message thread and picked up by the library thread
+    StringArray pdObjects;
+    CriticalSection pdObjectsLock;
+
+    // Patches per search path, only used on the library thread
+    UnorderedMap<hash32, DirectoryIndex> directoryIndex;
+
+    // Sorted and without duplicates. Replaced as a whole whenever the index changes, so readers never see a half-built list
+    std::shared_ptr<StringArray const> allObjects;
+    SpinLock mutable allObjectsLock;
+
+    // Sorted non-help patches per directory, for autocompleting abstractions next to the current patch
+    // Entries are dropped when the watcher tells us something in that directory changed
+    UnorderedMap<hash32, std::shared_ptr<StringArray const>> patchDirectoryCache;
+    UnorderedSet<hash32> watchedPatchDirectories;
+    CriticalSection patchDirectoryCacheLock;
+    FileSystemWatcher patchDirectoryWatcher;
+
+    struct HelpDirectory {
+        Time lastModified;
+        HeapArray<HelpfileIndex::Entry> files;
+        bool scanned = false;
+    };
+
+    // Contents of each help path. Like the index, these are the same for all instances, so only one of them needs to scan
+    static inline StackArray<HelpDirectory, 9> helpDirectories;
+    static inline CriticalSection helpDirectoriesLock;
+
+    // Shared between all instances, since the help paths are the same for all of them
+    static inline std::shared_ptr<HelpfileIndex const> helpfileIndex;
+    static inline SpinLock helpfileIndexLock;
+
+    SharedResourcePointer<Documentation> documentation;
 
     FileSystemWatcher watcher;
-    WaitableEvent initWait;
     pd::Instance* pd;
 
-    ObjectReferenceTable parseObjectEntry(ValueTree const& objectEntry);
-
-    HeapArray<ObjectReferenceTable> documentation;
-    fuzzysearch::Database<ObjectReferenceTable*> searchDatabase;
-    UnorderedMap<hash32, ObjectReferenceTable*> documentationIndex;
+    JUCE_DECLARE_WEAK_REFERENCEABLE(Library)
 };
 
 } // namespace pd
@@ -7,13 +7,14 @@
 
 #include "Instance.h"
 #include <readerwriterqueue.h>
+#include <span>
 
 namespace pd {
 
 class MessageListener {
 public:
     virtual ~MessageListener() = default;
-    virtual void receiveMessage(t_symbol* symbol, SmallArray<pd::Atom> const& atoms) = 0;
+    virtual void receiveMessage(t_symbol* symbol, std::span<pd::Atom const> atoms) = 0;
 
     void* object;
     JUCE_DECLARE_WEAK_REFERENCEABLE(MessageListener)
@@ -40,6 +41,16 @@ class MessageVector {
         overflowBlocks[blockIndex][blockOffset] = value;
     }
 
+    void push(T const& value)
+    {
+        if (size < Capacity) {
+            buffer[size] = value;
+        } else {
+            addOverflow(value);
+        }
+        ++size;
+    }
+
 public:
     // Constructor
     MessageVector() { }
@@ -49,30 +60,20 @@ public:
         return size == 0;
     }
 
-    void append(int noOverflow, T const&& header, T const* values, int numValues)
+    // Appends the values, followed by the size and header entries that describe them
+    void append(int noOverflow, T const* values, int numValues, T const& sizeEntry, T const& header)
     {
-        if (EXPECT_LIKELY(size + numValues + 1 < Capacity)) {
+        if (EXPECT_LIKELY(size + numValues + 2 < Capacity)) {
             std::copy(values, values + numValues, buffer + size);
-            buffer[size + numValues] = header;
-            size += (numValues + 1);
-        } else if(!noOverflow) {
-            auto const spaceLeft = Capacity > size ? std::min<int>(Capacity - size, numValues) : 0;
-            int const numOverflow = numValues - spaceLeft;
-            for (int i = 0; i < spaceLeft; i++) {
-                buffer[size + i] = values[i];
-            }
-            size += spaceLeft;
-            for (int i = 0; i < numOverflow; i++) {
-                addOverflow(values[spaceLeft + i]);
-                ++size;
+            buffer[size + numValues] = sizeEntry;
+            buffer[size + numValues + 1] = header;
+            size += (numValues + 2);
+        } else if (!noOverflow) {
+            for (int i = 0; i < numValues; i++) {
+                push(values[i]);
             }
-
-            if (size < Capacity) {
-                buffer[size] = header;
-            } else {
-                addOverflow(header);
-            }
-            ++size;
+            push(sizeEntry);
+            push(header);
         }
     }
 
@@ -112,24 +113,33 @@ public:
 class MessageDispatcher final : public AsyncUpdater {
 
     // Represents a single Pd message.
-    // Holds target object, and symbol+size compressed into a single value
-    // Atoms are stored in a separate buffer, and read out based on reported size
+    // A message is written as its atoms, followed by a size entry, followed by a header with the target and symbol
+    // The size gets its own entry, so there is no limit to the number of atoms we can pass along
 
-    struct MessageTargetSizeSymbol {
-        PointerIntPair<void*, 2, uint8_t> targetAndSize;
-        PointerIntPair<t_symbol*, 2, uint8_t> symbolAndSize;
+    struct MessageTargetSymbol {
+        void* target;
+        t_symbol* symbol;
     };
 
     struct Message {
         Message() { }
 
-        // Both are 16 bytes, so we can squish them together into a single queue
+        // All are at most 16 bytes, so we can squish them together into a single queue
         union {
-            MessageTargetSizeSymbol header;
+            MessageTargetSymbol header;
+            size_t size;
             t_atom atom;
         };
     };
 
+    // Message that was taken out of the queue, with its atoms stored in atomScratch
+    struct DequeuedMessage {
+        void* target;
+        t_symbol* symbol;
+        size_t atomOffset;
+        size_t size;
+    };
+
     using MessageBuffer = MessageVector<Message>;
 
 public:
@@ -137,6 +147,8 @@ public:
     {
         usedHashes.reserve(128);
         nullListeners.reserve(128);
+        messageScratch.reserve(1024);
+        atomScratch.reserve(4096);
     }
 
     static void enqueueMessage(void* instance, int type, void* target, t_symbol* symbol, int const argc, t_atom* argv) noexcept
@@ -144,13 +156,15 @@ public:
         auto const* pd = static_cast<pd::Instance*>(instance);
         auto* dispatcher = pd->messageDispatcher.get();
         if (EXPECT_LIKELY(!dispatcher->block)) {
-            auto const size = argc > 15 ? 15 : argc;
-
             auto& backBuffer = dispatcher->getBackBuffer();
-            Message message;
-            message.header = { PointerIntPair<void*, 2, uint8_t>(target, (size & 0b1100) >> 2), PointerIntPair<t_symbol*, 2, uint8_t>(symbol, size & 0b11) };
 
-            backBuffer.append(type, std::move(message), reinterpret_cast<Message*>(argv), size);
+            Message size;
+            size.size = static_cast<size_t>(argc);
+
+            Message header;
+            header.header = { target, symbol };
+
+            backBuffer.append(type, reinterpret_cast<Message*>(argv), argc, size, header);
         }
     }
 
@@ -201,58 +215,58 @@ public:
 
     void dequeueMessages() // Note: make sure correct pd instance is active when calling this
     {
+        // A listener could flush the queue again, but we're still handing out views into our scratch buffers
+        if (isDequeueing)
+            return;
+
+        isDequeueing = true;
+
         auto& frontBuffer = getFrontBuffer();
 
         usedHashes.clear();
         nullListeners.clear();
-
-        SmallArray<Message> allMessages;
-        SmallArray<pd::Atom> allAtoms;
-
-        // Eliminate duplicate messages
-        Message message;
-        while (popMessage(frontBuffer, message)) {
-            auto hash = reinterpret_cast<intptr_t>(message.header.targetAndSize.getOpaqueValue()) ^ reinterpret_cast<intptr_t>(message.header.symbolAndSize.getOpaqueValue());
-            auto size = message.header.targetAndSize.getInt() << 2 | message.header.symbolAndSize.getInt();
+        messageScratch.clear();
+        atomScratch.clear();
+
+        // Eliminate duplicate messages, the buffer is read from newest to oldest
+        Message header, size;
+        while (popMessage(frontBuffer, header) && popMessage(frontBuffer, size)) {
+            auto const numAtoms = size.size;
+            auto hash = reinterpret_cast<intptr_t>(header.header.target) ^ reinterpret_cast<intptr_t>(header.header.symbol);
             if (EXPECT_UNLIKELY(usedHashes.contains(hash))) {
-                frontBuffer.pop(size);
+                frontBuffer.pop(static_cast<int>(numAtoms));
                 continue;
             }
-            for (int at = 0; at < size; at++) {
-                allAtoms.emplace_back(&frontBuffer.back().atom);
+
+            // Atoms come out last-to-first, so fill them in backwards to keep each message contiguous and in order
+            auto const atomOffset = atomScratch.size();
+            atomScratch.resize(atomOffset + numAtoms);
+            for (size_t at = numAtoms; at > 0; at--) {
+                atomScratch[atomOffset + at - 1] = pd::Atom(&frontBuffer.back().atom);
                 frontBuffer.pop();
             }
+
             usedHashes.insert(hash);
-            allMessages.add(message);
+            messageScratch.add({ header.header.target, header.header.symbol, atomOffset, numAtoms });
         }
 
-        int atomPosition = allAtoms.size();
-
         // Replay messages in original order
-        for (int i = allMessages.size() - 1; i >= 0; i--) {
-            auto& message = allMessages[i];
-            auto targetPtr = message.header.targetAndSize.getPointer();
-            auto target = messageListeners.find(targetPtr);
-            auto [symbol, size] = message.header.symbolAndSize;
-            size = message.header.targetAndSize.getInt() << 2 | size;
+        for (int i = messageScratch.size() - 1; i >= 0; i--) {
+            auto const& message = messageScratch[i];
+            auto target = messageListeners.find(message.target);
 
             if (EXPECT_LIKELY(target == messageListeners.end())) {
-                atomPosition -= size;
                 continue;
             }
 
-            SmallArray<pd::Atom> atoms = {
-                std::make_reverse_iterator(allAtoms.begin() + atomPosition),
-                std::make_reverse_iterator(allAtoms.begin() + atomPosition - size)
-            };
+            auto const atoms = std::span<pd::Atom const>(atomScratch.data() + message.atomOffset, message.size);
 
             for (auto it = target->second.begin(); it < target->second.end(); ++it) {
                 if (auto* listener = it->get())
-                    listener->receiveMessage(symbol, atoms);
+                    listener->receiveMessage(message.symbol, atoms);
                 else
-                    nullListeners.add({ targetPtr, it });
+                    nullListeners.add({ message.target, it });
             }
-            atomPosition -= size;
         }
 
         nullListeners.erase(
@@ -267,6 +281,8 @@ public:
         frontBuffer.clear();
 
         currentBuffer.store((currentBuffer.load() + 1) % 3);
+
+        isDequeueing = false;
     }
 
     void handleAsyncUpdate() override
@@ -289,6 +305,11 @@ private:
     StackArray<MessageBuffer, 3> buffers;
     AtomicValue<int, Sequential> currentBuffer;
 
+    // Reused between flushes, so dequeueing doesn't allocate once these have grown large enough
+    SmallArray<DequeuedMessage> messageScratch;
+    HeapArray<pd::Atom> atomScratch;
+    bool isDequeueing = false;
+
     SmallArray<std::pair<void*, UnorderedSet<juce::WeakReference<pd::MessageListener>>::iterator>, 16> nullListeners;
     UnorderedSet<intptr_t> usedHashes;
     UnorderedMap<void*, UnorderedSet<juce::WeakReference<MessageListener>>> messageListeners;
@@ -67,3 +67,10 @@ void pd::WeakReference::setThis() const
     if (pd)
         pd->setThis();
 }
+
+void pd::processDirectMessages(Instance* instance)
+{
+    // Only the GUI needs its synchronous calls to be ordered after the messages it queued
+    if (instance && MessageManager::existsAndIsCurrentThread())
+        instance->processDirectMessages();
+}
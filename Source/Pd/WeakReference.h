@@ -16,6 +16,10 @@ using pd_weak_reference = std::atomic<bool>;
 namespace pd {
 
 class Instance;
+
+// Delivers messages queued with sendDirectMessage, call this right after taking the Pd lock
+void processDirectMessages(Instance* instance);
+
 struct WeakReference {
     WeakReference(void* p, Instance* instance);
 
@@ -42,11 +46,12 @@ struct WeakReference {
     template<typename T>
     struct Ptr {
 
-        Ptr(T* pointer, pd_weak_reference const& ref)
+        Ptr(T* pointer, pd_weak_reference const& ref, Instance* instance)
             : weakRef(ref)
             , ptr(pointer)
         {
             sys_lock();
+            processDirectMessages(instance);
         }
 
         ~Ptr()
@@ -85,7 +90,7 @@ struct WeakReference {
     Ptr<T> get() const
     {
         setThis();
-        return Ptr<T>(static_cast<T*>(ptr), weakRef);
+        return Ptr<T>(static_cast<T*>(ptr), weakRef, pd);
     }
 
     template<typename T>
@@ -92,6 +92,7 @@ PluginEditor::PluginEditor(PluginProcessor& p)
     , pd(&p)
     , sidebar(std::make_unique<Sidebar>(&p, this))
     , statusbar(std::make_unique<Statusbar>(&p, this))
+    , pollScheduler(&p, nvgSurface)
     , nvgSurface(this)
     , openedDialog(nullptr)
     , pluginConstrainer(*getConstrainer())
@@ -1689,13 +1690,7 @@ bool PluginEditor::perform(InvocationInfo const& info)
     }
     case CommandIDs::ConnectionPathfind: {
         cnv = getCurrentCanvas();
-        cnv->patch.startUndoSequence("ConnectionPathFind");
-
-        for (auto* con : cnv->getSelectionOfType<Connection>()) {
-            con->applyBestPath();
-        }
-
-        cnv->patch.endUndoSequence("ConnectionPathFind");
+        cnv->pathUpdater->routeConnections(cnv->getSelectionOfType<Connection>());
         return true;
     }
     case CommandIDs::ZoomIn: {
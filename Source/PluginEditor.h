@@ -22,6 +22,7 @@
 
 #include "Utility/ObjectThemeManager.h"
 #include "NVGSurface.h"
+#include "Utility/PollScheduler.h"
 
 class ConnectionMessageDisplay;
 class Sidebar;
@@ -140,6 +141,8 @@ public:
 
     std::unique_ptr<Palettes> palettes;
 
+    // Declared before the canvases, so that objects can still unregister from it when they get deleted
+    PollScheduler pollScheduler;
     NVGSurface nvgSurface;
 
     std::unique_ptr<Dialog> openedDialog;
@@ -83,6 +83,11 @@ AudioProcessor::BusesProperties PluginProcessor::buildBusesProperties()
 // data from the external if we have it.
 String PluginProcessor::pdlua_version = "pdlua 0.12.0 (lua 5.4)";
 
+static void midiInputClockTick(PluginProcessor* processor)
+{
+    processor->sendScheduledMidi();
+}
+
 PluginProcessor::PluginProcessor()
     : AudioProcessor(buildBusesProperties())
     , internalSynth(std::make_unique<InternalSynth>())
@@ -147,9 +152,6 @@ PluginProcessor::PluginProcessor()
     // Set up midi buffers
     midiBufferInternalSynth.ensureSize(2048);
 
-    atoms_playhead.reserve(3);
-    atoms_playhead.resize(1);
-
     autosave = std::make_unique<Autosave>(this);
 
     auto themeName = settingsFile->getProperty<String>("theme");
@@ -175,6 +177,10 @@ PluginProcessor::PluginProcessor()
         midiDeviceManager.setInternalSynthPort(0);
     }
 
+    midiDeviceManager.onEventsDropped = [this](int const numDropped) {
+        logWarning(String(numDropped) + " MIDI events were dropped, because they came in faster than plugdata could process them, or were too large");
+    };
+
     auto currentThemeTree = settingsFile->getCurrentTheme();
 
     // ag: This needs to be done *after* the library data has been unpacked on
@@ -182,6 +188,12 @@ PluginProcessor::PluginProcessor()
     initialisePd(pdlua_version);
     logMessage(pdlua_version);
 
+    playheadSender = std::make_unique<PlayheadSender>(*this);
+
+    scheduledMidi.reserve(maxScheduledMidiEvents);
+    scheduledMidiData.reserve(maxScheduledMidiBytes);
+    midiInputClock = clock_new(this, reinterpret_cast<t_method>(midiInputClockTick));
+
     updateSearchPaths();
 
     objectLibrary = std::make_unique<pd::Library>(this);
@@ -198,6 +210,9 @@ PluginProcessor::~PluginProcessor()
     // Deleting the pd instance in ~PdInstance() will also free all the Pd patches
     patches.clear();
 
+    setThis();
+    clock_free(midiInputClock);
+
 #if PERFETTO
     MelatoninPerfetto::get().endSession();
 #endif
@@ -376,8 +391,6 @@ bool PluginProcessor::initialiseFilesystem()
     // Check if the abstractions directory exists, if not, unzip it from binaryData
     if (!versionDataDir.exists()) {
         extractionCompleted = false;
-        auto filesystem = BinaryData::getResource(BinaryData::Filesystem);
-
         versionDataDir.getParentDirectory().createDirectory();
         int constexpr maxRetries = 3;
         int retryCount = 0;
@@ -391,7 +404,16 @@ bool PluginProcessor::initialiseFilesystem()
                 continue;
             }
 
-            if (!Decompress::extractTarXz((uint8_t*)filesystem.data(), filesystem.size(), tempVersionDataDir.getParentDirectory(), 40 * 1024 * 1024)) {
+            // Stream the archive straight from the resource file, instead of loading it into memory first
+            auto const resourceStream = BinaryData::createInputStream(BinaryData::Filesystem);
+            if (!resourceStream) {
+                retryCount++;
+                continue;
+            }
+
+            auto const& resource = BinaryData::resources[BinaryData::Filesystem];
+            SubregionStream filesystem(resourceStream.get(), resource.offset, resource.size, false);
+            if (!Decompress::extractTarXz(filesystem, tempVersionDataDir.getParentDirectory())) {
                 retryCount++;
                 continue;
             }
@@ -708,6 +730,9 @@ void PluginProcessor::prepareToPlay(double const sampleRate, int const samplesPe
         inputFifo = std::make_unique<AudioMidiFifo>(maxChannels, std::max<int>(pdBlockSize, samplesPerBlock * oversampleFactor) * 3);
         outputFifo = std::make_unique<AudioMidiFifo>(maxChannels, std::max<int>(pdBlockSize, samplesPerBlock * oversampleFactor) * 3);
         outputFifo->writeSilence(Instance::getBlockSize());
+
+        // Reading from the fifo shouldn't make the block buffer grow on the audio thread
+        blockMidiBuffer.ensureSize(8192);
     }
 
     midiByteIndex = 0;
@@ -717,7 +742,8 @@ void PluginProcessor::prepareToPlay(double const sampleRate, int const samplesPe
 
     midiBufferInternalSynth.ensureSize(2048);
 
-    midiDeviceManager.prepareToPlay(sampleRate * oversampleFactor);
+    auto const midiOutputLatency = variableBlockSize ? Instance::getBlockSize() : 0;
+    midiDeviceManager.prepareToPlay(sampleRate * oversampleFactor, samplesPerBlock * oversampleFactor, Instance::getBlockSize(), midiOutputLatency);
 
     cpuLoadMeasurer.reset(sampleRate, samplesPerBlock);
 
@@ -818,7 +844,7 @@ void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiB
         backupLoopLock.exit();
     }
 
-    sendPlayhead();
+    playheadSender->update(getPlayHead());
 
     for (int i = totalNumInputChannels; i < totalNumOutputChannels; ++i) {
         buffer.clear(i, 0, buffer.getNumSamples());
@@ -827,6 +853,9 @@ void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiB
     auto targetBlock = dsp::AudioBlock<float>(buffer);
     auto const blockOut = oversampling > 0 ? oversampler->processSamplesUp(targetBlock) : targetBlock;
 
+    recordParameterChanges(blockOut.getNumSamples());
+    midiDeviceManager.beginHostBlock(static_cast<int>(blockOut.getNumSamples()));
+
     if (variableBlockSize) {
         processVariable(blockOut, midiBuffer);
     } else {
@@ -889,7 +918,7 @@ void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiB
     midiDeviceManager.clearMidiOutputBuffers(blockOut.getNumSamples());
 
     statusbarSource->setCPUUsage(cpuLoadMeasurer.getLoadAsPercentage());
-    statusbarSource->peakBuffer.write(buffer);
+    statusbarSource->levelMeter.write(buffer);
 
     if (enableLimiter && buffer.getNumChannels() > 0) {
         // Take out inf and NaN values
@@ -930,9 +959,11 @@ void PluginProcessor::processConstant(dsp::AudioBlock<float> buffer)
             midiByteBuffer[2] = 0;
         }
 
+        beginMidiBlock();
         midiDeviceManager.dequeueMidiInput(pdBlockSize, [this](int const port, MidiBuffer const& buffer) {
             sendMidiBuffer(port, buffer);
         });
+        scheduleMidiInput();
 
         for (int ch = 0; ch < buffer.getNumChannels(); ch++) {
             // Copy the channel data into the vector
@@ -943,6 +974,7 @@ void PluginProcessor::processConstant(dsp::AudioBlock<float> buffer)
         }
         setThis();
 
+        playheadSender->send(block * pdBlockSize, sys_getsr());
         sendParameters();
         sendMessagesFromQueue();
 
@@ -983,9 +1015,14 @@ void PluginProcessor::processVariable(dsp::AudioBlock<float> buffer, MidiBuffer&
             midiByteBuffer[2] = 0;
         }
 
+        inputFifo->readParameterChanges(pdBlockSize, [this](AudioMidiFifo::ParameterChange const& change) {
+            sendParameterChange(change);
+        });
+
         blockMidiBuffer.clear();
         inputFifo->readAudioAndMidi(audioBufferIn, blockMidiBuffer);
 
+        beginMidiBlock();
         if (!ProjectInfo::isStandalone) {
             sendMidiBuffer(0, blockMidiBuffer);
         }
@@ -993,6 +1030,7 @@ void PluginProcessor::processVariable(dsp::AudioBlock<float> buffer, MidiBuffer&
         midiDeviceManager.dequeueMidiInput(pdBlockSize, [this](int const port, MidiBuffer const& buffer) {
             sendMidiBuffer(port, buffer);
         });
+        scheduleMidiInput();
 
         for (int channel = 0; channel < audioBufferIn.getNumChannels(); channel++) {
             // Copy the channel data into the vector
@@ -1004,6 +1042,7 @@ void PluginProcessor::processVariable(dsp::AudioBlock<float> buffer, MidiBuffer&
 
         setThis();
 
+        playheadSender->send(0, sys_getsr());
         sendParameters();
         sendMessagesFromQueue();
 
@@ -1029,80 +1068,9 @@ void PluginProcessor::processVariable(dsp::AudioBlock<float> buffer, MidiBuffer&
     outputFifo->readAudioAndMidi(buffer, midiBuffer);
 }
 
-void PluginProcessor::sendPlayhead()
+void PluginProcessor::resendPlayhead()
 {
-    AudioPlayHead const* playhead = getPlayHead();
-
-    if (!playhead)
-        return;
-
-    auto infos = playhead->getPosition();
-
-    lockAudioThread();
-    setThis();
-    if (infos.hasValue()) {
-        atoms_playhead[0] = infos->getIsPlaying();
-        sendMessage("__playhead", "playing", atoms_playhead);
-
-        atoms_playhead[0] = infos->getIsRecording();
-        sendMessage("__playhead", "recording", atoms_playhead);
-
-        atoms_playhead[0] = infos->getIsLooping();
-
-        auto loopPoints = infos->getLoopPoints();
-        if (loopPoints.hasValue()) {
-            atoms_playhead.emplace_back(static_cast<float>(loopPoints->ppqStart));
-            atoms_playhead.emplace_back(static_cast<float>(loopPoints->ppqEnd));
-        } else {
-            atoms_playhead.emplace_back(0.0f);
-            atoms_playhead.emplace_back(0.0f);
-        }
-        sendMessage("__playhead", "looping", atoms_playhead);
-
-        if (infos->getEditOriginTime().hasValue()) {
-            atoms_playhead.resize(1);
-            atoms_playhead[0] = static_cast<float>(*infos->getEditOriginTime());
-            sendMessage("__playhead", "edittime", atoms_playhead);
-        }
-
-        if (infos->getFrameRate().hasValue()) {
-            atoms_playhead.resize(1);
-            atoms_playhead[0] = static_cast<float>(infos->getFrameRate()->getEffectiveRate());
-            sendMessage("__playhead", "framerate", atoms_playhead);
-        }
-
-        if (infos->getBpm().hasValue()) {
-            atoms_playhead.resize(1);
-            atoms_playhead[0] = static_cast<float>(*infos->getBpm());
-            sendMessage("__playhead", "bpm", atoms_playhead);
-        }
-
-        if (infos->getPpqPositionOfLastBarStart().hasValue()) {
-            atoms_playhead.resize(1);
-            atoms_playhead[0] = static_cast<float>(*infos->getPpqPositionOfLastBarStart());
-            sendMessage("__playhead", "lastbar", atoms_playhead);
-        }
-
-        if (infos->getTimeSignature().hasValue()) {
-            atoms_playhead.resize(1);
-            atoms_playhead[0] = static_cast<float>(infos->getTimeSignature()->numerator);
-            atoms_playhead.emplace_back(static_cast<float>(infos->getTimeSignature()->denominator));
-            sendMessage("__playhead", "timesig", atoms_playhead);
-        }
-
-        auto ppq = infos->getPpqPosition();
-        auto samplesTime = infos->getTimeInSamples();
-        auto secondsTime = infos->getTimeInSeconds();
-        if (ppq.hasValue() || samplesTime.hasValue() || secondsTime.hasValue()) {
-            atoms_playhead.resize(3);
-            atoms_playhead[0] = ppq.hasValue() ? static_cast<float>(*ppq) : 0.0f;
-            atoms_playhead[1] = samplesTime.hasValue() ? static_cast<float>(*samplesTime) : 0.0f;
-            atoms_playhead[2] = secondsTime.hasValue() ? static_cast<float>(*secondsTime) : 0.0f;
-            sendMessage("__playhead", "position", atoms_playhead);
-        }
-        atoms_playhead.resize(1);
-    }
-    unlockAudioThread();
+    playheadSender->resendAll();
 }
 
 SmallArray<PlugDataParameter*> PluginProcessor::getEnabledParameters()
@@ -1112,7 +1080,6 @@ SmallArray<PlugDataParameter*> PluginProcessor::getEnabledParameters()
 
 void PluginProcessor::updateEnabledParameters()
 {
-    ScopedLock lock(audioLock);
     enabledParameters.clear();
 
     for (auto* param : getParameters()) {
@@ -1125,15 +1092,109 @@ void PluginProcessor::updateEnabledParameters()
 }
 
 void PluginProcessor::sendParameters()
+{
+    // Checking for changes doesn't need the lock, so this is almost free for blocks without automation
+    if (EXPECT_LIKELY(!changedParameters.any()))
+        return;
+
+    ScopedLock lock(audioLock);
+    auto const& parameters = getParameters();
+    changedParameters.consume([&parameters](size_t const index) {
+        auto* param = static_cast<PlugDataParameter*>(parameters.getUnchecked(static_cast<int>(index)));
+        if (!param->isEnabled())
+            return;
+
+        if (auto const* receiver = param->getReceiverSymbol(); receiver->s_thing)
+            pd_float(receiver->s_thing, param->getUnscaledValue());
+    });
+}
+
+// Host automation only gives us one value per parameter per host block, so [param~] ramps to it over the length of the block
+// In variable block size mode, the changes go through the input fifo, so they stay aligned with the audio of that host block
+void PluginProcessor::recordParameterChanges(int const numSamples)
+{
+    if (EXPECT_LIKELY(!automatedParameters.any()))
+        return;
+
+    ScopedLock lock(audioLock);
+    auto const& parameters = getParameters();
+    automatedParameters.consume([this, &parameters, numSamples](size_t const index) {
+        auto const jump = parameterJumps.testAndClear(index);
+        auto* param = static_cast<PlugDataParameter*>(parameters.getUnchecked(static_cast<int>(index)));
+
+        // Parameters without a [param~] are skipped here, so they cost nothing after this
+        if (!param->isEnabled() || !param->getSignalReceiverSymbol()->s_thing)
+            return;
+
+        auto const change = AudioMidiFifo::ParameterChange { static_cast<int>(index), param->getUnscaledValue(), 0, jump ? 0 : numSamples };
+        if (variableBlockSize)
+            inputFifo->writeParameterChange(change.index, change.value, change.offset, change.rampLength);
+        else
+            sendParameterChange(change);
+    });
+}
+
+void PluginProcessor::sendParameterChange(AudioMidiFifo::ParameterChange const& change)
 {
     ScopedLock lock(audioLock);
-    for (auto* param : enabledParameters) {
-        if (EXPECT_UNLIKELY(param->wasChanged())) {
-            auto title = param->getTitle();
-            sendFloat(title.data(), param->getUnscaledValue());
-            param->setUnchanged();
+    auto* param = static_cast<PlugDataParameter*>(getParameters().getUnchecked(change.index));
+    if (auto const* receiver = param->getSignalReceiverSymbol(); receiver->s_thing) {
+        // [param~] feeds this into a [vline~], which takes a target, ramp time and delay in milliseconds
+        // The delay is relative to the start of the next Pd block, so the ramp starts at the exact sample
+        auto const msPerSample = 1000.0f / sys_getsr();
+        t_atom atoms[3];
+        SETFLOAT(atoms, change.value);
+        SETFLOAT(atoms + 1, static_cast<float>(change.rampLength) * msPerSample);
+        SETFLOAT(atoms + 2, static_cast<float>(change.offset) * msPerSample);
+        pd_list(receiver->s_thing, &s_list, 3, atoms);
+    }
+}
+
+void PluginProcessor::markParameterChanged(int const index)
+{
+    changedParameters.set(static_cast<size_t>(index));
+    automatedParameters.set(static_cast<size_t>(index));
+}
+
+void PluginProcessor::clearParameterChanged(int const index)
+{
+    changedParameters.clear(static_cast<size_t>(index));
+    automatedParameters.clear(static_cast<size_t>(index));
+}
+
+void PluginProcessor::parameterNamesChanged()
+{
+    parameterIndicesOutdated = true;
+}
+
+PlugDataParameter* PluginProcessor::findEnabledParameter(SmallString const& name)
+{
+    auto const& parameters = getParameters();
+    if (parameterIndicesOutdated.exchange(false)) {
+        parameterIndices.clear();
+        for (int i = 0; i < parameters.size(); i++) {
+            auto const* param = static_cast<PlugDataParameter*>(parameters[i]);
+            if (param->isEnabled())
+                parameterIndices[hash(param->getTitle())] = i;
         }
     }
+
+    auto const it = parameterIndices.find(hash(name));
+    if (it == parameterIndices.end())
+        return nullptr;
+
+    auto* param = static_cast<PlugDataParameter*>(parameters[it->second]);
+    if (param->isEnabled() && param->getTitle() == name)
+        return param;
+
+    // The hash matched a different name, so two parameter names have the same hash
+    for (auto* p : parameters) {
+        auto* other = static_cast<PlugDataParameter*>(p);
+        if (other->isEnabled() && other->getTitle() == name)
+            return other;
+    }
+
+    return nullptr;
 }
 
 MidiDeviceManager& PluginProcessor::getMidiDeviceManager()
@@ -1141,42 +1202,131 @@ MidiDeviceManager& PluginProcessor::getMidiDeviceManager()
     return midiDeviceManager;
 }
 
+// Events at the start of the block are sent right away, later ones are scheduled within the block by scheduleMidiInput()
 void PluginProcessor::sendMidiBuffer(int const device, MidiBuffer const& buffer)
 {
-    if (acceptsMidi()) {
-        for (auto event : buffer) {
-            auto message = event.getMessage();
-            auto const channel = message.getChannel() + (device << 4);
-
-            if (message.isNoteOn()) {
-                sendNoteOn(channel, message.getNoteNumber(), message.getVelocity());
-            } else if (message.isNoteOff()) {
-                sendNoteOn(channel, message.getNoteNumber(), 0);
-            } else if (message.isController()) {
-                sendControlChange(channel, message.getControllerNumber(), message.getControllerValue());
-            } else if (message.isPitchWheel()) {
-                sendPitchBend(channel, message.getPitchWheelValue() - 8192);
-            } else if (message.isChannelPressure()) {
-                sendAfterTouch(channel, message.getChannelPressureValue());
-            } else if (message.isAftertouch()) {
-                sendPolyAfterTouch(channel, message.getNoteNumber(), message.getAfterTouchValue());
-            } else if (message.isProgramChange()) {
-                sendProgramChange(channel, message.getProgramChangeNumber());
-            } else if (message.isSysEx()) {
-                for (int i = 0; i < message.getSysExDataSize(); ++i) {
-                    sendSysEx(device, message.getSysExData()[i]);
-                }
-            } else if (message.isMidiClock() || message.isMidiStart() || message.isMidiStop() || message.isMidiContinue() || message.isActiveSense() || (message.getRawDataSize() == 1 && message.getRawData()[0] == 0xff)) {
-                for (int i = 0; i < message.getRawDataSize(); ++i) {
-                    sendSysRealTime(device, message.getRawData()[i]);
-                }
-            }
+    if (!acceptsMidi() || buffer.isEmpty())
+        return;
+
+    ScopedLock lock(audioLock);
+    for (auto const event : buffer) {
+        auto const fitsInSchedule = scheduledMidi.size() < maxScheduledMidiEvents && scheduledMidiData.size() + event.numBytes <= maxScheduledMidiBytes;
+        if (event.samplePosition <= 0 || !fitsInSchedule) {
+            sendMidiEvent(device, event.data, event.numBytes);
+            continue;
+        }
+
+        auto const scheduled = ScheduledMidiEvent { event.samplePosition, device, static_cast<uint32>(scheduledMidiData.size()), static_cast<uint32>(event.numBytes) };
+        scheduledMidiData.vector().insert(scheduledMidiData.end(), event.data, event.data + event.numBytes);
+
+        // Events from different devices are merged, events at the same offset stay in the order they came in
+        auto& events = scheduledMidi.vector();
+        events.insert(std::upper_bound(events.begin(), events.end(), scheduled, [](auto const& a, auto const& b) {
+            return a.offset < b.offset;
+        }),
+            scheduled);
+    }
+}
+
+void PluginProcessor::sendMidiEvent(int const device, uint8 const* data, int const size)
+{
+    if (size <= 0)
+        return;
+
+    auto const status = data[0];
+    auto const channel = (status & 0x0F) + 1 + (device << 4);
+    auto const dataByte = [data, size](int const index) -> int {
+        return index < size ? data[index] & 0x7F : 0;
+    };
 
-            for (int i = 0; i < message.getRawDataSize(); i++) {
-                sendMidiByte(device, message.getRawData()[i]);
+    switch (status & 0xF0) {
+    case 0x90:
+        sendNoteOn(channel, dataByte(1), dataByte(2));
+        break;
+    case 0x80:
+        sendNoteOn(channel, dataByte(1), 0);
+        break;
+    case 0xB0:
+        sendControlChange(channel, dataByte(1), dataByte(2));
+        break;
+    case 0xE0:
+        sendPitchBend(channel, (dataByte(2) << 7 | dataByte(1)) - 8192);
+        break;
+    case 0xD0:
+        sendAfterTouch(channel, dataByte(1));
+        break;
+    case 0xA0:
+        sendPolyAfterTouch(channel, dataByte(1), dataByte(2));
+        break;
+    case 0xC0:
+        sendProgramChange(channel, dataByte(1));
+        break;
+    default:
+        if (status == 0xF0) {
+            // Without the 0xF0 and 0xF7 that wrap the data
+            for (int i = 1; i < size && data[i] != 0xF7; ++i) {
+                sendSysEx(device, data[i]);
             }
+        } else if (size == 1 && (status == 0xF8 || status == 0xFA || status == 0xFB || status == 0xFC || status == 0xFE || status == 0xFF)) {
+            sendSysRealTime(device, status);
         }
+        break;
+    }
+
+    for (int i = 0; i < size; i++) {
+        sendMidiByte(device, data[i]);
+    }
+}
+
+void PluginProcessor::beginMidiBlock()
+{
+    setThis();
+
+    // Events whose clock didn't fire in the last block are sent now, instead of being dropped
+    if (nextScheduledMidi < scheduledMidi.size()) {
+        ScopedLock lock(audioLock);
+        clock_unset(midiInputClock);
+        scheduledMidiOffset = std::numeric_limits<int>::max();
+        sendScheduledMidi();
     }
+
+    scheduledMidi.clear();
+    scheduledMidiData.clear();
+    nextScheduledMidi = 0;
+    midiBlockStartTime = clock_getlogicaltime();
+}
+
+void PluginProcessor::scheduleMidiInput()
+{
+    if (scheduledMidi.empty())
+        return;
+
+    ScopedLock lock(audioLock);
+    scheduledMidiOffset = 0;
+    sendScheduledMidi();
+}
+
+// Sends everything up to scheduledMidiOffset, and sets the clock for the next event
+// Pd's scheduler runs clocks before the DSP of a block, at their logical time within it
+void PluginProcessor::sendScheduledMidi()
+{
+    while (nextScheduledMidi < scheduledMidi.size() && scheduledMidi[nextScheduledMidi].offset <= scheduledMidiOffset) {
+        auto const& event = scheduledMidi[nextScheduledMidi++];
+        sendMidiEvent(event.device, scheduledMidiData.data() + event.dataStart, static_cast<int>(event.size));
+    }
+
+    if (nextScheduledMidi < scheduledMidi.size()) {
+        auto const offset = scheduledMidi[nextScheduledMidi].offset;
+        clock_delay(midiInputClock, static_cast<double>(offset - scheduledMidiOffset) * 1000.0 / sys_getsr());
+        scheduledMidiOffset = offset;
+    }
+}
+
+// Where in the current block Pd's logical time is, so MIDI sent from a clock keeps its position within the block
+int PluginProcessor::getMidiOutputOffset() const
+{
+    auto const offset = static_cast<int>(std::lround(clock_gettimesince(midiBlockStartTime) * sys_getsr() / 1000.0));
+    return std::clamp(offset, 0, Instance::getBlockSize() - 1);
 }
 
 bool PluginProcessor::hasEditor() const
@@ -1648,9 +1798,9 @@ void PluginProcessor::receiveNoteOn(int const channel, int const pitch, int cons
     auto const deviceChannel = channel - port * 16;
 
     if (velocity == 0) {
-        midiDeviceManager.enqueueMidiOutput(port, MidiMessage::noteOff(deviceChannel, pitch, static_cast<uint8>(0)), audioAdvancement);
+        midiDeviceManager.enqueueMidiOutput(port, MidiMessage::noteOff(deviceChannel, pitch, static_cast<uint8>(0)), getMidiOutputOffset());
     } else {
-        midiDeviceManager.enqueueMidiOutput(port, MidiMessage::noteOn(deviceChannel, pitch, static_cast<uint8>(velocity)), audioAdvancement);
+        midiDeviceManager.enqueueMidiOutput(port, MidiMessage::noteOn(deviceChannel, pitch, static_cast<uint8>(velocity)), getMidiOutputOffset());
     }
 }
 
@@ -1671,7 +1821,7 @@ void PluginProcessor::receiveControlChange(int const channel, int const controll
     auto const port = channel >> 4;
     auto const deviceChannel = channel - port * 16;
 
-    midiDeviceManager.enqueueMidiOutput(port, MidiMessage::controllerEvent(deviceChannel, controller, value), audioAdvancement);
+    midiDeviceManager.enqueueMidiOutput(port, MidiMessage::controllerEvent(deviceChannel, controller, value), getMidiOutputOffset());
 }
 
 void PluginProcessor::receiveProgramChange(int const channel, int const value)
@@ -1679,7 +1829,7 @@ void PluginProcessor::receiveProgramChange(int const channel, int const value)
     auto const port = channel >> 4;
     auto const deviceChannel = channel - port * 16;
 
-    midiDeviceManager.enqueueMidiOutput(port, MidiMessage::programChange(deviceChannel, value), audioAdvancement);
+    midiDeviceManager.enqueueMidiOutput(port, MidiMessage::programChange(deviceChannel, value), getMidiOutputOffset());
 }
 
 void PluginProcessor::receivePitchBend(int const channel, int const value)
@@ -1687,7 +1837,7 @@ void PluginProcessor::receivePitchBend(int const channel, int const value)
     auto const port = channel >> 4;
     auto const deviceChannel = channel - port * 16;
 
-    midiDeviceManager.enqueueMidiOutput(port, MidiMessage::pitchWheel(deviceChannel, value + 8192), audioAdvancement);
+    midiDeviceManager.enqueueMidiOutput(port, MidiMessage::pitchWheel(deviceChannel, value + 8192), getMidiOutputOffset());
 }
 
 void PluginProcessor::receiveAftertouch(int const channel, int const value)
@@ -1695,7 +1845,7 @@ void PluginProcessor::receiveAftertouch(int const channel, int const value)
     auto const port = channel >> 4;
     auto const deviceChannel = channel - port * 16;
 
-    midiDeviceManager.enqueueMidiOutput(port, MidiMessage::channelPressureChange(deviceChannel, value), audioAdvancement);
+    midiDeviceManager.enqueueMidiOutput(port, MidiMessage::channelPressureChange(deviceChannel, value), getMidiOutputOffset());
 }
 
 void PluginProcessor::receivePolyAftertouch(int const channel, int const pitch, int const value)
@@ -1703,7 +1853,7 @@ void PluginProcessor::receivePolyAftertouch(int const channel, int const pitch,
     auto const port = channel >> 4;
     auto const deviceChannel = channel - port * 16;
 
-    midiDeviceManager.enqueueMidiOutput(port, MidiMessage::aftertouchChange(deviceChannel, pitch, value), audioAdvancement);
+    midiDeviceManager.enqueueMidiOutput(port, MidiMessage::aftertouchChange(deviceChannel, pitch, value), getMidiOutputOffset());
 }
 
 void PluginProcessor::receiveMidiByte(int const channel, int const byte)
@@ -1712,13 +1862,13 @@ void PluginProcessor::receiveMidiByte(int const channel, int const byte)
 
     if (midiByteIsSysex) {
         if (byte == 0xf7) {
-            midiDeviceManager.enqueueMidiOutput(port, MidiMessage::createSysExMessage(midiByteBuffer, static_cast<int>(midiByteIndex)), audioAdvancement);
+            midiDeviceManager.enqueueMidiOutput(port, MidiMessage::createSysExMessage(midiByteBuffer, static_cast<int>(midiByteIndex)), getMidiOutputOffset());
             midiByteIndex = 0;
             midiByteIsSysex = false;
         } else {
             midiByteBuffer[midiByteIndex++] = static_cast<uint8>(byte);
-            if (midiByteIndex == 512) {
-                midiByteIndex = 511;
+            if (midiByteIndex == MidiDeviceManager::maxOutputSysExSize) {
+                midiByteIndex = MidiDeviceManager::maxOutputSysExSize - 1;
             }
         }
     } else if (midiByteIndex == 0 && byte == 0xf0) {
@@ -1726,13 +1876,13 @@ void PluginProcessor::receiveMidiByte(int const channel, int const byte)
     } else {
         // Handle single-byte messages
         if (midiByteIndex == 0 && byte >= 0xf8 && byte <= 0xff) {
-            midiDeviceManager.enqueueMidiOutput(port, MidiMessage(static_cast<uint8>(byte)), audioAdvancement);
+            midiDeviceManager.enqueueMidiOutput(port, MidiMessage(static_cast<uint8>(byte)), getMidiOutputOffset());
         }
         // Handle 3-byte messages
         else {
             midiByteBuffer[midiByteIndex++] = static_cast<uint8>(byte);
             if (midiByteIndex >= 3) {
-                midiDeviceManager.enqueueMidiOutput(port, MidiMessage(midiByteBuffer, 3), audioAdvancement);
+                midiDeviceManager.enqueueMidiOutput(port, MidiMessage(midiByteBuffer, 3), getMidiOutputOffset());
                 midiByteIndex = 0;
             }
         }
@@ -1972,16 +2122,6 @@ void PluginProcessor::sendParameterInfoChangeMessage()
 
 void PluginProcessor::handleParameterMessage(SmallArray<pd::Atom> const& atoms)
 {
-    auto getEnabledParameter = [this](SmallString const& name) -> PlugDataParameter* {
-        for (auto* p : getParameters()) {
-            auto* param = dynamic_cast<PlugDataParameter*>(p);
-            if (param->isEnabled() && param->getTitle() == name) {
-                return param;
-            }
-        }
-        return nullptr;
-    };
-
     if (atoms.size() >= 2) {
         auto const name = atoms[0].toSmallString();
         auto const selector = hash(atoms[1].toSmallString());
@@ -1990,7 +2130,7 @@ void PluginProcessor::handleParameterMessage(SmallArray<pd::Atom> const& atoms)
             enableAudioParameter(name);
             // Set default value with first create argument
             if (atoms.size() >= 3 && atoms[2].isFloat()) {
-                if (auto* param = getEnabledParameter(name)) {
+                if (auto* param = findEnabledParameter(name)) {
                     auto defaultValue = atoms[2].getFloat();
                     if (atoms.size() >= 5 && atoms[3].isFloat() && atoms[4].isFloat()) {
                         param->setRange(atoms[3].getFloat(), atoms[4].getFloat());
@@ -2013,9 +2153,18 @@ void PluginProcessor::handleParameterMessage(SmallArray<pd::Atom> const& atoms)
             disableAudioParameter(name);
             break;
         }
+        case hash("signal"): {
+            // Sent when a [param~] is created, so it starts at the current value
+            if (auto const* param = findEnabledParameter(name)) {
+                auto const index = static_cast<size_t>(param->getParameterIndex());
+                parameterJumps.set(index);
+                automatedParameters.set(index);
+            }
+            break;
+        }
         case hash("float"): {
             if (atoms.size() > 2 && atoms[2].isFloat()) {
-                if (auto* param = getEnabledParameter(name)) {
+                if (auto* param = findEnabledParameter(name)) {
                     float const value = atoms[2].getFloat();
                     param->setUnscaledValueNotifyingHost(value);
 
@@ -2030,7 +2179,7 @@ void PluginProcessor::handleParameterMessage(SmallArray<pd::Atom> const& atoms)
         }
         case hash("range"): {
             if (atoms.size() > 3 && atoms[2].isFloat() && atoms[3].isFloat()) {
-                if (auto* param = getEnabledParameter(name)) {
+                if (auto* param = findEnabledParameter(name)) {
                     float const min = atoms[2].getFloat();
                     float max = atoms[3].getFloat();
                     max = std::max(max, min + 0.000001f);
@@ -2041,7 +2190,7 @@ void PluginProcessor::handleParameterMessage(SmallArray<pd::Atom> const& atoms)
         }
         case hash("mode"): {
             if (atoms.size() > 2 && atoms[2].isFloat()) {
-                if (auto* param = getEnabledParameter(name)) {
+                if (auto* param = findEnabledParameter(name)) {
                     float const mode = atoms[2].getFloat();
                     param->setMode(static_cast<PlugDataParameter::Mode>(std::clamp<int>(mode, 1, 4)));
                 }
@@ -2050,7 +2199,7 @@ void PluginProcessor::handleParameterMessage(SmallArray<pd::Atom> const& atoms)
         }
         case hash("change"): {
             if (atoms.size() > 2 && atoms[2].isFloat()) {
-                if (auto* param = getEnabledParameter(name)) {
+                if (auto* param = findEnabledParameter(name)) {
                     int const state = atoms[2].getFloat() != 0;
                     param->setGestureState(state);
                 }
@@ -2065,13 +2214,12 @@ void PluginProcessor::handleParameterMessage(SmallArray<pd::Atom> const& atoms)
 
 void PluginProcessor::enableAudioParameter(SmallString const& name)
 {
+    if (findEnabledParameter(name))
+        return;
+
     int numEnabled = 0;
     for (auto* p : getParameters()) {
-        auto const* param = dynamic_cast<PlugDataParameter*>(p);
-        numEnabled += param->isEnabled();
-        if (param->isEnabled() && param->getTitle() == name) {
-            return;
-        }
+        numEnabled += static_cast<PlugDataParameter*>(p)->isEnabled();
     }
 
     for (auto* p : getParameters()) {
@@ -2094,19 +2242,15 @@ void PluginProcessor::enableAudioParameter(SmallString const& name)
 
 void PluginProcessor::disableAudioParameter(SmallString const& name)
 {
-    for (auto* p : getParameters()) {
-        auto* param = dynamic_cast<PlugDataParameter*>(p);
-        if (param->isEnabled() && param->getTitle() == name) {
-            param->setEnabled(false);
-            param->setDefaultValue(0.0f);
-            param->setValue(0.0f);
-            param->setRange(0.0f, 1.0f);
-            param->setMode(PlugDataParameter::Float);
-            param->clearLoadedFromDAWFlag();
-            param->setUnchanged();
-            param->notifyDAW();
-            break;
-        }
+    if (auto* param = findEnabledParameter(name)) {
+        param->setEnabled(false);
+        param->setDefaultValue(0.0f);
+        param->setValue(0.0f);
+        param->setRange(0.0f, 1.0f);
+        param->setMode(PlugDataParameter::Float);
+        param->clearLoadedFromDAWFlag();
+        param->setUnchanged();
+        param->notifyDAW();
     }
 
     updateEnabledParameters();
@@ -2238,6 +2382,9 @@ void PluginProcessor::reloadAbstractions(File const changedPatch, t_glist* excep
         editor->updateCommandStatus();
     }
 
+    // Reloaded abstractions could also be inside patches that aren't open
+    rescanObjectImplementations();
+
     isPerformingGlobalSync = false;
 }
 
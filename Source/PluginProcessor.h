@@ -18,6 +18,8 @@
 #include "Utility/SettingsFile.h"
 #include "Utility/AudioMidiFifo.h"
 #include "Utility/SeqLock.h"
+#include "Utility/AtomicBitSet.h"
+#include "Utility/PlayheadSender.h"
 #include "Utility/MidiDeviceManager.h"
 
 #include "Pd/Instance.h"
@@ -136,17 +138,29 @@ public:
     void updateSearchPaths();
 
     void sendMidiBuffer(int device, MidiBuffer const& buffer);
-    void sendPlayhead();
+    void sendMidiEvent(int device, uint8 const* data, int size);
+    void beginMidiBlock();
+    void scheduleMidiInput();
+    void sendScheduledMidi();
+    int getMidiOutputOffset() const;
     void sendParameters();
+    void recordParameterChanges(int numSamples);
+    void sendParameterChange(AudioMidiFifo::ParameterChange const& change);
 
     void updateEnabledParameters();
     SmallArray<PlugDataParameter*> getEnabledParameters();
+    PlugDataParameter* findEnabledParameter(SmallString const& name);
+
+    void markParameterChanged(int index);
+    void clearParameterChanged(int index);
+    void parameterNamesChanged();
 
     SmallArray<PluginEditor*> getEditors() const;
 
     void enableAudioParameter(SmallString const& name);
     void disableAudioParameter(SmallString const& name);
     void handleParameterMessage(SmallArray<pd::Atom> const& atoms) override;
+    void resendPlayhead() override;
 
     void performLatencyCompensationChange(float value) override;
     void sendParameterInfoChangeMessage();
@@ -222,6 +236,8 @@ private:
     std::unique_ptr<AudioMidiFifo> inputFifo;
     std::unique_ptr<AudioMidiFifo> outputFifo;
 
+    std::unique_ptr<PlayheadSender> playheadSender;
+
     MidiBuffer blockMidiBuffer;
     MidiBuffer midiBufferInternalSynth;
 
@@ -229,13 +245,44 @@ private:
 
     AudioProcessLoadMeasurer cpuLoadMeasurer;
 
+    // Incoming MIDI that belongs later in the current Pd block, sorted by offset, and sent from midiInputClock
+    // Pd runs clocks at their logical time within the block, so objects like [vline~] can use the exact sample
+    static constexpr size_t maxScheduledMidiEvents = 1024;
+    static constexpr size_t maxScheduledMidiBytes = 1 << 16;
+
+    struct ScheduledMidiEvent {
+        int offset;
+        int device;
+        uint32 dataStart;
+        uint32 size;
+    };
+    HeapArray<ScheduledMidiEvent> scheduledMidi;
+    HeapArray<uint8> scheduledMidiData;
+    size_t nextScheduledMidi = 0;
+    int scheduledMidiOffset = 0;
+    t_clock* midiInputClock = nullptr;
+
+    // Pd's logical time at the start of the current block, to find where outgoing MIDI was sent within the block
+    double midiBlockStartTime = 0.0;
+
     bool midiByteIsSysex = false;
-    uint8 midiByteBuffer[512] = { };
+    uint8 midiByteBuffer[MidiDeviceManager::maxOutputSysExSize] = { };
     size_t midiByteIndex = 0;
 
-    SmallArray<pd::Atom> atoms_playhead;
     SmallArray<PlugDataParameter*> enabledParameters;
 
+    // Parameters that changed since the last Pd block, by their index in getParameters()
+    AtomicBitSet<numParameters + 1> changedParameters;
+
+    // Same as changedParameters, but collected once per host block for [param~]
+    // Parameters in parameterJumps were requested by a new [param~], which should start at the current value instead of ramping to it
+    AtomicBitSet<numParameters + 1> automatedParameters;
+    AtomicBitSet<numParameters + 1> parameterJumps;
+
+    // Enabled parameters by the hash of their name, for [param] messages. Rebuilt when names or enablement change
+    UnorderedMap<hash32, int> parameterIndices;
+    std::atomic<bool> parameterIndicesOutdated = true;
+
     int lastSetProgram = 0;
 
     Limiter limiter;
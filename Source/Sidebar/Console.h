@@ -12,8 +12,8 @@ extern "C" {
 #include <pd-lua/lua/lualib.h>
 }
 
-#include "Utility/CachedStringWidth.h"
-#include "Components/BouncingViewport.h"
+#include "Utility/ConsoleHistory.h"
+#include "Components/SearchEditor.h"
 #include "Object.h"
 #include "Objects/ObjectBase.h"
 
@@ -93,20 +93,23 @@ private:
 };
 
 class Console final : public Component
-    , public Value::Listener {
+    , public Value::Listener
+    , public Timer {
 
 public:
     explicit Console(pd::Instance* pd)
+        : console(pd, settingsValues)
     {
-        // Viewport takes ownership
-        console = new ConsoleComponent(pd, settingsValues, viewport);
-
-        viewport.setViewedComponent(console);
-        viewport.setScrollBarsShown(true, false);
-
-        console->setVisible(true);
+        filterInput.setBackgroundColour(PlugDataColour::sidebarActiveBackgroundColourId);
+        filterInput.setTextToShowWhenEmpty("Type to filter messages", PlugDataColours::sidebarTextColour.withAlpha(0.5f));
+        filterInput.setJustification(Justification::centredLeft);
+        filterInput.setBorder({ 1, 23, 5, 1 });
+        filterInput.onTextChange = [this] {
+            updateFilter();
+        };
 
-        addAndMakeVisible(viewport);
+        addAndMakeVisible(filterInput);
+        addAndMakeVisible(console);
 
         for (auto& settingsValue : settingsValues) {
             settingsValue.addListener(this);
@@ -117,7 +120,7 @@ public:
         settingsValues[3] = true;
         settingsValues[4] = true;
 
-        resized();
+        updateFilter();
     }
 
     static UnorderedMap<String, Object*> getUniqueObjectNames(Canvas* cnv)
@@ -146,218 +149,151 @@ public:
     void valueChanged(Value& v) override
     {
         if (v.refersToSameSourceAs(settingsValues[0])) {
-            console->clear();
+            console.clear();
         } else if (v.refersToSameSourceAs(settingsValues[1])) {
-            console->restore();
+            console.restore();
+        } else if (v.refersToSameSourceAs(settingsValues[2]) || v.refersToSameSourceAs(settingsValues[3])) {
+            updateFilter();
         } else {
             update();
         }
     }
 
-    void resized() override
+    void lookAndFeelChanged() override
     {
-        auto const bounds = getLocalBounds();
-        viewport.setBounds(bounds);
+        filterInput.setColour(TextEditor::backgroundColourId, Colours::transparentBlack);
+        filterInput.setColour(TextEditor::outlineColourId, Colours::transparentBlack);
+        filterInput.setColour(TextEditor::textColourId, PlugDataColours::sidebarTextColour);
 
-        auto const width = viewport.canScrollVertically() ? viewport.getWidth() - 5.0f : viewport.getWidth();
-        console->setSize(width, std::max<int>(console->getTotalHeight(), viewport.getHeight()));
+        filterInput.applyColourToAllText(PlugDataColours::panelTextColour);
     }
 
-    void clear()
+    void paint(Graphics& g) override
     {
-        console->clear();
+        g.setColour(PlugDataColours::sidebarActiveBackgroundColour);
+        g.fillRoundedRectangle(filterInput.getBounds().reduced(6, 4).toFloat(), Corners::defaultCornerRadius);
     }
 
-    void update()
+    void paintOverChildren(Graphics& g) override
     {
-        console->update();
-        resized();
-        repaint();
+        Fonts::drawIcon(g, Icons::Search, 2, 1, 32, PlugDataColours::sidebarTextColour, 12);
     }
 
-    void deselect()
+    void resized() override
     {
-        console->selectedItems.clear();
-        repaint();
+        auto bounds = getLocalBounds();
+        filterInput.setBounds(bounds.removeFromTop(34).reduced(5, 4));
+        console.setBounds(bounds);
     }
 
-    class ConsoleComponent final : public Component {
-        class ConsoleMessage final : public Component {
-
-            ConsoleComponent& console;
-
-        public:
-            int idx;
-
-            ConsoleMessage(int const index, ConsoleComponent& parent)
-                : console(parent)
-                , idx(index)
-            {
-                parent.addAndMakeVisible(this);
-            }
-
-            void mouseDown(MouseEvent const& e) override
-            {
-                if (e.source.isTouch())
-                    return;
-
-                handleClick(e);
-            }
-
-            void mouseUp(MouseEvent const& e) override
-            {
-                if (!e.source.isTouch() || e.mouseWasDraggedSinceMouseDown())
-                    return;
-
-                handleClick(e);
-            }
-
-            void handleClick(MouseEvent const& e)
-            {
-                if (!e.mods.isShiftDown() && !e.mods.isCommandDown()) {
-                    console.selectedItems.clear();
-                }
-
-                auto& [object, message, type, length, repeats] = console.pd->getConsoleMessages()[idx];
-                if (e.mods.isPopupMenu()) {
-
-                    PopupMenu menu;
-                    menu.addItem("Copy", [this] { console.copySelectionToClipboard(); });
-                    menu.addItem("Show origin", object != nullptr, false, [this, target = object] {
-                        auto* editor = findParentComponentOfClass<PluginEditor>();
-                        editor->highlightSearchTarget(target, true);
-                    });
-                    menu.showMenuAsync(PopupMenu::Options().withTargetComponent(this));
-                }
-
-                if (e.mods.isShiftDown()) {
-                    int startIdx = console.messages.size();
-                    int const endIdx = idx;
-                    for (auto const& item : console.selectedItems) {
-                        startIdx = std::min(item->idx, startIdx);
-                    }
-                    for (int i = std::min(startIdx, endIdx); i < std::max(startIdx, endIdx); i++) {
-                        console.selectedItems.add_unique(SafePointer(console.messages[i].get()));
-                    }
-                }
-
-                console.selectedItems.add_unique(SafePointer(this));
-                console.repaint();
-            }
-
-            void paint(Graphics& g) override
-            {
-                auto const isSelected = console.selectedItems.contains(this);
-                auto const showMessages = getValue<bool>(console.settingsValues[2]);
-                auto const showErrors = getValue<bool>(console.settingsValues[3]);
-
-                if (isSelected) {
-                    // Draw selected background
-                    g.setColour(PlugDataColours::sidebarActiveBackgroundColour);
-                    g.fillRoundedRectangle(getLocalBounds().reduced(0, 1).toFloat().withTrimmedTop(0.5f), Corners::defaultCornerRadius);
-
-                    for (auto& item : console.selectedItems) {
-
-                        if (!item.getComponent())
-                            return;
-                        // Draw connected on top
-                        if (item->idx == idx - 1) {
-                            g.setColour(PlugDataColours::sidebarActiveBackgroundColour);
-                            g.fillRect(getLocalBounds().toFloat().withTrimmedBottom(5));
-
-                            g.setColour(PlugDataColours::outlineColour);
-                            g.drawLine(10, 0, getWidth() - 10, 0);
-                        }
-
-                        // Draw connected on bottom
-                        if (item->idx == idx + 1) {
-                            g.setColour(PlugDataColours::sidebarActiveBackgroundColour);
-                            g.fillRect(getLocalBounds().toFloat().withTrimmedTop(5));
-                        }
-                    }
-                }
+    void clear()
+    {
+        console.clear();
+    }
 
-                // Get console message
-                auto& [object, message, type, length, repeats] = console.pd->getConsoleMessages()[idx];
+    // Picks up new messages, and continues filtering if the filter changed
+    void update()
+    {
+        if (console.update()) {
+            stopTimer();
+        } else if (!isTimerRunning()) {
+            startTimerHz(30);
+        }
+    }
 
-                // Check if message type should be visible
-                if ((type == 0 && !showMessages) || (type == 1 && !showErrors)) {
-                    return;
-                }
+    void deselect()
+    {
+        console.selectedLines.clear();
+        console.repaint();
+    }
 
-                // Approximate number of lines from string length and current width
-                auto const totalLength = length + calculateRepeatOffset(repeats);
-                auto const numLines = Console::calculateNumLines(message, totalLength, console.getWidth());
+    // Only draws the rows that are visible, so the number of messages doesn't matter for drawing or scrolling
+    class ConsoleComponent final : public Component
+        , public ScrollBar::Listener {
 
-                auto textColour = PlugDataColours::sidebarTextColour;
+        pd::Instance* pd; // instance to get console messages from
+        ConsoleHistory& history;
+        ConsoleView view;
+        StackArray<Value, 5>& settingsValues;
 
-                if (type == 1)
-                    textColour = Colours::orange;
-                else if (type == 2)
-                    textColour = Colours::red;
+        ScrollBar scrollBar = ScrollBar(true);
+        double scrollPosition = 0.0;
+        double dragStartScrollPosition = 0.0;
+        uint64 lastClickedLine = 0;
 
-                auto bounds = getLocalBounds().reduced(8, 2);
-                if (repeats > 1) {
+        static constexpr int topMargin = 4;
+        static constexpr int bottomMargin = 4;
 
-                    auto repeatIndicatorBounds = bounds.removeFromLeft(calculateRepeatOffset(repeats)).toFloat().translated(-4, 0.25);
-                    repeatIndicatorBounds = repeatIndicatorBounds.withSizeKeepingCentre(repeatIndicatorBounds.getWidth(), 21);
+    public:
+        UnorderedSet<uint64> selectedLines;
 
-                    auto circleColour = PlugDataColours::sidebarActiveBackgroundColour;
-                    auto const backgroundColour = PlugDataColours::sidebarBackgroundColour;
-                    auto const contrast = isSelected ? 1.5f : 0.5f;
+        ConsoleComponent(pd::Instance* instance, StackArray<Value, 5>& settings)
+            : pd(instance)
+            , history(instance->getConsoleHistory())
+            , view(history)
+            , settingsValues(settings)
+        {
+            scrollBar.addListener(this);
+            addAndMakeVisible(scrollBar);
 
-                    circleColour = Colour(circleColour.getRed() + (circleColour.getRed() - backgroundColour.getRed()) * contrast,
-                        circleColour.getGreen() + (circleColour.getGreen() - backgroundColour.getGreen()) * contrast,
-                        circleColour.getBlue() + (circleColour.getBlue() - backgroundColour.getBlue()) * contrast);
+            setAccessible(false);
+            setWantsKeyboardFocus(true);
+        }
 
-                    g.setColour(circleColour);
-                    auto const circleBounds = repeatIndicatorBounds.reduced(2);
-                    g.fillRoundedRectangle(circleBounds, circleBounds.getHeight() / 2.0f);
+        void setFilter(String const& text, bool const showMessages, bool const showErrors)
+        {
+            view.setFilter(text, showMessages, showErrors);
+        }
 
-                    Fonts::drawText(g, String(repeats), repeatIndicatorBounds, PlugDataColours::sidebarTextColour, 12, Justification::centred);
-                }
+        bool update()
+        {
+            auto const done = view.update();
 
-                // Draw text
-                Fonts::drawFittedText(g, message, bounds.translated(0, -1), textColour, numLines, 0.9f, 14);
+            updateScrollBar();
+            if (getValue<bool>(settingsValues[4])) {
+                setScrollPosition(std::numeric_limits<double>::max());
             }
-        };
-
-        StackArray<Value, 5>& settingsValues;
-        Viewport& viewport;
 
-        pd::Instance* pd; // instance to get console messages from
-    public:
-        std::deque<std::unique_ptr<ConsoleMessage>> messages;
-        SmallArray<SafePointer<ConsoleMessage>> selectedItems;
+            repaint();
+            return done;
+        }
 
-        ConsoleComponent(pd::Instance* instance, StackArray<Value, 5>& b, Viewport& v)
-            : settingsValues(b)
-            , viewport(v)
-            , pd(instance)
+        void clear()
         {
-            setAccessible(false);
-            setWantsKeyboardFocus(true);
-            repaint();
+            history.clear();
+            selectedLines.clear();
+            update();
         }
 
-        void focusLost(FocusChangeType cause) override
+        void restore()
         {
-            selectedItems.clear();
-            repaint();
+            history.restore();
+            update();
         }
 
         void copySelectionToClipboard()
         {
+            SmallArray<uint64> lines;
+            for (auto const line : selectedLines) {
+                if (line >= history.getFirstLine())
+                    lines.add(line);
+            }
+            std::sort(lines.begin(), lines.end());
+
             String textToCopy;
-            for (auto& item : selectedItems) {
-                if (!item.getComponent())
-                    continue;
-                textToCopy += std::get<1>(pd->getConsoleMessages()[item->idx]) + "\n";
+            for (auto const line : lines) {
+                textToCopy += history.getString(line) + "\n";
             }
 
             SystemClipboard::copyTextToClipboard(textToCopy.trimEnd());
         }
 
+        void focusLost(FocusChangeType cause) override
+        {
+            selectedLines.clear();
+            repaint();
+        }
+
         bool keyPressed(KeyPress const& key) override
         {
             // Copy from console
@@ -366,116 +302,191 @@ public:
                 return true;
             }
             if (key == KeyPress('a', ModifierKeys::commandModifier, 0)) {
-                for (auto& message : messages) {
-                    selectedItems.add_unique(SafePointer(message.get()));
-                    repaint();
+                for (size_t row = 0; row < view.getNumRows(); row++) {
+                    selectedLines.insert(view.getLineNumber(row));
                 }
+                repaint();
                 return true;
             }
 
             return false;
         }
 
-        void update()
+        void mouseDown(MouseEvent const& e) override
         {
-            while (messages.size() > pd->getConsoleMessages().size() || messages.size() >= 800) {
-                messages.pop_front();
+            dragStartScrollPosition = scrollPosition;
 
-                // Make sure we don't trigger a repaint for all messages when the console is full
-                for (auto const& message : messages) {
-                    message->idx--;
-                }
-            }
+            if (e.source.isTouch())
+                return;
 
-            while (messages.size() < pd->getConsoleMessages().size()) {
-                messages.push_back(std::make_unique<ConsoleMessage>(messages.size(), *this));
-            }
+            handleClick(e);
+        }
 
-            setSize(getWidth(), std::max<int>(getTotalHeight(), viewport.getHeight()));
-            resized();
+        void mouseDrag(MouseEvent const& e) override
+        {
+            if (e.source.isTouch())
+                setScrollPosition(dragStartScrollPosition - e.getDistanceFromDragStartY());
+        }
 
-            if (getValue<bool>(settingsValues[4])) {
-                viewport.setViewPositionProportionately(0.0f, 1.0f);
-            }
+        void mouseUp(MouseEvent const& e) override
+        {
+            if (!e.source.isTouch() || e.mouseWasDraggedSinceMouseDown())
+                return;
+
+            handleClick(e);
         }
 
-        void clear()
+        void mouseWheelMove(MouseEvent const& e, MouseWheelDetails const& wheel) override
         {
-            pd->getConsoleHistory().insert(pd->getConsoleHistory().end(), pd->getConsoleMessages().begin(), pd->getConsoleMessages().end());
-            pd->getConsoleMessages().clear();
-            update();
+            setScrollPosition(scrollPosition - wheel.deltaY * 256.0);
         }
 
-        void restore()
+        void scrollBarMoved(ScrollBar*, double const newRangeStart) override
         {
-            pd->getConsoleMessages().insert(pd->getConsoleMessages().begin(), pd->getConsoleHistory().begin(), pd->getConsoleHistory().end());
-            pd->getConsoleHistory().clear();
-            update();
+            scrollPosition = newRangeStart;
+            repaint();
         }
 
-        // Get total height of messages, also taking multi-line messages into account
-        int getTotalHeight() const
+        void resized() override
         {
-            auto const showMessages = getValue<bool>(settingsValues[2]);
-            auto const showErrors = getValue<bool>(settingsValues[3]);
-            auto totalHeight = 0;
+            scrollBar.setBounds(getLocalBounds().removeFromRight(8));
+            updateScrollBar();
+        }
 
-            for (auto& [object, message, type, length, repeats] : pd->getConsoleMessages()) {
-                auto const totalLength = length + calculateRepeatOffset(repeats);
-                auto const numLines = Console::calculateNumLines(message, totalLength, getWidth());
-                auto height = numLines * 13 + 12;
+        void paint(Graphics& g) override
+        {
+            auto const top = static_cast<int64>(scrollPosition) - topMargin;
+            auto const numRows = view.getNumRows();
+            auto const rightMargin = scrollBar.isVisible() ? 13 : 11;
 
-                if ((type == 0 && !showMessages) || (type == 1 && !showErrors))
-                    continue;
+            for (auto row = view.getRowAt(top); row < numRows; row++) {
+                auto const y = static_cast<int>(view.getY(row) - top);
+                if (y >= getHeight())
+                    break;
 
-                totalHeight += std::max(0, height);
+                paintRow(g, row, { 6, y, getWidth() - rightMargin, view.getHeight(row) });
             }
-
-            return totalHeight + 8;
         }
 
-        static int calculateRepeatOffset(int const numRepeats)
+    private:
+        void paintRow(Graphics& g, size_t const row, Rectangle<int> const rowBounds)
         {
-            if (numRepeats == 0)
-                return 0;
+            auto const lineNumber = view.getLineNumber(row);
+            auto const isSelected = selectedLines.contains(lineNumber);
 
-            int const digitCount = static_cast<int>(std::log10(numRepeats)) + 1;
-            return digitCount <= 2 ? 21 : 21 + (digitCount - 2) * 10;
+            if (isSelected) {
+                // Draw selected background
+                g.setColour(PlugDataColours::sidebarActiveBackgroundColour);
+                g.fillRoundedRectangle(rowBounds.reduced(0, 1).toFloat().withTrimmedTop(0.5f), Corners::defaultCornerRadius);
+
+                // Draw connected on top
+                if (row > 0 && selectedLines.contains(view.getLineNumber(row - 1))) {
+                    g.fillRect(rowBounds.toFloat().withTrimmedBottom(5));
+
+                    g.setColour(PlugDataColours::outlineColour);
+                    g.drawLine(rowBounds.getX() + 10, rowBounds.getY(), rowBounds.getRight() - 10, rowBounds.getY());
+                }
+
+                // Draw connected on bottom
+                if (row + 1 < view.getNumRows() && selectedLines.contains(view.getLineNumber(row + 1))) {
+                    g.setColour(PlugDataColours::sidebarActiveBackgroundColour);
+                    g.fillRect(rowBounds.toFloat().withTrimmedTop(5));
+                }
+            }
+
+            auto const& line = history.getLine(lineNumber);
+            auto const textColour = line.type == 1 ? Colours::orange : PlugDataColours::sidebarTextColour;
+
+            auto bounds = rowBounds.reduced(8, 2);
+            if (line.repeats > 1) {
+                auto repeatIndicatorBounds = bounds.removeFromLeft(calculateRepeatOffset(line.repeats)).toFloat().translated(-4, 0.25);
+                repeatIndicatorBounds = repeatIndicatorBounds.withSizeKeepingCentre(repeatIndicatorBounds.getWidth(), 21);
+
+                auto circleColour = PlugDataColours::sidebarActiveBackgroundColour;
+                auto const backgroundColour = PlugDataColours::sidebarBackgroundColour;
+                auto const contrast = isSelected ? 1.5f : 0.5f;
+
+                circleColour = Colour(circleColour.getRed() + (circleColour.getRed() - backgroundColour.getRed()) * contrast,
+                    circleColour.getGreen() + (circleColour.getGreen() - backgroundColour.getGreen()) * contrast,
+                    circleColour.getBlue() + (circleColour.getBlue() - backgroundColour.getBlue()) * contrast);
+
+                g.setColour(circleColour);
+                auto const circleBounds = repeatIndicatorBounds.reduced(2);
+                g.fillRoundedRectangle(circleBounds, circleBounds.getHeight() / 2.0f);
+
+                Fonts::drawText(g, String(line.repeats), repeatIndicatorBounds, PlugDataColours::sidebarTextColour, 12, Justification::centred);
+            }
+
+            // Lines don't wrap, so their height doesn't depend on the width of the console. Text that doesn't fit is shortened
+            Fonts::drawFittedText(g, history.getString(lineNumber), bounds.translated(0, -1), textColour, line.numRows, 0.9f, 14);
         }
 
-        void mouseDown(MouseEvent const& e) override
+        void handleClick(MouseEvent const& e)
         {
-            if (!isRealClickEvent(e))
+            auto const row = view.getRowAt(static_cast<int64>(scrollPosition) - topMargin + e.y);
+            if (row >= view.getNumRows()) {
+                if (isRealClickEvent(e)) {
+                    selectedLines.clear();
+                    repaint();
+                }
                 return;
+            }
+
+            if (!e.mods.isShiftDown() && !e.mods.isCommandDown()) {
+                selectedLines.clear();
+            }
 
-            selectedItems.clear();
+            auto const lineNumber = view.getLineNumber(row);
+            if (e.mods.isPopupMenu()) {
+                PopupMenu menu;
+                menu.addItem("Copy", [this] { copySelectionToClipboard(); });
+                menu.addItem("Show origin", history.getLine(lineNumber).object != nullptr, false, [this, target = history.getLine(lineNumber).object] {
+                    auto* editor = findParentComponentOfClass<PluginEditor>();
+                    editor->highlightSearchTarget(target, true);
+                });
+                menu.showMenuAsync(PopupMenu::Options().withTargetComponent(this).withTargetScreenArea(Rectangle<int>(e.getScreenX(), e.getScreenY(), 1, 1)));
+            }
+
+            // Select everything between the last clicked line and this one
+            if (e.mods.isShiftDown() && lastClickedLine >= history.getFirstLine()) {
+                auto const lastRow = view.getRowForLine(lastClickedLine);
+                for (auto i = std::min(row, lastRow); i <= std::max(row, lastRow) && i < view.getNumRows(); i++) {
+                    selectedLines.insert(view.getLineNumber(i));
+                }
+            }
+
+            selectedLines.insert(lineNumber);
+            lastClickedLine = lineNumber;
             repaint();
         }
 
-        void resized() override
+        void setScrollPosition(double const newPosition)
         {
-            auto const showMessages = getValue<bool>(settingsValues[2]);
-            auto const showErrors = getValue<bool>(settingsValues[3]);
-
-            int totalHeight = 4;
-            for (int row = 0; row < static_cast<int>(pd->getConsoleMessages().size()); row++) {
-                if (row >= messages.size())
-                    break;
-
-                auto& [object, message, type, length, repeats] = pd->getConsoleMessages()[row];
+            auto const maxPosition = std::max(0.0, getTotalHeight() - getHeight());
+            scrollPosition = std::clamp(newPosition, 0.0, maxPosition);
+            scrollBar.setCurrentRangeStart(scrollPosition, dontSendNotification);
+            repaint();
+        }
 
-                auto const totalLength = length + calculateRepeatOffset(repeats);
-                auto const numLines = Console::calculateNumLines(message, totalLength, getWidth());
-                auto const height = numLines * 13 + 12;
+        void updateScrollBar()
+        {
+            scrollBar.setRangeLimits(0.0, std::max<double>(getTotalHeight(), getHeight()), dontSendNotification);
+            scrollBar.setCurrentRange(scrollPosition, getHeight(), dontSendNotification);
+            scrollPosition = scrollBar.getCurrentRangeStart();
+        }
 
-                if ((type == 0 && !showMessages) || (type == 1 && !showErrors))
-                    continue;
+        double getTotalHeight() const
+        {
+            return static_cast<double>(view.getTotalHeight() + topMargin + bottomMargin);
+        }
 
-                int const rightMargin = viewport.canScrollVertically() ? 13 : 11;
-                messages[row]->setBounds(6, totalHeight, getWidth() - rightMargin, height);
+        static int calculateRepeatOffset(uint32 const numRepeats)
+        {
+            if (numRepeats == 0)
+                return 0;
 
-                totalHeight += height;
-            }
+            int const digitCount = static_cast<int>(std::log10(numRepeats)) + 1;
+            return digitCount <= 2 ? 21 : 21 + (digitCount - 2) * 10;
         }
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConsoleComponent)
@@ -496,28 +507,19 @@ public:
         return std::unique_ptr<TextButton>(settingsCalloutButton);
     }
 
-    static int calculateNumLines(String const& message, int const length, int maxWidth)
+private:
+    void timerCallback() override
     {
-        maxWidth -= 38.0f;
-        if (message.containsAnyOf("\n\r") && message.containsNonWhitespaceChars()) {
-            int numLines = 0;
-            for (auto line : StringArray::fromLines(message)) {
-                numLines++;
-                int lineWidth = CachedStringWidth<14>::calculateSingleLineWidth(line);
-                while (lineWidth > maxWidth && numLines < 64) {
-                    lineWidth -= maxWidth;
-                    numLines++;
-                }
-            }
-            return numLines;
-        }
-        if (length == 0)
-            return 0;
-        return std::max<int>(round(static_cast<float>(length) / maxWidth), 1);
+        update();
+    }
+
+    void updateFilter()
+    {
+        console.setFilter(filterInput.getText(), getValue<bool>(settingsValues[2]), getValue<bool>(settingsValues[3]));
+        update();
     }
 
-private:
     StackArray<Value, 5> settingsValues;
-    ConsoleComponent* console;
-    BouncingViewport viewport;
+    SearchEditor filterInput;
+    ConsoleComponent console;
 };
@@ -89,8 +89,7 @@ public:
     DocumentationBrowserUpdateThread()
         : Thread("Documentation Browser Thread")
     {
-        fsWatcher.removeAllFolders();
-        fsWatcher.addFolder(File(SettingsFile::getInstance()->getProperty<String>("browser_path")));
+        watchBrowserPath();
         fsWatcher.addListener(this);
 
         update();
@@ -128,13 +127,40 @@ private:
     static inline auto const pathIdentifier = Identifier("Path");
     static inline auto const iconIdentifier = Identifier("Icon");
 
-    ValueTree generateDirectoryValueTree(File const& directory)
+    static File getBrowserPath()
+    {
+        return File(SettingsFile::getInstance()->getProperty<String>("browser_path"));
+    }
+
+    // Folders in the app data directory that aren't documentation
+    static bool isExcluded(File const& directory)
     {
         static File versionDataDir = ProjectInfo::appDataDir.getChildFile("Versions");
         static File toolchainDir = ProjectInfo::appDataDir.getChildFile("Toolchain");
         static File libraryDir = ProjectInfo::appDataDir.getChildFile("Library");
 
-        if (threadShouldExit() || directory == versionDataDir || directory == toolchainDir || directory == libraryDir) {
+        return directory == versionDataDir || directory == toolchainDir || directory == libraryDir;
+    }
+
+    // The browser path can be any folder, like the home folder, so we don't watch everything inside it
+    // We watch the folder itself and the folders directly inside it, which is where documentation and patches get added
+    // Changes that are deeper down show up the next time the tree gets rebuilt
+    void watchBrowserPath()
+    {
+        auto const browserPath = getBrowserPath();
+
+        fsWatcher.removeAllFolders();
+        fsWatcher.addFolder(browserPath, false);
+
+        for (auto const& subDirectory : OSUtils::iterateDirectory(browserPath, false, false)) {
+            if (OSUtils::isDirectoryFast(subDirectory.getFullPathName()) && !isExcluded(subDirectory))
+                fsWatcher.addFolder(subDirectory, false);
+        }
+    }
+
+    ValueTree generateDirectoryValueTree(File const& directory)
+    {
+        if (threadShouldExit() || isExcluded(directory)) {
             return { };
         }
 
@@ -196,8 +222,7 @@ private:
     void settingsChanged(String const& name, var const& value) override
     {
         if (name == "browser_path") {
-            fsWatcher.removeAllFolders();
-            fsWatcher.addFolder(File(SettingsFile::getInstance()->getProperty<String>("browser_path")));
+            watchBrowserPath();
             update();
         }
     }
@@ -214,7 +239,7 @@ private:
 
                 ScopedTryLock const stl(fileTreeLock);
                 if (stl.isLocked()) {
-                    fileTree = generateDirectoryValueTree(File(SettingsFile::getInstance()->getProperty<String>("browser_path")));
+                    fileTree = generateDirectoryValueTree(getBrowserPath());
                     break;
                 }
                 retries++;
@@ -228,6 +253,20 @@ private:
         }
     }
 
+    void filesChanged(SmallArray<FileSystemWatcher::Change> const& changes) override
+    {
+        // Folders that were added to or removed from the top level need to be watched, or stop being watched
+        auto const browserPath = getBrowserPath();
+        for (auto const& change : changes) {
+            if (change.event != FileSystemWatcher::fileUpdated && change.file.getParentDirectory() == browserPath && !change.file.existsAsFile()) {
+                watchBrowserPath();
+                break;
+            }
+        }
+
+        triggerAsyncUpdate();
+    }
+
     void filesystemChanged() override
     {
         update();
@@ -405,23 +405,21 @@ public:
             decibelPopup.setVisible(animationFadeIn);
         });
     }
-    void audioLevelChanged(SmallArray<float> peak) override
+    void audioLevelChanged(SmallArray<StatusbarSource::ChannelLevel> const& levels) override
     {
         bool needsRepaint = false;
-        for (int i = 0; i < std::min<int>(peak.size(), 2); i++) {
+        for (int i = 0; i < std::min<int>(levels.size(), 2); i++) {
+            auto const peak = levels[i].peak;
             audioLevel[i] *= fadeFactor;
             if (peakBarsFade[i])
                 peakLevel[i] *= fadeFactor;
 
-            if (peak[i] > audioLevel[i]) {
-                audioLevel[i] = peak[i];
-                if (peak[i] >= 1.0f)
-                    clipping[i] = true;
-                else
-                    clipping[i] = false;
+            if (peak > audioLevel[i]) {
+                audioLevel[i] = peak;
+                clipping[i] = levels[i].clipped;
             }
-            if (peak[i] > peakLevel[i]) {
-                peakLevel[i] = peak[i];
+            if (peak > peakLevel[i]) {
+                peakLevel[i] = peak;
                 peakBarsFade[i] = false;
                 startTimer(i, 1700);
             }
@@ -1087,6 +1085,12 @@ public:
         updateCPUGraphLong();
         if (oldCpuUsage != cpuUsageToDraw)
             repaint();
+
+        // Objects that read state from pd, like scopes, hold the audio lock while the GUI polls them
+        if (auto* editor = findParentComponentOfClass<PluginEditor>()) {
+            auto const lockHoldTime = editor->pollScheduler.takeMaxLockHoldTime();
+            setTooltip("CPU usage\nGUI polling held the audio lock for up to " + String(lockHoldTime, 2) + " ms");
+        }
     }
 
     void mouseDown(MouseEvent const& e) override
@@ -1622,7 +1626,7 @@ void StatusbarSource::process(MidiBuffer const& midiInput, MidiBuffer const& mid
 
 void StatusbarSource::prepareToPlay(int const nChannels)
 {
-    peakBuffer.reset(sampleRate, nChannels);
+    levelMeter.reset(nChannels);
 }
 
 void StatusbarSource::timerCallback()
@@ -1660,10 +1664,10 @@ void StatusbarSource::timerCallback()
             listener->audioProcessedChanged(hasProcessedAudio);
     }
 
-    auto const peak = peakBuffer.getPeak();
+    auto const& levels = levelMeter.read();
 
     for (auto* listener : listeners) {
-        listener->audioLevelChanged(peak);
+        listener->audioLevelChanged(levels);
         listener->cpuUsageChanged(cpuUsage.load());
     }
 }
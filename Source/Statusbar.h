@@ -10,6 +10,7 @@
 
 #include "LookAndFeel.h"
 #include "Utility/SettingsFile.h"
+#include "Utility/SeqLock.h"
 #include "Utility/ModifierKeyListener.h"
 #include "Components/Buttons.h"
 
@@ -25,6 +26,13 @@ class StatusbarTextButton;
 class StatusbarSource final : public Timer {
 
 public:
+    // Level of one output channel, measured over all blocks since the previous timer callback
+    struct ChannelLevel {
+        float peak = 0.0f;
+        float rms = 0.0f;
+        bool clipped = false;
+    };
+
     struct Listener {
         virtual ~Listener() = default;
         virtual void midiReceivedChanged(bool midiReceived) { ignoreUnused(midiReceived); }
@@ -32,7 +40,7 @@ public:
         virtual void midiMessageReceived(MidiMessage const& message) { ignoreUnused(message); }
         virtual void midiMessageSent(MidiMessage const& message) { ignoreUnused(message); }
         virtual void audioProcessedChanged(bool audioProcessed) { ignoreUnused(audioProcessed); }
-        virtual void audioLevelChanged(SmallArray<float> peak) { ignoreUnused(peak); }
+        virtual void audioLevelChanged(SmallArray<ChannelLevel> const& levels) { ignoreUnused(levels); }
         virtual void cpuUsageChanged(float newCpuUsage) { ignoreUnused(newCpuUsage); }
         virtual void timerCallback() { }
     };
@@ -54,74 +62,111 @@ public:
 
     void setCPUUsage(float cpuUsage);
 
-    class AudioPeakMeter {
+    // Measures the level of every output channel on the audio thread, so only a few numbers per channel reach the message thread
+    // Levels are accumulated until the message thread has read them, so peaks between two frames aren't missed
+    class AudioLevelMeter {
     public:
-        AudioPeakMeter() = default;
+        AudioLevelMeter() = default;
 
-        void reset(double const sourceSampleRate, int const numChannels)
+        // Not thread-safe, only call this while the audio thread isn't processing
+        void reset(int const numChannels)
         {
-            // Calculate the number of samples per frame
-            maxBuffersPerFrame = 1.0f / 30.0f / (64.f / sourceSampleRate);
+            channels = std::make_unique<Channel[]>(numChannels);
+            levels.resize(numChannels);
+            std::ranges::fill(levels, ChannelLevel());
+            channelCount = numChannels;
+        }
 
-            sampleQueue.clear();
-            for (int ch = 0; ch < numChannels; ch++) {
-                sampleQueue.emplace_back(maxBuffersPerFrame * 4);
-            }
+        // Called on the audio thread for every block
+        void write(AudioBuffer<float> const& buffer)
+        {
+            auto const generation = readGeneration.load(std::memory_order_acquire);
+            auto const numSamples = buffer.getNumSamples();
+            for (int ch = 0; ch < std::min(channelCount, buffer.getNumChannels()); ch++) {
+                auto& channel = channels[ch];
+
+                // The message thread has read the levels, start measuring again
+                if (channel.generation != generation) {
+                    channel.peak = 0.0f;
+                    channel.sumOfSquares = 0.0;
+                    channel.numSamples = 0;
+                    channel.generation = generation;
+                }
+
+                auto const* samples = buffer.getReadPointer(ch);
+                auto const range = FloatVectorOperations::findMinAndMax(samples, numSamples);
+                channel.peak = std::max({ channel.peak, -range.getStart(), range.getEnd() });
+                channel.sumOfSquares += getSumOfSquares(samples, numSamples);
+                channel.numSamples += numSamples;
 
-            lastPeak.resize(numChannels, 0);
+                auto const rms = channel.numSamples ? static_cast<float>(std::sqrt(channel.sumOfSquares / static_cast<double>(channel.numSamples))) : 0.0f;
+                channel.published.store({ { channel.peak, rms, channel.peak >= 1.0f }, generation });
+            }
         }
 
-        void write(AudioBuffer<float> const& samples)
+        // Called on the message thread, returns the levels since the last call
+        // If the audio thread didn't process anything in the meantime, the previous levels are returned again
+        SmallArray<ChannelLevel> const& read()
         {
-            for (int ch = 0; ch < std::min<int>(sampleQueue.size(), samples.getNumChannels()); ch++) {
-                int index = 0;
-                StackArray<float, 64> sampleBuffer;
-                for (int i = 0; i < samples.getNumSamples(); i++) {
-                    sampleBuffer[index] = samples.getSample(ch, i);
-                    index++;
-                    if (index >= 64) {
-                        if (!sampleQueue[ch].try_enqueue(sampleBuffer)) {
-                            break;
-                        }
-                        index = 0;
-                    }
-                }
+            auto const generation = readGeneration.load(std::memory_order_relaxed);
+            for (int ch = 0; ch < channelCount; ch++) {
+                auto const published = channels[ch].published.load();
+                if (published.generation == generation)
+                    levels[ch] = published.level;
             }
+            readGeneration.store(generation + 1, std::memory_order_release);
+            return levels;
         }
 
-        SmallArray<float> getPeak()
+        // Eight independent sums, so the compiler can keep them in one vector register without reordering additions
+        static double getSumOfSquares(float const* samples, int const numSamples)
         {
-            SmallArray<float> peak;
-            peak.resize(sampleQueue.size());
-
-            for (int ch = 0; ch < sampleQueue.size(); ch++) {
-                StackArray<float, 64> sampleBuffer;
-                float magnitude = 0.0f;
-                int foundSamples = 0;
-                while (sampleQueue[ch].try_dequeue(sampleBuffer)) {
-                    for (int i = 0; i < 64; i++) {
-                        magnitude = std::max(magnitude, sampleBuffer[i]);
-                    }
-                    // We receive about 22 buffers per frame, so stop after that so we don't starve the next dequeue
-                    // Only keep on reading if we need to "Catch up"
-                    if (foundSamples > maxBuffersPerFrame && sampleQueue[ch].size_approx() < maxBuffersPerFrame / 2)
-                        break;
-                    foundSamples++;
+            constexpr int numLanes = 8;
+            float sums[numLanes] = {};
+
+            int i = 0;
+            for (; i + numLanes <= numSamples; i += numLanes) {
+                for (int lane = 0; lane < numLanes; lane++) {
+                    sums[lane] += samples[i + lane] * samples[i + lane];
                 }
-                peak[ch] = foundSamples ? magnitude : lastPeak[ch];
-                lastPeak[ch] = peak[ch];
+            }
+            for (; i < numSamples; i++) {
+                sums[0] += samples[i] * samples[i];
             }
 
-            return peak;
+            double sum = 0.0;
+            for (auto const laneSum : sums) {
+                sum += laneSum;
+            }
+            return sum;
         }
 
     private:
-        SmallArray<float> lastPeak;
-        HeapArray<moodycamel::ReaderWriterQueue<StackArray<float, 64>>> sampleQueue;
-        int maxBuffersPerFrame;
+        struct PublishedLevel {
+            ChannelLevel level;
+            uint32 generation;
+        };
+
+        struct Channel {
+            // Only used by the audio thread
+            float peak = 0.0f;
+            double sumOfSquares = 0.0;
+            int64 numSamples = 0;
+            uint32 generation = 0;
+
+            SeqLock<PublishedLevel> published;
+        };
+
+        std::unique_ptr<Channel[]> channels;
+        int channelCount = 0;
+
+        // Bumped by the message thread every time it reads the levels
+        std::atomic<uint32> readGeneration = 0;
+
+        SmallArray<ChannelLevel> levels;
     };
 
-    AudioPeakMeter peakBuffer;
+    AudioLevelMeter levelMeter;
 
 private:
     AtomicValue<int, Relaxed> lastMidiReceivedTime = 0;
@@ -0,0 +1,65 @@
+/*
+ // Copyright (c) 2025 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+
+// Fixed size set of flags that any thread can set, and one thread can consume, without locking
+// Used to tell the audio thread which items changed, so it doesn't have to look at the ones that didn't
+template<size_t NumBits>
+class AtomicBitSet {
+public:
+    void set(size_t const index)
+    {
+        words[index / bitsPerWord].fetch_or(uint64_t(1) << (index % bitsPerWord), std::memory_order_release);
+    }
+
+    void clear(size_t const index)
+    {
+        words[index / bitsPerWord].fetch_and(~(uint64_t(1) << (index % bitsPerWord)), std::memory_order_relaxed);
+    }
+
+    // Clears a flag, and returns whether it was set
+    bool testAndClear(size_t const index)
+    {
+        auto const mask = uint64_t(1) << (index % bitsPerWord);
+        return words[index / bitsPerWord].fetch_and(~mask, std::memory_order_acquire) & mask;
+    }
+
+    bool any() const
+    {
+        for (auto const& word : words) {
+            if (word.load(std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    // Clears all flags, and calls the callback with the index of every flag that was set
+    template<typename Callback>
+    void consume(Callback&& callback)
+    {
+        for (size_t i = 0; i < numWords; i++) {
+            if (!words[i].load(std::memory_order_relaxed))
+                continue;
+
+            auto bits = words[i].exchange(0, std::memory_order_acquire);
+            while (bits) {
+                auto const bit = static_cast<size_t>(std::countr_zero(bits));
+                callback(i * bitsPerWord + bit);
+                bits &= bits - 1;
+            }
+        }
+    }
+
+private:
+    static constexpr size_t bitsPerWord = 64;
+    static constexpr size_t numWords = (NumBits + bitsPerWord - 1) / bitsPerWord;
+
+    std::atomic<uint64_t> words[numWords] = {};
+};
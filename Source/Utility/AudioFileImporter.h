@@ -0,0 +1,174 @@
+/*
+ // Copyright (c) 2025 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include "Pd/Instance.h"
+#include "Utility/MinMaxPyramid.h"
+
+// Imports an audio file into a Pd array on a background thread
+// The file is decoded (and optionally resampled to Pd's sample rate) in blocks, and every block is written to the array in
+// small slices, each under its own short Pd lock, so the audio thread never waits long. The min/max pyramid for drawing
+// the array is filled in the same pass, so the array doesn't need to read all samples back from Pd once we're done
+class AudioFileImporter final : public Thread
+    , private AsyncUpdater {
+public:
+    // Limit to a sane maximum so we never allocate gigabytes
+    static constexpr int maxSamples = 1 << 24; // ~16 M samples
+
+    static constexpr int decodeBlockSize = 65536;
+    static constexpr int commitSliceSize = 8192;
+
+    struct Options {
+        int channel = 0;
+        bool resampleToPd = true;
+    };
+
+    AudioFileImporter(pd::WeakReference array, File file, Options const options)
+        : Thread("Audio File Importer")
+        , garray(std::move(array))
+        , audioFile(std::move(file))
+        , importOptions(options)
+    {
+    }
+
+    ~AudioFileImporter() override
+    {
+        cancelPendingUpdate();
+        stopThread(-1);
+    }
+
+    void cancel()
+    {
+        signalThreadShouldExit();
+    }
+
+    float getProgress() const
+    {
+        return progress.load();
+    }
+
+    // Both are called on the message thread
+    std::function<void(float)> onProgress = [](float) { };
+    std::function<void(bool)> onFinished = [](bool) { };
+
+    // Once the import has completed, these contain the samples that were written to the array
+    HeapArray<float> samples;
+    MinMaxPyramid pyramid;
+
+private:
+    void run() override
+    {
+        finish(importFile());
+    }
+
+    bool importFile()
+    {
+        AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(audioFile));
+        if (!reader || reader->lengthInSamples <= 0 || reader->numChannels == 0)
+            return false;
+
+        double pdSampleRate;
+        if (auto ptr = garray.get<t_garray>()) {
+            pdSampleRate = sys_getsr();
+        } else {
+            return false;
+        }
+
+        auto const numChannels = static_cast<int>(reader->numChannels);
+        auto const channel = std::clamp(importOptions.channel, 0, numChannels - 1);
+        auto const ratio = importOptions.resampleToPd && pdSampleRate > 0 && reader->sampleRate > 0 ? reader->sampleRate / pdSampleRate : 1.0;
+        auto const numSamples = static_cast<int>(std::min<int64>(std::ceil(static_cast<double>(reader->lengthInSamples) / ratio), maxSamples));
+
+        samples.resize(static_cast<size_t>(numSamples));
+        pyramid.resize(static_cast<size_t>(numSamples));
+
+        if (auto ptr = garray.get<t_garray>()) {
+            garray_resize_long(ptr.get(), static_cast<long>(numSamples));
+        } else {
+            return false;
+        }
+
+        AudioFormatReaderSource readerSource(reader.get(), false);
+        ResamplingAudioSource resampler(&readerSource, false, numChannels);
+        resampler.setResamplingRatio(ratio);
+
+        auto& source = ratio != 1.0 ? static_cast<AudioSource&>(resampler) : static_cast<AudioSource&>(readerSource);
+        source.prepareToPlay(decodeBlockSize, pdSampleRate);
+
+        AudioBuffer<float> buffer(numChannels, decodeBlockSize);
+
+        int position = 0;
+        while (position < numSamples && !threadShouldExit()) {
+            auto const blockSize = std::min(decodeBlockSize, numSamples - position);
+            source.getNextAudioBlock(AudioSourceChannelInfo(&buffer, 0, blockSize));
+            std::copy_n(buffer.getReadPointer(channel), blockSize, samples.data() + position);
+
+            for (int sliceStart = position; sliceStart < position + blockSize; sliceStart += commitSliceSize) {
+                auto const sliceEnd = std::min(sliceStart + commitSliceSize, position + blockSize);
+
+                auto ptr = garray.get<t_garray>();
+                if (!ptr)
+                    return false;
+
+                // The array could have been resized from Pd in the meantime
+                auto const end = std::min(sliceEnd, garray_npoints(ptr.get()));
+                auto* words = reinterpret_cast<t_word*>(garray_vec(ptr.get()));
+                for (int i = sliceStart; i < end; i++) {
+                    words[i].w_float = samples[i];
+                }
+            }
+
+            pyramid.update(samples, position, position + blockSize);
+            position += blockSize;
+
+            progress = static_cast<float>(position) / static_cast<float>(numSamples);
+            triggerAsyncUpdate();
+        }
+
+        source.releaseResources();
+
+        // When cancelled, keep the part that was imported so far
+        if (position < numSamples) {
+            if (auto ptr = garray.get<t_garray>()) {
+                garray_resize_long(ptr.get(), static_cast<long>(position));
+            }
+            return false;
+        }
+
+        return true;
+    }
+
+    void finish(bool const completed)
+    {
+        importCompleted = completed;
+        finished = true;
+        triggerAsyncUpdate();
+    }
+
+    void handleAsyncUpdate() override
+    {
+        if (finished) {
+            // The callback is allowed to delete us, so call it from a copy
+            auto const callback = onFinished;
+            callback(importCompleted);
+            return;
+        }
+
+        onProgress(progress.load());
+    }
+
+    pd::WeakReference garray;
+    File audioFile;
+    Options importOptions;
+
+    std::atomic<float> progress = 0.0f;
+    std::atomic<bool> importCompleted = false;
+    std::atomic<bool> finished = false;
+};
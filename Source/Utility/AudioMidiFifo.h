@@ -9,9 +9,27 @@
 */
 #pragma once
 
+// Audio ring buffer with a matching ring of timestamped MIDI events, used to adapt host block sizes to Pd's block size
+// Nothing in here allocates after setSize(), so it is safe to use from the audio thread
+// MIDI events are stored with an absolute sample position, so reading a block never has to move the events that remain
+// Parameter changes are carried the same way, so [param~] sees them at the same time as the audio they belong to
 class AudioMidiFifo {
 public:
-    AudioMidiFifo(int const channels, int const maxSize)
+    struct ParameterChange {
+        int index;
+        float value;
+        int offset;     // position of the change within the block that is being read
+        int rampLength; // number of samples to move from the previous value to the new value
+    };
+
+    // What to do when the MIDI ring is full. The dropped events are counted, see getNumDroppedMidiEvents()
+    enum class MidiOverflowPolicy {
+        DropNewest,
+        DropOldest
+    };
+
+    AudioMidiFifo(int const channels, int const maxSize, MidiOverflowPolicy const policy = MidiOverflowPolicy::DropNewest)
+        : overflowPolicy(policy)
     {
         setSize(channels, maxSize);
     }
@@ -20,6 +38,7 @@ public:
     {
         fifo.setTotalSize(maxSize + 1);
         audioBuffer.setSize(channels, maxSize + 1);
+        midiStorage.resize(std::max<size_t>(minMidiStorageSize, static_cast<size_t>(maxSize + 1) * midiBytesPerSample));
 
         clear();
     }
@@ -28,18 +47,28 @@ public:
     {
         fifo.reset();
         audioBuffer.clear();
-        midiBuffer.clear();
+
+        samplesWritten = 0;
+        samplesRead = 0;
+        midiReadIndex = 0;
+        midiWriteIndex = 0;
+        midiBytesUsed = 0;
+        numDroppedMidiEvents = 0;
+        parameterReadIndex = 0;
+        numParameterChanges = 0;
     }
 
     int getNumSamplesAvailable() const { return fifo.getNumReady(); }
     int getNumSamplesFree() const { return fifo.getFreeSpace(); }
 
+    int getNumDroppedMidiEvents() const { return numDroppedMidiEvents; }
+
     void writeAudioAndMidi(dsp::AudioBlock<float> const& audioSrc, MidiBuffer const& midiSrc)
     {
         jassert(getNumSamplesFree() >= audioSrc.getNumSamples());
         jassert(audioSrc.getNumChannels() == audioBuffer.getNumChannels());
 
-        midiBuffer.addEvents(midiSrc, 0, audioSrc.getNumSamples(), fifo.getNumReady());
+        writeMidi(midiSrc, static_cast<int>(audioSrc.getNumSamples()));
 
         int start1, size1, start2, size2;
         fifo.prepareToWrite(audioSrc.getNumSamples(), start1, size1, start2, size2);
@@ -50,6 +79,7 @@ public:
             audioSrc.copyTo(audioBuffer, size1, start2, size2);
 
         fifo.finishedWrite(size1 + size2);
+        samplesWritten += size1 + size2;
     }
 
     void readAudioAndMidi(dsp::AudioBlock<float>& audioDst, MidiBuffer& midiDst)
@@ -57,12 +87,7 @@ public:
         jassert(getNumSamplesAvailable() >= audioDst.getNumSamples());
         jassert(audioDst.getNumChannels() == audioBuffer.getNumChannels());
 
-        midiDst.addEvents(midiBuffer, 0, audioDst.getNumSamples(), 0);
-
-        // Move all the remaining midi events forward by the number of samples removed
-        MidiBuffer temp;
-        temp.addEvents(midiBuffer, audioDst.getNumSamples(), fifo.getNumReady(), -audioDst.getNumSamples());
-        midiBuffer = temp;
+        readMidi(midiDst, static_cast<int>(audioDst.getNumSamples()));
 
         int start1, size1, start2, size2;
         fifo.prepareToRead(audioDst.getNumSamples(), start1, size1, start2, size2);
@@ -73,6 +98,41 @@ public:
             audioDst.copyFrom(audioBuffer, start2, size1, size2);
 
         fifo.finishedRead(size1 + size2);
+        samplesRead += size1 + size2;
+    }
+
+    // Adds a parameter change at a sample position within the next block that will be written
+    // When the ring is full, the oldest change is dropped, since a newer value for the same parameter is usually behind it
+    void writeParameterChange(int const index, float const value, int const samplePosition, int const rampLength)
+    {
+        if (numParameterChanges == parameterChanges.size()) {
+            parameterReadIndex = (parameterReadIndex + 1) % parameterChanges.size();
+            numParameterChanges--;
+        }
+
+        auto& change = parameterChanges[(parameterReadIndex + numParameterChanges) % parameterChanges.size()];
+        change.position = samplesWritten + samplePosition;
+        change.index = index;
+        change.value = value;
+        change.rampLength = rampLength;
+        numParameterChanges++;
+    }
+
+    // Calls the callback with every parameter change in the next numSamples samples
+    // Has to be called before the audio for that block is read, since positions are relative to the read position
+    template<typename Callback>
+    void readParameterChanges(int const numSamples, Callback&& callback)
+    {
+        auto const blockEnd = samplesRead + numSamples;
+        while (numParameterChanges) {
+            auto const& change = parameterChanges[parameterReadIndex];
+            if (change.position >= blockEnd)
+                break;
+
+            callback(ParameterChange { change.index, change.value, static_cast<int>(std::max<int64>(0, change.position - samplesRead)), change.rampLength });
+            parameterReadIndex = (parameterReadIndex + 1) % parameterChanges.size();
+            numParameterChanges--;
+        }
     }
 
     void writeSilence(int const numSamples)
@@ -88,6 +148,7 @@ public:
             audioBuffer.clear(start2, size2);
 
         fifo.finishedWrite(size1 + size2);
+        samplesWritten += size1 + size2;
     }
 
     void writeAudioAndMidi(AudioBuffer<float> const& audioSrc, MidiBuffer const& midiSrc)
@@ -95,7 +156,7 @@ public:
         jassert(getNumSamplesFree() >= audioSrc.getNumSamples());
         jassert(audioSrc.getNumChannels() == audioBuffer.getNumChannels());
 
-        midiBuffer.addEvents(midiSrc, 0, audioSrc.getNumSamples(), fifo.getNumReady());
+        writeMidi(midiSrc, audioSrc.getNumSamples());
 
         int start1, size1, start2, size2;
         fifo.prepareToWrite(audioSrc.getNumSamples(), start1, size1, start2, size2);
@@ -109,6 +170,7 @@ public:
         }
 
         fifo.finishedWrite(size1 + size2);
+        samplesWritten += size1 + size2;
     }
 
     void readAudioAndMidi(AudioBuffer<float>& audioDst, MidiBuffer& midiDst)
@@ -116,12 +178,7 @@ public:
         jassert(getNumSamplesAvailable() >= audioDst.getNumSamples());
         jassert(audioDst.getNumChannels() == audioBuffer.getNumChannels());
 
-        midiDst.addEvents(midiBuffer, 0, audioDst.getNumSamples(), 0);
-
-        // Move all the remaining midi events forward by the number of samples removed
-        MidiBuffer temp;
-        temp.addEvents(midiBuffer, audioDst.getNumSamples(), fifo.getNumReady(), -audioDst.getNumSamples());
-        midiBuffer = temp;
+        readMidi(midiDst, audioDst.getNumSamples());
 
         int start1, size1, start2, size2;
         fifo.prepareToRead(audioDst.getNumSamples(), start1, size1, start2, size2);
@@ -135,12 +192,155 @@ public:
         }
 
         fifo.finishedRead(size1 + size2);
+        samplesRead += size1 + size2;
     }
 
 private:
+    // Events are stored as a header followed by their data, padded to keep the next header aligned
+    // An event never wraps around the end of the ring, so it can be handed to a MidiBuffer in one piece
+    struct MidiEventHeader {
+        int64 position;
+        int32 size; // wrapMarker means the rest of the ring is unused, continue at the start
+        int32 unused;
+    };
+
+    struct ParameterChangeRecord {
+        int64 position;
+        int32 index;
+        float value;
+        int32 rampLength;
+    };
+
+    static constexpr int32 wrapMarker = -1;
+    static constexpr size_t maxParameterChanges = 1024;
+    static constexpr size_t midiAlignment = alignof(MidiEventHeader);
+    static constexpr size_t midiBytesPerSample = 8;
+    static constexpr size_t minMidiStorageSize = 16384;
+
+    static size_t getMidiRecordSize(int const size)
+    {
+        return sizeof(MidiEventHeader) + (static_cast<size_t>(size) + midiAlignment - 1) / midiAlignment * midiAlignment;
+    }
+
+    MidiEventHeader& getMidiHeader(size_t const index)
+    {
+        return *reinterpret_cast<MidiEventHeader*>(midiStorage.data() + index);
+    }
+
+    void writeMidi(MidiBuffer const& midiSrc, int const numSamples)
+    {
+        for (auto const metadata : midiSrc) {
+            if (metadata.samplePosition < 0 || metadata.samplePosition >= numSamples)
+                continue;
+
+            if (!reserveMidiRecord(getMidiRecordSize(metadata.numBytes))) {
+                numDroppedMidiEvents++;
+                continue;
+            }
+
+            auto& header = getMidiHeader(midiWriteIndex);
+            header.position = samplesWritten + metadata.samplePosition;
+            header.size = metadata.numBytes;
+            std::memcpy(midiStorage.data() + midiWriteIndex + sizeof(MidiEventHeader), metadata.data, metadata.numBytes);
+
+            auto const recordSize = getMidiRecordSize(metadata.numBytes);
+            midiWriteIndex += recordSize;
+            midiBytesUsed += recordSize;
+        }
+    }
+
+    // Makes sure the next recordSize bytes at midiWriteIndex are free, wrapping to the start of the ring if needed
+    bool reserveMidiRecord(size_t const recordSize)
+    {
+        auto const capacity = midiStorage.size();
+        if (recordSize > capacity)
+            return false;
+
+        while (true) {
+            if (midiBytesUsed == 0) {
+                // Start over at the front, so an empty ring never has to wrap
+                midiReadIndex = 0;
+                midiWriteIndex = 0;
+            }
+
+            auto const spaceAtEnd = capacity - midiWriteIndex;
+            auto const needed = spaceAtEnd >= recordSize ? recordSize : spaceAtEnd + recordSize;
+            auto const endOfData = midiReadIndex < midiWriteIndex || midiBytesUsed == 0;
+
+            // When the data wraps, we can't write past the read position
+            bool const fits = capacity - midiBytesUsed >= needed && (endOfData || midiWriteIndex + recordSize <= midiReadIndex);
+            if (fits) {
+                if (spaceAtEnd < recordSize) {
+                    if (spaceAtEnd >= sizeof(MidiEventHeader))
+                        getMidiHeader(midiWriteIndex).size = wrapMarker;
+                    midiBytesUsed += spaceAtEnd;
+                    midiWriteIndex = 0;
+                }
+                return true;
+            }
+
+            if (overflowPolicy == MidiOverflowPolicy::DropNewest)
+                return false;
+
+            popMidiEvent();
+            numDroppedMidiEvents++;
+        }
+    }
+
+    // Skips over unused space at the end of the ring, returns nullptr if there are no more events
+    MidiEventHeader* peekMidiEvent()
+    {
+        if (midiBytesUsed == 0)
+            return nullptr;
+
+        auto const spaceAtEnd = midiStorage.size() - midiReadIndex;
+        if (spaceAtEnd < sizeof(MidiEventHeader) || getMidiHeader(midiReadIndex).size == wrapMarker) {
+            midiBytesUsed -= spaceAtEnd;
+            midiReadIndex = 0;
+        }
+
+        return midiBytesUsed ? &getMidiHeader(midiReadIndex) : nullptr;
+    }
+
+    void popMidiEvent()
+    {
+        if (auto const* header = peekMidiEvent()) {
+            auto const recordSize = getMidiRecordSize(header->size);
+            midiReadIndex += recordSize;
+            midiBytesUsed -= recordSize;
+        }
+    }
+
+    void readMidi(MidiBuffer& midiDst, int const numSamples)
+    {
+        auto const blockEnd = samplesRead + numSamples;
+        while (auto const* header = peekMidiEvent()) {
+            if (header->position >= blockEnd)
+                break;
+
+            auto const* data = midiStorage.data() + midiReadIndex + sizeof(MidiEventHeader);
+            midiDst.addEvent(data, header->size, static_cast<int>(std::max<int64>(0, header->position - samplesRead)));
+            popMidiEvent();
+        }
+    }
+
     AbstractFifo fifo { 1 };
     AudioBuffer<float> audioBuffer;
-    MidiBuffer midiBuffer;
+
+    HeapArray<uint8_t> midiStorage;
+    size_t midiReadIndex = 0;
+    size_t midiWriteIndex = 0;
+    size_t midiBytesUsed = 0;
+    int numDroppedMidiEvents = 0;
+    MidiOverflowPolicy overflowPolicy;
+
+    HeapArray<ParameterChangeRecord> parameterChanges = HeapArray<ParameterChangeRecord>(maxParameterChanges);
+    size_t parameterReadIndex = 0;
+    size_t numParameterChanges = 0;
+
+    // Total number of samples that went in and out of the fifo, MIDI event positions are relative to these
+    int64 samplesWritten = 0;
+    int64 samplesRead = 0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioMidiFifo)
 };
@@ -2,57 +2,125 @@
 #include <readerwriterqueue.h>
 #include "Dialogs/Dialogs.h"
 #include "Components/BouncingViewport.h"
-
-class Autosave final : public Timer
-    , public AsyncUpdater
+#include "Utility/Decompress.h"
+#include "Pd/Interface.h"
+
+// Autosaves are written as an append-only journal of xz-compressed records, one per saved patch
+// Patches are serialised under the audio lock on the message thread, and everything after that (converting to text,
+// compressing, writing and compacting the journal) happens on the autosave thread, so autosaving never runs inside the DSP tick
+// The journal is shared by all plugin instances, the latest record for every path is kept in memory
+class Autosave final : public Thread
+    , public Timer
     , public Value::Listener {
 
-    static inline auto const autoSaveFile = ProjectInfo::appDataDir.getChildFile(".autosave");
-    static inline auto autoSaveTree = ValueTree("Autosave");
+public:
+    struct Entry {
+        String path;
+        int64 lastModified;
+        MemoryBlock compressedPatch;
+    };
+
+private:
+    static constexpr uint32 recordMagic = 0x50444a31; // "PDJ1"
+    static constexpr int maxEntries = 15;
+
+    // Rewrite the journal once it contains this many bytes more than the records we actually need
+    static constexpr int64 compactionThreshold = 4 * 1024 * 1024;
+
+    static inline auto const journalFile = ProjectInfo::appDataDir.getChildFile(".autosave_journal");
+    static inline auto const legacyAutoSaveFile = ProjectInfo::appDataDir.getChildFile(".autosave");
+
+    static inline HeapArray<Entry> entries;
+    static inline bool journalLoaded = false;
+    static inline CriticalSection journalLock;
+
     Value autosaveInterval;
     Value autosaveEnabled;
 
     PluginProcessor* pd;
-    moodycamel::ReaderWriterQueue<std::pair<String, String>> autoSaveQueue;
+
+    struct Snapshot {
+        String path;
+        int64 time;
+        t_binbuf* content;
+    };
+    moodycamel::ReaderWriterQueue<Snapshot> autoSaveQueue;
 
 public:
     explicit Autosave(PluginProcessor* procesor)
-        : pd(procesor)
+        : Thread("Autosave")
+        , pd(procesor)
     {
-        if (!autoSaveFile.existsAsFile()) {
-            autoSaveFile.create();
-        } else {
-            FileInputStream istream(autoSaveFile);
-            autoSaveTree = ValueTree::readFromStream(istream);
-            // In case something went wrong
-            if (!autoSaveTree.isValid())
-                autoSaveTree = ValueTree("Autosave");
-        }
-
         autosaveEnabled.referTo(SettingsFile::getInstance()->getPropertyAsValue("autosave_enabled"));
 
         // autosave timer trigger
         autosaveInterval.referTo(SettingsFile::getInstance()->getPropertyAsValue("autosave_interval"));
         autosaveInterval.addListener(this);
         updateAutosaveInterval();
+
+        startThread(Priority::low);
+    }
+
+    ~Autosave() override
+    {
+        signalThreadShouldExit();
+        notify();
+        waitForThreadToExit(-1);
+
+        // Anything that didn't make it into the journal still owns its binbuf
+        Snapshot snapshot;
+        while (autoSaveQueue.try_dequeue(snapshot)) {
+            binbuf_free(snapshot.content);
+        }
+    }
+
+    // Returns a copy of all autosaves, newest first
+    static HeapArray<Entry> getEntries()
+    {
+        ScopedLock lock(journalLock);
+        loadJournal();
+
+        auto result = entries;
+        std::sort(result.begin(), result.end(), [](Entry const& a, Entry const& b) {
+            return a.lastModified > b.lastModified;
+        });
+        return result;
+    }
+
+    static String decompressPatch(Entry const& entry)
+    {
+        HeapArray<uint8_t> patch;
+        if (!Decompress::extractXz(static_cast<uint8_t const*>(entry.compressedPatch.getData()), static_cast<int>(entry.compressedPatch.getSize()), patch))
+            return {};
+
+        return String::fromUTF8(reinterpret_cast<char const*>(patch.data()), static_cast<int>(patch.size()));
     }
 
     // Call this whenever we load a file
     static void checkForMoreRecentAutosave(URL const& patchUrl, PluginEditor* editor, std::function<void(URL const&, URL const&)> callback)
     {
         auto patchPath = patchUrl.getLocalFile();
-        auto lastAutoSavedPatch = autoSaveTree.getChildWithProperty("Path", patchPath.getFullPathName());
-        auto const autoSavedTime = static_cast<int64>(lastAutoSavedPatch.getProperty("LastModified"));
+
+        std::optional<Entry> lastAutoSavedPatch;
+        {
+            ScopedLock lock(journalLock);
+            loadJournal();
+            for (auto const& entry : entries) {
+                if (entry.path == patchPath.getFullPathName()) {
+                    lastAutoSavedPatch = entry;
+                    break;
+                }
+            }
+        }
+
         auto const fileChangedTime = patchPath.getLastModificationTime().toMilliseconds();
-        if (lastAutoSavedPatch.isValid() && autoSavedTime > fileChangedTime) {
-            auto const timeDescription = RelativeTime((autoSavedTime - fileChangedTime) / 1000.0f).getApproximateDescription();
+        if (lastAutoSavedPatch && lastAutoSavedPatch->lastModified > fileChangedTime) {
+            auto const timeDescription = RelativeTime((lastAutoSavedPatch->lastModified - fileChangedTime) / 1000.0f).getApproximateDescription();
 
             Dialogs::showMultiChoiceDialog(
                 &editor->openedDialog, editor, "Restore autosave?\n (last autosave is " + timeDescription + " newer)", [lastAutoSavedPatch, patchUrl, patchPath, callback, editor](int const dontUseAutosaved) {
                     if (!dontUseAutosaved) {
-                        MemoryOutputStream ostream;
-                        Base64::convertFromBase64(ostream, lastAutoSavedPatch.getProperty("Patch").toString());
-                        auto const autosavedPatch = String::fromUTF8(static_cast<char const*>(ostream.getData()), ostream.getDataSize());
+                        auto const autosavedPatch = decompressPatch(*lastAutoSavedPatch);
 
                         glob_forcefilename(editor->pd->generateSymbol(patchPath.getFileName().toRawUTF8()), editor->pd->generateSymbol(patchPath.getParentDirectory().getFullPathName().replaceCharacter('\\', '/').toRawUTF8()));
                         auto const patchFile = File::createTempFile(".pd");
@@ -87,40 +155,40 @@ private:
         if (!getValue<bool>(autosaveEnabled))
             return;
 
-        auto patches = pd->patches;
-        // Hold patches in lambda capture so refcount can't become 0 (?)
-        pd->enqueueFunctionAsync([_this = WeakReference(this), patches] {
-            if (_this) {
-                _this->pd->lockAudioThread();
-                _this->save();
-                _this->pd->unlockAudioThread();
+        // Filter out everything we don't want to save before taking the lock, so we hold it as short as possible
+        SmallArray<std::pair<pd::Patch*, String>> candidates;
+        for (auto const& patch : pd->patches) {
+            auto patchFile = patch->getPatchFile();
+
+            // Simple way to filter out plugdata default patches which we don't want to save.
+            if (!isInternalPatch(patchFile) && !patch->openInPluginMode) {
+                candidates.add({ patch.get(), patchFile.getFullPathName() });
             }
-        });
-    }
+        }
 
-    void save()
-    {
-        for (auto const& patch : pd->patches) {
-            auto const* patchPtr = patch->getPointer().get();
+        if (candidates.empty())
+            return;
+
+        auto const time = Time::currentTimeMillis();
+
+        // Only serialise to a binbuf while holding the lock, converting it to text is done on the autosave thread
+        pd->lockAudioThread();
+        for (auto& [patch, path] : candidates) {
+            auto patchPtr = patch->getPointer();
             if (!patchPtr || !patchPtr->gl_dirty)
                 continue;
 
             // Check if patch is a root canvas
             for (auto const* x = pd_getcanvaslist(); x; x = x->gl_next) {
-                if (x == patchPtr) {
-
-                    auto patchFile = patch->getPatchFile();
-
-                    // Simple way to filter out plugdata default patches which we don't want to save.
-                    if (!isInternalPatch(patchFile) && !patch->openInPluginMode) {
-                        autoSaveQueue.enqueue({ patchFile.getFullPathName(), patch->getCanvasContent() });
-                    }
-
-                    triggerAsyncUpdate();
+                if (x == patchPtr.get()) {
+                    autoSaveQueue.enqueue({ path, time, pd::Interface::getCanvasBinbuf(patchPtr.get()) });
                     break;
                 }
             }
         }
+        pd->unlockAudioThread();
+
+        notify();
     }
 
     static bool isInternalPatch(File const& patch)
@@ -129,52 +197,184 @@ private:
         return pathName.contains("Documents/plugdata/Abstractions") || pathName.contains("Documents/plugdata/Documentation") || pathName.contains("Documents/plugdata/Extra") || patch.getParentDirectory() == File::getSpecialLocation(File::tempDirectory);
     }
 
-    void handleAsyncUpdate() override
+    void run() override
     {
-        std::pair<String, String> pathAndContent;
-        while (autoSaveQueue.try_dequeue(pathAndContent)) {
-            auto& [path, content] = pathAndContent;
-
-            // Make sure we get current time in the correct format used by the OS for file modification time
-            auto tempFile = File::createTempFile("temp_time_test");
-            tempFile.create();
-            auto const time = tempFile.getCreationTime().toMilliseconds();
-            tempFile.deleteFile();
-
-            auto existingPatch = autoSaveTree.getChildWithProperty("Path", path);
-
-            if (existingPatch.isValid()) {
-                existingPatch.setProperty("Patch", Base64::toBase64(content), nullptr);
-                existingPatch.setProperty("LastModified", time, nullptr);
-            } else {
-                auto newAutoSave = ValueTree("Save");
-                newAutoSave.setProperty("Path", path, nullptr);
-                newAutoSave.setProperty("Patch", Base64::toBase64(content), nullptr);
-                newAutoSave.setProperty("LastModified", time, nullptr);
-                autoSaveTree.addChild(newAutoSave, 0, nullptr);
-
-                if (autoSaveTree.getNumChildren() > 15) {
-                    int64 oldestTime = std::numeric_limits<int64>::max();
-                    int oldestIdx = -1;
-                    int currentIdx = 0;
-                    for (auto autoSave : autoSaveTree) {
-                        auto const modifiedTime = static_cast<int64>(autoSave.getProperty("LastModified"));
-                        if (modifiedTime < oldestTime) {
-                            oldestTime = modifiedTime;
-                            oldestIdx = currentIdx;
-                        }
-                        currentIdx++;
-                    }
-                    if (oldestIdx >= 0) {
-                        autoSaveTree.removeChild(oldestIdx, nullptr);
-                    }
+        while (!threadShouldExit()) {
+            wait(-1);
+
+            Snapshot snapshot;
+            while (!threadShouldExit() && autoSaveQueue.try_dequeue(snapshot)) {
+                char* text;
+                int textSize;
+                binbuf_gettext(snapshot.content, &text, &textSize);
+                binbuf_free(snapshot.content);
+
+                MemoryBlock compressed;
+                auto const compressedOk = compress(text, static_cast<size_t>(textSize), compressed);
+                freebytes(text, static_cast<size_t>(textSize));
+
+                if (compressedOk) {
+                    ScopedLock lock(journalLock);
+                    loadJournal();
+                    appendRecord({ snapshot.path, snapshot.time, std::move(compressed) });
                 }
             }
         }
+    }
+
+    static bool compress(char const* data, size_t const size, MemoryBlock& result)
+    {
+        result.setSize(lzma_stream_buffer_bound(size));
+
+        // Autosaving should be cheap, a low preset still gets most of the way on Pd's very repetitive patch text
+        size_t outputSize = 0;
+        if (lzma_easy_buffer_encode(1, LZMA_CHECK_CRC32, nullptr, reinterpret_cast<uint8_t const*>(data), size, static_cast<uint8_t*>(result.getData()), &outputSize, result.getSize()) != LZMA_OK)
+            return false;
+
+        result.setSize(outputSize);
+        return true;
+    }
+
+    static void writeRecord(OutputStream& ostream, Entry const& entry)
+    {
+        ostream.writeInt(static_cast<int>(recordMagic));
+        ostream.writeString(entry.path);
+        ostream.writeInt64(entry.lastModified);
+        ostream.writeInt(static_cast<int>(entry.compressedPatch.getSize()));
+        ostream.writeInt(static_cast<int>(lzma_crc32(static_cast<uint8_t const*>(entry.compressedPatch.getData()), entry.compressedPatch.getSize(), 0)));
+        ostream.write(entry.compressedPatch.getData(), entry.compressedPatch.getSize());
+    }
+
+    // Adds a record to the end of the journal. Caller must hold journalLock
+    static void appendRecord(Entry entry)
+    {
+        {
+            FileOutputStream ostream(journalFile);
+            if (ostream.openedOk()) {
+                writeRecord(ostream, entry);
+                ostream.flush();
+            }
+        }
+
+        addEntry(std::move(entry));
+
+        int64 liveSize = 0;
+        for (auto const& existing : entries) {
+            liveSize += existing.compressedPatch.getSize() + existing.path.getNumBytesAsUTF8() + 32;
+        }
+
+        if (journalFile.getSize() > liveSize + compactionThreshold) {
+            compactJournal();
+        }
+    }
+
+    // Replaces the journal with one that only contains the latest record for every patch. Caller must hold journalLock
+    static void compactJournal()
+    {
+        auto const tempFile = journalFile.getSiblingFile(".autosave_journal_compacted");
+        {
+            FileOutputStream ostream(tempFile);
+            if (!ostream.openedOk())
+                return;
+
+            ostream.setPosition(0);
+            ostream.truncate();
+            for (auto const& entry : entries) {
+                writeRecord(ostream, entry);
+            }
+            ostream.flush();
+            if (ostream.getStatus().failed())
+                return;
+        }
+
+        tempFile.moveFileTo(journalFile);
+    }
+
+    static void addEntry(Entry entry)
+    {
+        for (auto& existing : entries) {
+            if (existing.path == entry.path) {
+                if (entry.lastModified >= existing.lastModified)
+                    existing = std::move(entry);
+                return;
+            }
+        }
+
+        entries.emplace_back(std::move(entry));
+
+        if (entries.size() > maxEntries) {
+            auto const oldest = std::min_element(entries.begin(), entries.end(), [](Entry const& a, Entry const& b) {
+                return a.lastModified < b.lastModified;
+            });
+            entries.erase(oldest);
+        }
+    }
+
+    // Reads the journal into memory once per process. Caller must hold journalLock
+    static void loadJournal()
+    {
+        if (journalLoaded)
+            return;
+
+        journalLoaded = true;
+
+        if (!journalFile.existsAsFile() && legacyAutoSaveFile.existsAsFile()) {
+            importLegacyAutosaves();
+            return;
+        }
+
+        // A record that was cut off by a crash ends the journal, everything before it is still good
+        bool needsCompaction = false;
+        {
+            FileInputStream istream(journalFile);
+            if (!istream.openedOk())
+                return;
+
+            while (!istream.isExhausted()) {
+                if (static_cast<uint32>(istream.readInt()) != recordMagic) {
+                    needsCompaction = true;
+                    break;
+                }
+
+                Entry entry;
+                entry.path = istream.readString();
+                entry.lastModified = istream.readInt64();
+                auto const size = istream.readInt();
+                auto const checksum = static_cast<uint32>(istream.readInt());
+
+                if (size <= 0 || size > istream.getNumBytesRemaining() || istream.readIntoMemoryBlock(entry.compressedPatch, size) != static_cast<size_t>(size)
+                    || lzma_crc32(static_cast<uint8_t const*>(entry.compressedPatch.getData()), entry.compressedPatch.getSize(), 0) != checksum) {
+                    needsCompaction = true;
+                    break;
+                }
+
+                addEntry(std::move(entry));
+            }
+        }
+
+        if (needsCompaction) {
+            compactJournal();
+        }
+    }
+
+    // Converts the old ValueTree based autosave file into a journal
+    static void importLegacyAutosaves()
+    {
+        FileInputStream istream(legacyAutoSaveFile);
+        auto const autoSaveTree = ValueTree::readFromStream(istream);
+
+        for (auto autoSave : autoSaveTree) {
+            MemoryOutputStream patch;
+            Base64::convertFromBase64(patch, autoSave.getProperty("Patch").toString());
+
+            MemoryBlock compressed;
+            if (compress(static_cast<char const*>(patch.getData()), patch.getDataSize(), compressed)) {
+                addEntry({ autoSave.getProperty("Path").toString(), static_cast<int64>(autoSave.getProperty("LastModified")), std::move(compressed) });
+            }
+        }
 
-        autoSaveFile.replaceWithText("");
-        FileOutputStream ostream(autoSaveFile);
-        autoSaveTree.writeToStream(ostream);
+        compactJournal();
+        legacyAutoSaveFile.deleteFile();
     }
 
     friend class AutosaveHistoryComponent;
@@ -184,10 +384,10 @@ private:
 class AutosaveHistoryComponent final : public Component {
     class AutoSaveHistory final : public Component {
     public:
-        AutoSaveHistory(PluginEditor* editor, ValueTree autoSaveTree)
+        AutoSaveHistory(PluginEditor* editor, Autosave::Entry autoSave)
+            : patchPath(autoSave.path)
+            , autoSave(std::move(autoSave))
         {
-            patchPath = autoSaveTree.getProperty("Path").toString();
-            patch = autoSaveTree.getProperty("Patch").toString();
 
             addAndMakeVisible(openPatch);
 
@@ -196,9 +396,7 @@ class AutosaveHistoryComponent final : public Component {
             openPatch.setColour(TextButton::buttonOnColourId, backgroundColour.contrasting(0.1f));
             openPatch.setColour(ComboBox::outlineColourId, Colours::transparentBlack);
             openPatch.onClick = [this, editor] {
-                MemoryOutputStream ostream;
-                Base64::convertFromBase64(ostream, patch);
-                auto const patch = editor->pd->loadPatch(String::fromUTF8(static_cast<char const*>(ostream.getData()), ostream.getDataSize()));
+                auto const patch = editor->pd->loadPatch(Autosave::decompressPatch(this->autoSave));
                 patch->setTitle(patchPath.fromLastOccurrenceOf("/", false, false));
                 patch->setCurrentFile(URL(patchPath));
                 editor->getTabComponent().triggerAsyncUpdate();
@@ -238,7 +436,7 @@ class AutosaveHistoryComponent final : public Component {
         }
 
         String patchPath;
-        String patch;
+        Autosave::Entry autoSave;
         TextButton openPatch = TextButton("Open");
     };
 
@@ -246,11 +444,11 @@ class AutosaveHistoryComponent final : public Component {
     public:
         explicit ContentComponent(PluginEditor* editor)
         {
-            for (auto const child : Autosave::autoSaveTree) {
-                addAndMakeVisible(histories.add(new AutoSaveHistory(editor, child)));
+            for (auto& autoSave : Autosave::getEntries()) {
+                addAndMakeVisible(histories.add(new AutoSaveHistory(editor, std::move(autoSave))));
             }
 
-            setSize(getWidth(), Autosave::autoSaveTree.getNumChildren() * 64 + 24);
+            setSize(getWidth(), histories.size() * 64 + 24);
         }
 
         void resized() override
@@ -1,11 +1,25 @@
 #pragma once
 
+// Text is laid out by JUCE, and drawn from NanoVG's glyph atlas, which is shared by all text drawn on the same context
+// Every run of glyphs with the same font and colour is one nvgText call, that adds a quad per glyph to the frame's vertex
+// buffer. Glyphs are rasterised once for each size they're drawn at, so zooming or changing the theme doesn't render
+// every object again, and objects don't need their own texture
+// Text in fonts that NanoVG doesn't have (like fonts that come with a patch) is still rendered into an image per object
 class CachedTextRender {
 public:
     CachedTextRender() = default;
 
     void renderText(NVGcontext* nvg, Rectangle<float> const& bounds, float const scale)
     {
+        if (usesGlyphAtlas) {
+            // The font could have changed since the image was rendered
+            if (image.isValid())
+                image = NVGImage();
+
+            renderTextFromAtlas(nvg, bounds, scale);
+            return;
+        }
+
         auto intBounds = bounds.toNearestInt();
         if (updateImage || !image.isValid() || lastRenderBounds != intBounds || lastScale != scale) {
             renderTextToImage(nvg, bounds, scale);
@@ -96,6 +110,7 @@ public:
 
             layout = TextLayout();
             layout.createLayout(attributedText, width);
+            updateGlyphRuns(attributedText.getText());
 
             idealHeight = layout.getHeight();
             lastWidth = cachedWidth;
@@ -111,6 +126,40 @@ public:
         return needsUpdate;
     }
 
+    void renderTextFromAtlas(NVGcontext* nvg, Rectangle<float> const& bounds, float const scale)
+    {
+        NVGScopedState scopedState(nvg);
+
+        // Same pixel grid alignment as the image, so text doesn't move when an object switches between them
+        nvgScale(nvg, 1.0f / scale, 1.0f / scale);
+        nvgTranslate(nvg, roundToInt(bounds.getX() * scale), roundToInt(bounds.getY() * scale));
+        nvgTransformQuantize(nvg);
+        nvgIntersectScissor(nvg, 0, 0, roundToInt(bounds.getWidth() * scale), roundToInt(bounds.getHeight() * scale));
+
+        // Where TextLayout::draw would put the text
+        auto const origin = Justification(Justification::centredLeft).appliedToRectangle(Rectangle<float>(layout.getWidth(), layout.getHeight()), bounds.withZeroOrigin()).getPosition();
+
+        nvgTextAlign(nvg, NVG_ALIGN_LEFT | NVG_ALIGN_BASELINE);
+        for (auto const& run : glyphRuns) {
+            auto const* text = glyphRunText.data() + run.textStart;
+            auto const x = (origin.x + run.position.x) * scale;
+            auto const y = std::round((origin.y + run.position.y) * scale);
+
+            nvgFontFace(nvg, run.fontFace);
+            nvgFontSize(nvg, run.fontSize * scale);
+            nvgFillColor(nvg, nvgColour(isSyntaxHighlighted ? run.colour : lastColour));
+
+            if (run.horizontalScale != 1.0f) {
+                NVGScopedState scaledState(nvg);
+                nvgTranslate(nvg, x, y);
+                nvgScale(nvg, run.horizontalScale, 1.0f);
+                nvgText(nvg, 0, 0, text, text + run.textLength);
+            } else {
+                nvgText(nvg, x, y, text, text + run.textLength);
+            }
+        }
+    }
+
     void renderTextToImage(NVGcontext* nvg, Rectangle<float> const& bounds, float scale)
     {
         int const width = roundToInt(bounds.getWidth() * scale);
@@ -139,6 +188,63 @@ public:
     }
 
 private:
+    // Takes the position, font and colour of every run from the layout, so drawing doesn't have to look at the layout again
+    void updateGlyphRuns(String const& text)
+    {
+        glyphRuns.clear();
+        glyphRunText.clear();
+        usesGlyphAtlas = true;
+
+        for (int i = 0; i < layout.getNumLines(); i++) {
+            auto const& line = layout.getLine(i);
+            for (auto const* run : line.runs) {
+                if (run->glyphs.isEmpty())
+                    continue;
+
+                auto const* fontFace = Fonts::getNanoVGFontFace(run->font);
+                if (!fontFace) {
+                    glyphRuns.clear();
+                    glyphRunText.clear();
+                    usesGlyphAtlas = false;
+                    return;
+                }
+
+                auto const runText = text.substring(run->stringRange.getStart(), run->stringRange.getEnd()).trimCharactersAtEnd("\r\n");
+                if (runText.isEmpty())
+                    continue;
+
+                auto const* utf8 = runText.toRawUTF8();
+                auto const length = std::strlen(utf8);
+
+                GlyphRun glyphRun;
+                glyphRun.position = line.lineOrigin + run->glyphs.getReference(0).anchor;
+                glyphRun.fontSize = run->font.getHeightInPoints();
+                glyphRun.horizontalScale = run->font.getHorizontalScale();
+                glyphRun.colour = run->colour;
+                glyphRun.fontFace = fontFace;
+                glyphRun.textStart = static_cast<uint32>(glyphRunText.size());
+                glyphRun.textLength = static_cast<uint32>(length);
+
+                glyphRunText.append(utf8, length);
+                glyphRuns.add(glyphRun);
+            }
+        }
+    }
+
+    struct GlyphRun {
+        Point<float> position;
+        float fontSize;
+        float horizontalScale;
+        Colour colour;
+        char const* fontFace;
+        uint32 textStart;
+        uint32 textLength;
+    };
+
+    SmallArray<GlyphRun, 4> glyphRuns;
+    std::string glyphRunText;
+    bool usesGlyphAtlas = false;
+
     NVGImage image;
     hash32 lastTextHash = 0;
     float lastScale = 1.0f;
@@ -0,0 +1,287 @@
+/*
+ // Copyright (c) 2025 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include "Utility/SpatialIndex.h"
+
+// Orthogonal connection router
+// Builds a sparse grid out of the edges of nearby objects and the start and end points, and runs A* over it
+// Every grid node can be passed through horizontally or vertically, and switching between the two costs a bend penalty,
+// so the router prefers paths with few corners over paths that hug every object
+// Obstacles are set once for a whole batch of connections. Routing doesn't touch any components, so it can run on any thread
+class ConnectionRouter {
+public:
+    using Path = SmallArray<Point<float>>;
+
+    // Distance that paths keep from objects
+    static constexpr float clearance = 5.0f;
+
+    // How far a path may leave the area between its start and end point to get around objects
+    static constexpr float searchMargin = 80.0f;
+
+    static constexpr float bendPenalty = 30.0f;
+
+    // Hard limits on the work done for a single connection. When we hit them, we give up and let the caller use the default path
+    static constexpr int maxGridSize = 128 * 128;
+    static constexpr int maxExpandedNodes = 16384;
+
+    void setObstacles(SmallArray<Rectangle<int>> const& objectBounds)
+    {
+        obstacleIndex.clear();
+        obstacles.clear();
+        obstacles.reserve(objectBounds.size());
+
+        for (auto const& bounds : objectBounds) {
+            obstacles.add(bounds.toFloat().expanded(clearance));
+        }
+
+        // Only index after we're done adding, so the pointers are stable
+        for (auto& obstacle : obstacles) {
+            obstacleIndex.update(&obstacle, obstacle.getSmallestIntegerContainer());
+        }
+    }
+
+    // Number of routes that gave up because they hit one of the limits above, and that didn't find any path at all
+    // The callers fall back to the default path for both
+    struct Statistics {
+        int numOverBudget = 0;
+        int numUnreachable = 0;
+    };
+
+    Statistics const& getStatistics() const { return statistics; }
+
+    // Finds a path from an outlet at start to an inlet at end. Returns an empty path if there is none within our budget
+    // The path leaves the outlet downwards and enters the inlet from above, startObject and endObject are the bounds of their objects
+    Path route(Point<float> const start, Point<float> const end, Rectangle<int> const startObject, Rectangle<int> const endObject)
+    {
+        auto const routeStart = Point<float>(start.x, std::max(start.y, startObject.toFloat().expanded(clearance).getBottom()));
+        auto const routeEnd = Point<float>(end.x, std::min(end.y, endObject.toFloat().expanded(clearance).getY()));
+        auto const searchArea = Rectangle<float>(routeStart, routeEnd).getUnion(startObject.toFloat()).getUnion(endObject.toFloat()).expanded(searchMargin);
+
+        obstacleIndex.query(searchArea.getSmallestIntegerContainer(), nearbyObstacles);
+
+        xs.clear();
+        ys.clear();
+        for (auto const* obstacle : nearbyObstacles) {
+            xs.add(obstacle->getX());
+            xs.add(obstacle->getRight());
+            ys.add(obstacle->getY());
+            ys.add(obstacle->getBottom());
+        }
+
+        for (auto const point : { routeStart, routeEnd, (routeStart + routeEnd) / 2.0f, searchArea.getTopLeft(), searchArea.getBottomRight() }) {
+            xs.add(point.x);
+            ys.add(point.y);
+        }
+
+        createGridLines(xs, searchArea.getX(), searchArea.getRight());
+        createGridLines(ys, searchArea.getY(), searchArea.getBottom());
+
+        auto const width = static_cast<int>(xs.size());
+        auto const height = static_cast<int>(ys.size());
+        if (width * height > maxGridSize) {
+            statistics.numOverBudget++;
+            return {};
+        }
+
+        markBlockedEdges(width, height);
+
+        auto const startNode = getNodeIndex(getGridLine(xs, routeStart.x), getGridLine(ys, routeStart.y), Vertical, width);
+        auto const endNode = getNodeIndex(getGridLine(xs, routeEnd.x), getGridLine(ys, routeEnd.y), Vertical, width);
+
+        if (!findShortestPath(startNode, endNode, width, height))
+            return {};
+
+        // Walk back from the end, only the points where the direction changes end up in the path
+        Path path;
+        path.add(end);
+        for (auto node = endNode; node != startNode; node = parents[node]) {
+            auto const parent = parents[node];
+            if (parent / 2 == node / 2) {
+                auto const position = node / 2;
+                path.emplace_back(xs[position % width], ys[position / width]);
+            }
+        }
+        path.add(start);
+
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    // Simple path with a single step in the middle, for when there is no better option
+    static Path getDefaultPath(Point<float> const start, Point<float> const end)
+    {
+        Path path;
+        if (end.y < start.y) {
+            int const xHalfDistance = (start.x - end.x) / 2;
+
+            path.add(start); // double to make it draggable
+            path.add(start);
+            path.emplace_back(end.x + xHalfDistance, start.y);
+            path.emplace_back(end.x + xHalfDistance, end.y);
+            path.add(end);
+            path.add(end);
+        } else {
+            int const yHalfDistance = (start.y - end.y) / 2;
+            path.add(start);
+            path.emplace_back(start.x, end.y + yHalfDistance);
+            path.emplace_back(end.x, end.y + yHalfDistance);
+            path.add(end);
+        }
+        return path;
+    }
+
+private:
+    enum Direction {
+        Vertical,
+        Horizontal
+    };
+
+    static int getNodeIndex(int const x, int const y, Direction const direction, int const width)
+    {
+        return (y * width + x) * 2 + direction;
+    }
+
+    static int getGridLine(HeapArray<float> const& lines, float const value)
+    {
+        return static_cast<int>(std::lower_bound(lines.begin(), lines.end(), value) - lines.begin());
+    }
+
+    static void createGridLines(HeapArray<float>& lines, float const min, float const max)
+    {
+        std::erase_if(lines.vector(), [min, max](float const line) { return line < min || line > max; });
+        std::sort(lines.begin(), lines.end());
+        lines.vector().erase(std::unique(lines.begin(), lines.end()), lines.end());
+    }
+
+    // Obstacles always start and end on a grid line, so an edge between two neighbouring grid lines is either completely inside or outside of an obstacle
+    void markBlockedEdges(int const width, int const height)
+    {
+        horizontalBlocked.clear();
+        verticalBlocked.clear();
+        horizontalBlocked.resize(width * height, 0);
+        verticalBlocked.resize(width * height, 0);
+
+        for (auto const* obstacle : nearbyObstacles) {
+            auto const left = getGridLine(xs, obstacle->getX());
+            auto const top = getGridLine(ys, obstacle->getY());
+
+            for (int y = top; y < height && ys[y] <= obstacle->getBottom(); y++) {
+                for (int x = left; x < width && xs[x] <= obstacle->getRight(); x++) {
+                    auto const insideX = xs[x] > obstacle->getX() && xs[x] < obstacle->getRight();
+                    auto const insideY = ys[y] > obstacle->getY() && ys[y] < obstacle->getBottom();
+
+                    if (insideY && x + 1 < width && xs[x + 1] <= obstacle->getRight())
+                        horizontalBlocked[y * width + x] = 1;
+                    if (insideX && y + 1 < height && ys[y + 1] <= obstacle->getBottom())
+                        verticalBlocked[y * width + x] = 1;
+                }
+            }
+        }
+    }
+
+    bool findShortestPath(int const startNode, int const endNode, int const width, int const height)
+    {
+        auto const numNodes = static_cast<size_t>(width * height * 2);
+        if (costs.size() < numNodes) {
+            costs.resize(numNodes);
+            parents.resize(numNodes);
+            visited.resize(numNodes, 0);
+            closed.resize(numNodes, 0);
+        }
+
+        // Stamps instead of clearing the whole grid for every connection
+        if (++currentStamp == 0) {
+            std::fill(visited.begin(), visited.end(), 0);
+            std::fill(closed.begin(), closed.end(), 0);
+            currentStamp = 1;
+        }
+
+        auto const endPosition = endNode / 2;
+        auto const endX = xs[endPosition % width];
+        auto const endY = ys[endPosition / width];
+
+        auto estimateCost = [&](int const node) {
+            auto const position = node / 2;
+            auto const distance = std::abs(xs[position % width] - endX) + std::abs(ys[position / width] - endY);
+            return distance + (node % 2 == Horizontal ? bendPenalty : 0.0f);
+        };
+
+        openNodes.clear();
+        auto visit = [&](int const node, int const parent, float const cost) {
+            if (closed[node] == currentStamp || (visited[node] == currentStamp && costs[node] <= cost))
+                return;
+
+            visited[node] = currentStamp;
+            costs[node] = cost;
+            parents[node] = parent;
+            openNodes.add({ cost + estimateCost(node), node });
+            std::push_heap(openNodes.begin(), openNodes.end(), std::greater<> {});
+        };
+
+        visit(startNode, startNode, 0.0f);
+
+        int numExpanded = 0;
+        while (openNodes.not_empty()) {
+            std::pop_heap(openNodes.begin(), openNodes.end(), std::greater<> {});
+            auto const node = openNodes.back().second;
+            openNodes.vector().pop_back();
+
+            if (closed[node] == currentStamp)
+                continue;
+
+            if (node == endNode)
+                return true;
+
+            if (++numExpanded > maxExpandedNodes) {
+                statistics.numOverBudget++;
+                return false;
+            }
+
+            closed[node] = currentStamp;
+
+            auto const cost = costs[node];
+            auto const position = node / 2;
+            auto const x = position % width;
+            auto const y = position / width;
+
+            if (node % 2 == Horizontal) {
+                visit(getNodeIndex(x, y, Vertical, width), node, cost + bendPenalty);
+
+                if (x > 0 && !horizontalBlocked[y * width + x - 1])
+                    visit(getNodeIndex(x - 1, y, Horizontal, width), node, cost + xs[x] - xs[x - 1]);
+                if (x + 1 < width && !horizontalBlocked[y * width + x])
+                    visit(getNodeIndex(x + 1, y, Horizontal, width), node, cost + xs[x + 1] - xs[x]);
+            } else {
+                visit(getNodeIndex(x, y, Horizontal, width), node, cost + bendPenalty);
+
+                if (y > 0 && !verticalBlocked[(y - 1) * width + x])
+                    visit(getNodeIndex(x, y - 1, Vertical, width), node, cost + ys[y] - ys[y - 1]);
+                if (y + 1 < height && !verticalBlocked[y * width + x])
+                    visit(getNodeIndex(x, y + 1, Vertical, width), node, cost + ys[y + 1] - ys[y]);
+            }
+        }
+
+        statistics.numUnreachable++;
+        return false;
+    }
+
+    HeapArray<Rectangle<float>> obstacles;
+    SpatialIndex<Rectangle<float>> obstacleIndex;
+    SmallArray<Rectangle<float>*> nearbyObstacles;
+
+    // Scratch buffers, kept around so routing a batch doesn't allocate for every connection
+    HeapArray<float> xs, ys;
+    HeapArray<uint8_t> horizontalBlocked, verticalBlocked;
+    HeapArray<float> costs;
+    HeapArray<int> parents;
+    HeapArray<uint32_t> visited, closed;
+    HeapArray<std::pair<float, int>> openNodes;
+    uint32_t currentStamp = 0;
+
+    Statistics statistics;
+};
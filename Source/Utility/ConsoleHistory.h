@@ -0,0 +1,342 @@
+/*
+ // Copyright (c) 2025 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "Utility/Containers.h"
+
+// Ring of printed lines, written from Pd's print hook and read on the message thread
+// Pd only prints while holding its lock, so there is only ever one writer at a time, and writing never locks or allocates
+// Lines are stored as a header followed by their text, and a line never wraps around the end of the ring
+class ConsolePrintRing {
+public:
+    static constexpr size_t capacity = 1 << 22; // 4 MB, a few seconds of printing at audio rate
+
+    // Returns false if the ring is full, the line is then dropped
+    bool write(void* object, int const type, char const* text, size_t const length)
+    {
+        auto const recordSize = getRecordSize(length);
+        if (recordSize > capacity)
+            return false;
+
+        auto const position = writePosition.load(std::memory_order_relaxed);
+        auto const offset = position % capacity;
+        auto const padding = offset + recordSize > capacity ? capacity - offset : 0;
+        if (position + padding + recordSize - readPosition.load(std::memory_order_acquire) > capacity)
+            return false;
+
+        // Tell the reader to continue at the start of the ring
+        if (padding >= sizeof(Header))
+            getHeader(offset).type = wrapMarker;
+
+        auto& header = getHeader((position + padding) % capacity);
+        header.object = object;
+        header.length = static_cast<uint32>(length);
+        header.type = static_cast<uint32>(type);
+        std::copy_n(text, length, storage.data() + (position + padding) % capacity + sizeof(Header));
+
+        writePosition.store(position + padding + recordSize, std::memory_order_release);
+        return true;
+    }
+
+    // Calls callback(object, type, text, length) for every line that was written since the last call
+    template<typename Callback>
+    int read(Callback&& callback)
+    {
+        auto position = readPosition.load(std::memory_order_relaxed);
+        auto const end = writePosition.load(std::memory_order_acquire);
+
+        int numLines = 0;
+        while (position < end) {
+            auto const offset = position % capacity;
+            if (capacity - offset < sizeof(Header) || getHeader(offset).type == wrapMarker) {
+                position += capacity - offset;
+                continue;
+            }
+
+            auto const& header = getHeader(offset);
+            callback(header.object, static_cast<int>(header.type), storage.data() + offset + sizeof(Header), static_cast<size_t>(header.length));
+            position += getRecordSize(header.length);
+            numLines++;
+        }
+
+        readPosition.store(position, std::memory_order_release);
+        return numLines;
+    }
+
+private:
+    struct Header {
+        void* object;
+        uint32 length;
+        uint32 type;
+    };
+
+    static constexpr uint32 wrapMarker = 0xFFFFFFFF;
+
+    static size_t getRecordSize(size_t const length)
+    {
+        return sizeof(Header) + (length + alignof(Header) - 1) / alignof(Header) * alignof(Header);
+    }
+
+    Header& getHeader(size_t const offset)
+    {
+        return *reinterpret_cast<Header*>(storage.data() + offset);
+    }
+
+    alignas(Header) StackArray<char, capacity> storage;
+
+    // Total number of bytes written and read, the offset in the ring is this modulo the capacity
+    std::atomic<uint64> writePosition = 0;
+    std::atomic<uint64> readPosition = 0;
+};
+
+// All console lines of a pd instance, only used on the message thread
+// Lines and their text live in two preallocated rings, so adding a line is a copy, and the oldest lines are dropped once
+// either ring is full. Every line has a number that is never reused, so views can refer to lines without copying them
+class ConsoleHistory {
+public:
+    static constexpr size_t maxLines = 1 << 20;
+    static constexpr size_t textCapacity = 1 << 26;
+    static constexpr size_t maxLineLength = 1 << 16;
+    static constexpr size_t maxRowsPerLine = 64;
+
+    struct Line {
+        void* object;
+        uint64 textStart;
+        uint32 textLength;
+        uint32 repeats;
+        uint8 type; // 0 for messages, 1 for warnings and errors
+        uint8 numRows;
+    };
+
+    // Identical consecutive lines are collapsed into one line with a repeat count
+    void add(void* object, int const type, char const* text, size_t length)
+    {
+        length = std::min(length, maxLineLength);
+
+        if (endLine > visibleStart) {
+            auto& last = getLine(endLine - 1);
+            if (last.object == object && last.type == type && last.textLength == length && std::equal(text, text + length, getText(last))) {
+                last.repeats++;
+                return;
+            }
+        }
+
+        // Lines are never split over the end of the ring, so they can be read in one piece
+        auto start = textEnd;
+        if (start % textCapacity + length > textCapacity)
+            start += textCapacity - start % textCapacity;
+
+        while (endLine > firstLine && (endLine - firstLine == maxLines || start + length > getLine(firstLine).textStart + textCapacity)) {
+            firstLine++;
+        }
+        visibleStart = std::max(visibleStart, firstLine);
+
+        std::copy_n(text, length, textStorage.get() + start % textCapacity);
+        textEnd = start + length;
+
+        auto const numRows = std::min<size_t>(std::count(text, text + length, '\n') + 1, maxRowsPerLine);
+        lines[endLine % maxLines] = { object, start, static_cast<uint32>(length), 1, static_cast<uint8>(type), static_cast<uint8>(numRows) };
+        endLine++;
+    }
+
+    // Hides all current lines, they can still be brought back with restore() until they drop out of the history
+    void clear()
+    {
+        visibleStart = endLine;
+        numResets++;
+    }
+
+    void restore()
+    {
+        visibleStart = firstLine;
+        numResets++;
+    }
+
+    Line& getLine(uint64 const lineNumber) const
+    {
+        jassert(lineNumber >= firstLine && lineNumber < endLine);
+        return lines[lineNumber % maxLines];
+    }
+
+    char const* getText(Line const& line) const
+    {
+        return textStorage.get() + line.textStart % textCapacity;
+    }
+
+    String getString(uint64 const lineNumber) const
+    {
+        auto const& line = getLine(lineNumber);
+        return String::fromUTF8(getText(line), static_cast<int>(line.textLength));
+    }
+
+    // Lines that haven't been cleared are the ones between getVisibleStart() and getEndLine()
+    uint64 getFirstLine() const { return firstLine; }
+    uint64 getVisibleStart() const { return visibleStart; }
+    uint64 getEndLine() const { return endLine; }
+
+    // Changes every time the lines were cleared or restored, so views know when to start over
+    uint32 getNumResets() const { return numResets; }
+
+private:
+    // Not value-initialised, so the operating system only has to provide the memory once it's written to
+    std::unique_ptr<Line[]> lines = std::unique_ptr<Line[]>(new Line[maxLines]);
+    std::unique_ptr<char[]> textStorage = std::unique_ptr<char[]>(new char[textCapacity]);
+
+    uint64 firstLine = 0;
+    uint64 visibleStart = 0;
+    uint64 endLine = 0;
+    uint64 textEnd = 0;
+    uint32 numResets = 0;
+};
+
+// The lines of a ConsoleHistory that pass a text and level filter, with the vertical position of each of them
+// When the filter changes, the history is scanned again in small steps, so a search over a million lines doesn't block
+// the message thread. New lines are only checked once, when they arrive
+class ConsoleView {
+public:
+    static constexpr int rowHeight = 13;
+    static constexpr int linePadding = 12;
+
+    struct Row {
+        uint64 line;
+        int64 y;
+    };
+
+    explicit ConsoleView(ConsoleHistory& consoleHistory)
+        : history(consoleHistory)
+    {
+    }
+
+    void setFilter(String const& text, bool const showMessages, bool const showErrors)
+    {
+        filterText = text.toLowerCase().toStdString();
+        showLevel[0] = showMessages;
+        showLevel[1] = showErrors;
+        reset();
+    }
+
+    // Checks lines that arrived or weren't scanned yet, for at most maxMilliseconds
+    // Returns true once all lines in the history have been checked
+    bool update(double const maxMilliseconds = 4.0)
+    {
+        if (history.getNumResets() != numResets)
+            reset();
+
+        // Forget about lines that have dropped out of the history
+        while (!rows.empty() && rows.front().line < history.getFirstLine()) {
+            rows.pop_front();
+        }
+        scanPosition = std::max(scanPosition, history.getVisibleStart());
+
+        auto const deadline = Time::getMillisecondCounterHiRes() + maxMilliseconds;
+        auto const end = history.getEndLine();
+        while (scanPosition < end) {
+            auto const stepEnd = std::min(end, scanPosition + linesPerStep);
+            for (; scanPosition < stepEnd; scanPosition++) {
+                auto const& line = history.getLine(scanPosition);
+                if (matches(line)) {
+                    auto const y = rows.empty() ? 0 : rows.back().y + getHeight(rows.back());
+                    rows.push_back({ scanPosition, y });
+                }
+            }
+
+            if (Time::getMillisecondCounterHiRes() > deadline)
+                break;
+        }
+
+        return scanPosition == end;
+    }
+
+    size_t getNumRows() const
+    {
+        return rows.size();
+    }
+
+    uint64 getLineNumber(size_t const row) const
+    {
+        return rows[row].line;
+    }
+
+    int64 getY(size_t const row) const
+    {
+        return rows[row].y - rows.front().y;
+    }
+
+    int getHeight(size_t const row) const
+    {
+        return getHeight(rows[row]);
+    }
+
+    int64 getTotalHeight() const
+    {
+        return rows.empty() ? 0 : getY(rows.size() - 1) + getHeight(rows.back());
+    }
+
+    // Returns the index of the row at y, or the number of rows if y is below the last row
+    size_t getRowAt(int64 const y) const
+    {
+        if (rows.empty())
+            return 0;
+
+        auto const origin = rows.front().y;
+        auto const it = std::partition_point(rows.begin(), rows.end(), [this, y, origin](Row const& row) {
+            return row.y - origin + getHeight(row) <= y;
+        });
+        return static_cast<size_t>(it - rows.begin());
+    }
+
+    // Returns the index of the first row at or after a line
+    size_t getRowForLine(uint64 const lineNumber) const
+    {
+        auto const it = std::partition_point(rows.begin(), rows.end(), [lineNumber](Row const& row) {
+            return row.line < lineNumber;
+        });
+        return static_cast<size_t>(it - rows.begin());
+    }
+
+private:
+    static constexpr uint64 linesPerStep = 4096;
+
+    void reset()
+    {
+        rows.clear();
+        numResets = history.getNumResets();
+        scanPosition = history.getVisibleStart();
+    }
+
+    int getHeight(Row const& row) const
+    {
+        return history.getLine(row.line).numRows * rowHeight + linePadding;
+    }
+
+    bool matches(ConsoleHistory::Line const& line) const
+    {
+        if (!showLevel[std::min<int>(line.type, 1)])
+            return false;
+
+        if (filterText.empty())
+            return true;
+
+        auto const* text = history.getText(line);
+        auto const* end = text + line.textLength;
+        return std::search(text, end, filterText.begin(), filterText.end(), [](char const a, char const b) {
+            return std::tolower(static_cast<unsigned char>(a)) == b;
+        }) != end;
+    }
+
+    ConsoleHistory& history;
+    std::deque<Row> rows;
+
+    std::string filterText;
+    bool showLevel[2] = { true, true };
+
+    uint32 numResets = 0;
+    uint64 scanPosition = 0;
+};
@@ -87,17 +87,281 @@ struct Decompress {
         return { path, linkpath };
     }
 
-    static bool extractTar(uint8_t const* data, size_t size, File const& destRoot)
+    // Pulls decompressed data out of an xz stream through a fixed size buffer, so neither the compressed nor the
+    // decompressed data ever has to fit in memory
+    class XzReader {
+    public:
+        static constexpr size_t inputBufferSize = 64 * 1024;
+        static constexpr size_t outputBufferSize = 1024 * 1024;
+
+        explicit XzReader(InputStream& source)
+            : input(source)
+            , inputBuffer(inputBufferSize)
+            , outputBuffer(outputBufferSize)
+        {
+            valid = lzma_stream_decoder(&stream, UINT64_MAX, 0) == LZMA_OK;
+        }
+
+        ~XzReader()
+        {
+            lzma_end(&stream);
+        }
+
+        // Returns up to maxSize bytes that were decoded but not read yet, or nothing at the end of the stream or on errors
+        std::span<uint8_t const> next(size_t const maxSize)
+        {
+            if (readPosition == numDecoded && !decode())
+                return {};
+
+            auto const size = std::min(maxSize, numDecoded - readPosition);
+            auto const result = std::span<uint8_t const>(outputBuffer.data() + readPosition, size);
+            readPosition += size;
+            return result;
+        }
+
+        // Reads exactly size bytes, or skips them if destination is null
+        bool read(uint8_t* destination, size_t size)
+        {
+            while (size > 0) {
+                auto const chunk = next(size);
+                if (chunk.empty())
+                    return false;
+
+                if (destination) {
+                    std::memcpy(destination, chunk.data(), chunk.size());
+                    destination += chunk.size();
+                }
+                size -= chunk.size();
+            }
+            return true;
+        }
+
+        bool skip(size_t const size)
+        {
+            return read(nullptr, size);
+        }
+
+        // True if the data is corrupt, or the decoder couldn't be created
+        bool hasFailed() const
+        {
+            return !valid;
+        }
+
+    private:
+        bool decode()
+        {
+            if (!valid || finished)
+                return false;
+
+            stream.next_out = outputBuffer.data();
+            stream.avail_out = outputBuffer.size();
+
+            while (stream.avail_out > 0) {
+                if (stream.avail_in == 0 && !input.isExhausted()) {
+                    auto const numRead = input.read(inputBuffer.data(), static_cast<int>(inputBuffer.size()));
+                    stream.next_in = inputBuffer.data();
+                    stream.avail_in = static_cast<size_t>(std::max(0, numRead));
+                }
+
+                auto const result = lzma_code(&stream, stream.avail_in == 0 ? LZMA_FINISH : LZMA_RUN);
+                if (result == LZMA_STREAM_END) {
+                    finished = true;
+                    break;
+                }
+                if (result != LZMA_OK) {
+                    valid = false;
+                    return false;
+                }
+            }
+
+            readPosition = 0;
+            numDecoded = outputBuffer.size() - stream.avail_out;
+            return numDecoded > 0;
+        }
+
+        InputStream& input;
+        lzma_stream stream = LZMA_STREAM_INIT;
+        HeapArray<uint8_t> inputBuffer;
+        HeapArray<uint8_t> outputBuffer;
+        size_t readPosition = 0;
+        size_t numDecoded = 0;
+        bool valid = false;
+        bool finished = false;
+    };
+
+    // Writes extracted files on a few background threads, while the archive is still being decoded
+    // The amount of file data waiting to be written is limited, when it's reached, the extraction waits for the writers
+    class FileWriterPool {
+    public:
+        static constexpr size_t maxBytesInFlight = 4 * 1024 * 1024;
+
+        FileWriterPool()
+            : pool(jlimit(1, 4, SystemStats::getNumCpus() - 1))
+        {
+        }
+
+        ~FileWriterPool()
+        {
+            waitUntilIdle();
+        }
+
+        void write(fs::path path, HeapArray<uint8_t> data, fs::perms const permissions)
+        {
+            auto const size = data.size();
+            while (bytesInFlight > 0 && bytesInFlight + size > maxBytesInFlight) {
+                jobFinished.wait(50);
+            }
+
+            bytesInFlight += size;
+            numPendingJobs++;
+
+            pool.addJob([this, path = std::move(path), data = std::move(data), permissions] {
+                if (!failed && !writeFile(path, data.data(), data.size(), permissions))
+                    failed = true;
+
+                bytesInFlight -= data.size();
+                numPendingJobs--;
+                jobFinished.signal();
+            });
+        }
+
+        void waitUntilIdle()
+        {
+            while (numPendingJobs > 0) {
+                jobFinished.wait(50);
+            }
+        }
+
+        bool hasFailed() const
+        {
+            return failed;
+        }
+
+    private:
+        WaitableEvent jobFinished;
+        std::atomic<size_t> bytesInFlight = 0;
+        std::atomic<int> numPendingJobs = 0;
+        std::atomic<bool> failed = false;
+
+        ThreadPool pool; // Declared last, so it waits for running jobs before anything they use is destroyed
+    };
+
+    static fs::perms getPermissions(uint8_t const* header)
     {
+        auto permissions = fs::perms::none;
+        auto const mode = std::strtoul(reinterpret_cast<char const*>(header + 100), nullptr, 8);
+
+        // Convert mode to fs::perms
+        if (mode & 0400)
+            permissions |= fs::perms::owner_read;
+        if (mode & 0200)
+            permissions |= fs::perms::owner_write;
+        if (mode & 0100)
+            permissions |= fs::perms::owner_exec;
+        if (mode & 0040)
+            permissions |= fs::perms::group_read;
+        if (mode & 0020)
+            permissions |= fs::perms::group_write;
+        if (mode & 0010)
+            permissions |= fs::perms::group_exec;
+        if (mode & 0004)
+            permissions |= fs::perms::others_read;
+        if (mode & 0002)
+            permissions |= fs::perms::others_write;
+        if (mode & 0001)
+            permissions |= fs::perms::others_exec;
+
+        return permissions;
+    }
+
+    static bool writeFile(fs::path const& path, uint8_t const* data, size_t const size, [[maybe_unused]] fs::perms const permissions)
+    {
+        try {
+            std::ofstream out(path, std::ios::binary);
+            if (!out) {
+                return false;
+            }
+
+            out.write(reinterpret_cast<char const*>(data), size);
+
+            if (!out.good()) {
+                out.close();
+                fs::remove(path); // cleanup partial file
+                return false;
+            }
+            out.close();
+
+#if !JUCE_WINDOWS
+            fs::permissions(path, permissions);
+#endif
+        } catch (fs::filesystem_error const&) {
+            return false;
+        }
+        return true;
+    }
+
+    // Writes a file that's too large to queue for the writer pool straight from the decoder
+    static bool streamFile(XzReader& reader, fs::path const& path, size_t size, [[maybe_unused]] fs::perms const permissions)
+    {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) {
+            return false;
+        }
+
+        while (size > 0) {
+            auto const chunk = reader.next(size);
+            if (chunk.empty())
+                break;
+
+            out.write(reinterpret_cast<char const*>(chunk.data()), chunk.size());
+            size -= chunk.size();
+        }
+
+        if (size > 0 || !out.good()) {
+            out.close();
+            fs::remove(path); // cleanup partial file
+            return false;
+        }
+        out.close();
+
+#if !JUCE_WINDOWS
+        fs::permissions(path, permissions);
+#endif
+        return true;
+    }
+
+    static size_t getPaddedSize(size_t const size)
+    {
+        return (size + 511) & ~static_cast<size_t>(511); // pad to next 512
+    }
+
+    // Extracts a tar.xz archive while it's being decoded
+    // Only the tar headers are parsed on this thread, file contents are handed to a pool of writers. Files above
+    // maxQueuedFileSize are written from this thread directly, so memory use stays at a few megabytes for any archive
+    static bool extractTarXz(InputStream& input, File const& destRoot)
+    {
+        static constexpr size_t maxQueuedFileSize = 1024 * 1024;
+
         // Convert destination root to fs::path
         fs::path destPath(destRoot.getFullPathName().toStdString());
 
-        size_t offset = 0;
+        XzReader reader(input);
+        FileWriterPool writers;
+
+        uint8_t header[512];
         std::string longLinkName;         // For GNU tar @@LongLink entries
         std::string paxPath, paxLinkPath; // For Pax extended headers
+        fs::path lastParentPath;          // So we don't check if the same directory exists for every file in it
+
+        auto createParentDirectory = [&lastParentPath](fs::path const& path) {
+            auto parentPath = path.parent_path();
+            if (parentPath != lastParentPath) {
+                fs::create_directories(parentPath);
+                lastParentPath = std::move(parentPath);
+            }
+        };
 
-        while (offset + 512 <= size) {
-            uint8_t const* header = data + offset;
+        while (!writers.hasFailed() && reader.read(header, sizeof(header))) {
             if (header[0] == '\0')
                 break; // End of archive
 
@@ -146,34 +410,11 @@ struct Decompress {
                 linkTarget.erase(linkTarget.find_last_not_of(" \t\n\r\f\v\0") + 1);
             }
 
-#if !JUCE_WINDOWS
-            // Get file permissions
-            auto permissions = fs::perms::none;
-            mode_t mode = static_cast<mode_t>(
-                std::strtoul(reinterpret_cast<char const*>(header + 100), nullptr, 8));
-
-            // Convert mode to fs::perms
-            if (mode & 0400)
-                permissions |= fs::perms::owner_read;
-            if (mode & 0200)
-                permissions |= fs::perms::owner_write;
-            if (mode & 0100)
-                permissions |= fs::perms::owner_exec;
-            if (mode & 0040)
-                permissions |= fs::perms::group_read;
-            if (mode & 0020)
-                permissions |= fs::perms::group_write;
-            if (mode & 0010)
-                permissions |= fs::perms::group_exec;
-            if (mode & 0004)
-                permissions |= fs::perms::others_read;
-            if (mode & 0002)
-                permissions |= fs::perms::others_write;
-            if (mode & 0001)
-                permissions |= fs::perms::others_exec;
-#endif
+            auto const permissions = getPermissions(header);
+
             // Get file size (octal)
             size_t fileSize = std::strtoull(reinterpret_cast<char const*>(header + 124), nullptr, 8);
+            size_t const padding = getPaddedSize(fileSize) - fileSize;
 
             // Determine type
             char typeFlag = header[156];
@@ -181,36 +422,32 @@ struct Decompress {
             // Handle GNU tar long link entries
             if (typeFlag == 'L') {
                 // This is a @@LongLink entry - read the long filename
-                size_t fileOffset = offset + 512;
-                if (fileOffset + fileSize <= size) {
-                    longLinkName.assign(reinterpret_cast<char const*>(data + fileOffset), fileSize);
-                    // Remove null terminator if present
-                    if (!longLinkName.empty() && longLinkName.back() == '\0') {
-                        longLinkName.pop_back();
-                    }
+                longLinkName.resize(fileSize);
+                if (!reader.read(reinterpret_cast<uint8_t*>(longLinkName.data()), fileSize) || !reader.skip(padding))
+                    return false;
+
+                // Remove null terminator if present
+                if (!longLinkName.empty() && longLinkName.back() == '\0') {
+                    longLinkName.pop_back();
                 }
-                // Skip this entry and continue
-                size_t totalEntrySize = 512 + ((fileSize + 511) & ~511);
-                offset += totalEntrySize;
                 continue;
             }
 
             // Handle PaxHeaders (POSIX extended headers)
             if (typeFlag == 'x' || name.find("PaxHeaders.") == 0) {
                 // Parse path and linkpath from Pax header
-                size_t fileOffset = offset + 512;
-                if (fileOffset + fileSize <= size) {
-                    auto [path, linkpath] = parsePaxPathAndLink(data + fileOffset, fileSize);
-                    paxPath = path;
-                    paxLinkPath = linkpath;
-                }
-                // Skip this entry and continue
-                size_t totalEntrySize = 512 + ((fileSize + 511) & ~511);
-                offset += totalEntrySize;
+                HeapArray<uint8_t> paxData(fileSize);
+                if (!reader.read(paxData.data(), fileSize) || !reader.skip(padding))
+                    return false;
+
+                auto [path, linkpath] = parsePaxPathAndLink(paxData.data(), fileSize);
+                paxPath = path;
+                paxLinkPath = linkpath;
                 continue;
             }
 
             fs::path outPath = destPath / name;
+            size_t bytesToSkip = getPaddedSize(fileSize);
 
             try {
                 if (typeFlag == '5') {
@@ -221,32 +458,25 @@ struct Decompress {
 #endif
                 } else if (typeFlag == '0' || typeFlag == '\0') {
                     // Regular file
-                    fs::create_directories(outPath.parent_path());
+                    createParentDirectory(outPath);
 
-                    std::ofstream out(outPath, std::ios::binary);
-                    if (!out) {
-                        return false;
-                    }
-
-                    size_t fileOffset = offset + 512;
-                    out.write(reinterpret_cast<char const*>(data + fileOffset), fileSize);
+                    if (fileSize > maxQueuedFileSize) {
+                        if (!streamFile(reader, outPath, fileSize, permissions))
+                            return false;
+                    } else {
+                        HeapArray<uint8_t> fileData(fileSize);
+                        if (!reader.read(fileData.data(), fileSize))
+                            return false;
 
-                    if (!out.good()) {
-                        out.close();
-                        fs::remove(outPath); // cleanup partial file
-                        return false;
+                        writers.write(std::move(outPath), std::move(fileData), permissions);
                     }
-                    out.close();
-
-#if !JUCE_WINDOWS
-                    fs::permissions(outPath, permissions);
-#endif
+                    bytesToSkip = padding;
                 }
 #if !JUCE_WINDOWS
                 else if (typeFlag == '2') {
                     // Symbolic link
                     // Ensure parent directory exists
-                    fs::create_directories(outPath.parent_path());
+                    createParentDirectory(outPath);
 
                     // Remove existing file/link if it exists
                     if (fs::exists(outPath) || fs::is_symlink(outPath)) {
@@ -258,7 +488,7 @@ struct Decompress {
                 } else if (typeFlag == '1') {
                     // Hard link
                     // Ensure parent directory exists
-                    fs::create_directories(outPath.parent_path());
+                    createParentDirectory(outPath);
 
                     // Convert relative link target to absolute path within the destination
                     fs::path targetPath;
@@ -269,6 +499,9 @@ struct Decompress {
                         targetPath = destPath / fs::path(linkTarget).relative_path();
                     }
 
+                    // The target might still be queued for writing
+                    writers.waitUntilIdle();
+
                     // Remove existing file/link if it exists
                     if (fs::exists(outPath) || fs::is_symlink(outPath)) {
                         fs::remove(outPath);
@@ -277,7 +510,6 @@ struct Decompress {
                     // Create hard link (only if target exists)
                     if (fs::exists(targetPath)) {
                         fs::create_hard_link(targetPath, outPath);
-                    } else {
                     }
                 }
 #endif
@@ -289,24 +521,17 @@ struct Decompress {
             // Clear pax linkpath after use (path is already cleared above)
             paxLinkPath.clear();
 
-            size_t totalEntrySize = 512 + ((fileSize + 511) & ~511); // pad to next 512
-            offset += totalEntrySize;
+            if (!reader.skip(bytesToSkip))
+                return false;
         }
-        return true;
+
+        writers.waitUntilIdle();
+        return !reader.hasFailed() && !writers.hasFailed();
     }
 
-    static bool extractTarXz(uint8_t const* data, int const dataSize, File const& destRoot, int const expectedSize = 0)
+    static bool extractTarXz(uint8_t const* data, size_t const dataSize, File const& destRoot)
     {
-        HeapArray<uint8_t> decompressedData;
-        if (expectedSize > 0) {
-            decompressedData.reserve(expectedSize);
-        }
-        // First decompress the XZ data
-        if (!extractXz(data, dataSize, decompressedData)) {
-            return false;
-        }
-
-        // Then extract the TAR archive
-        return extractTar(decompressedData.data(), decompressedData.size(), destRoot);
+        MemoryInputStream input(data, dataSize, false);
+        return extractTarXz(input, destRoot);
     }
 };
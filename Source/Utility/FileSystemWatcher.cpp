@@ -32,142 +32,395 @@ using namespace juce;
 #endif
 
 #ifdef JUCE_LINUX
-#    define BUF_LEN (10 * (sizeof(struct inotify_event) + NAME_MAX + 1))
-
-class FileSystemWatcher::Impl : public Thread
-    , private AsyncUpdater {
+#    include <sys/epoll.h>
+#    include <sys/eventfd.h>
+
+// A single inotify instance and thread, shared by all watchers in the process
+// Every watched folder is watched recursively (unless asked not to), and watches are added for new subfolders as they
+// appear. Events are collected per watcher, and delivered once nothing changed for debounceMs, or after maxLatencyMs
+// if changes keep coming in
+class FileSystemWatcher::Service final : public Thread {
 public:
-    struct Event {
-        Event() { }
-        Event(Event const& other) = default;
-        Event(Event&& other) = default;
-
-        File file;
-        FileSystemEvent fsEvent;
+    static constexpr int debounceMs = 50;
+    static constexpr int maxLatencyMs = 500;
 
-        bool operator==(Event const& other) const
-        {
-            return file == other.file && fsEvent == other.fsEvent;
-        }
-    };
-
-    Impl(FileSystemWatcher& o, File f)
-        : Thread("FileSystemWatcher::Impl")
-        , owner(o)
-        , folder(f)
+    Service()
+        : Thread("FileSystemWatcher")
     {
-        fd = inotify_init();
-
-        wd = inotify_add_watch(fd,
-            folder.getFullPathName().toRawUTF8(),
-            IN_ATTRIB | IN_CREATE | IN_DELETE | IN_DELETE_SELF | IN_MODIFY | IN_MOVE_SELF | IN_MOVED_TO | IN_MOVED_FROM);
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+
+        for (auto const fd : { inotifyFd, wakeFd }) {
+            epoll_event event = {};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+        }
 
         startThread();
     }
 
-    ~Impl()
+    ~Service() override
     {
-        shouldQuit = true;
         signalThreadShouldExit();
-        inotify_rm_watch(fd, wd);
-        close(fd);
+        wake();
+        stopThread(1000);
 
-        waitForThreadToExit(1000);
+        close(epollFd);
+        close(wakeFd);
+        close(inotifyFd);
     }
 
-    void run() override
-    {
-        char buf[BUF_LEN];
-        const struct inotify_event* iNotifyEvent;
-        char* ptr;
+    void addRoot(Impl* impl);
+    void removeRoot(Impl* impl);
 
-        while (!shouldQuit) {
-            struct pollfd pfd;
-            pfd.fd = fd;
-            pfd.events = POLLIN;
+private:
+    static constexpr uint32_t watchMask = IN_ATTRIB | IN_CREATE | IN_DELETE | IN_DELETE_SELF | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_MOVED_TO | IN_MOVED_FROM | IN_ONLYDIR | IN_DONT_FOLLOW;
 
-            // Poll with 100ms timeout
-            int pollResult = poll(&pfd, 1, 100);
+    void wake() const
+    {
+        uint64_t const value = 1;
+        [[maybe_unused]] auto const result = write(wakeFd, &value, sizeof(value));
+    }
+
+    void run() override
+    {
+        while (!threadShouldExit()) {
+            int timeout = -1;
+            {
+                ScopedLock sl(lock);
+                if (!pendingChanges.empty()) {
+                    auto const now = Time::getMillisecondCounter();
+                    auto const quietTime = static_cast<int>(now - lastChangeTime);
+                    auto const waitTime = static_cast<int>(now - firstChangeTime);
+                    timeout = std::max(0, std::min(debounceMs - quietTime, maxLatencyMs - waitTime));
+                }
+            }
 
+            epoll_event events[2];
+            auto const numEvents = epoll_wait(epollFd, events, 2, timeout);
             if (threadShouldExit())
-                break; // Check exit condition regularly
-
-            if (pollResult > 0 && (pfd.revents & POLLIN)) {
-                int numRead = read(fd, buf, BUF_LEN);
-                if (numRead <= 0 || threadShouldExit())
-                    break;
-
-                for (ptr = buf; ptr < buf + numRead; ptr += sizeof(struct inotify_event) + iNotifyEvent->len) {
-                    iNotifyEvent = (const struct inotify_event*)ptr;
-                    Event e;
-                    e.file = File { folder.getFullPathName() + '/' + iNotifyEvent->name };
-                    if (iNotifyEvent->mask & IN_CREATE)
-                        e.fsEvent = FileSystemEvent::fileCreated;
-                    else if (iNotifyEvent->mask & IN_CLOSE_WRITE)
-                        e.fsEvent = FileSystemEvent::fileUpdated;
-                    else if (iNotifyEvent->mask & IN_MOVED_FROM)
-                        e.fsEvent = FileSystemEvent::fileRenamedOldName;
-                    else if (iNotifyEvent->mask & IN_MOVED_TO)
-                        e.fsEvent = FileSystemEvent::fileRenamedNewName;
-                    else if (iNotifyEvent->mask & IN_DELETE)
-                        e.fsEvent = FileSystemEvent::fileDeleted;
-                    ScopedLock sl(lock);
-                    bool duplicateEvent = false;
-                    for (auto existing : events) {
-                        if (e == existing) {
-                            duplicateEvent = true;
-                            break;
-                        }
-                    }
-                    if (!duplicateEvent)
-                        events.add(std::move(e));
+                break;
+
+            for (int i = 0; i < numEvents; i++) {
+                if (events[i].data.fd == wakeFd) {
+                    uint64_t value;
+                    [[maybe_unused]] auto const result = read(wakeFd, &value, sizeof(value));
+                } else if (events[i].data.fd == inotifyFd) {
+                    readEvents();
                 }
-                ScopedLock sl(lock);
-                if (events.size() > 0)
-                    triggerAsyncUpdate();
             }
+
+            watchPendingFolders();
+            deliverChanges();
         }
     }
 
-    void handleAsyncUpdate() override
+    // Folders are only walked on this thread, so adding a big folder doesn't block the thread that added it
+    void watchPendingFolders()
     {
-        if (shouldQuit)
-            return;
+        SmallArray<FolderToWatch> folders;
+        {
+            ScopedLock sl(lock);
+            std::swap(folders, foldersToWatch);
+        }
 
-        ScopedLock sl(lock);
+        for (auto const& [folder, recursive, reportContents] : folders)
+            watchFolder(folder, recursive, reportContents);
+    }
 
-        for (auto& e : events)
-            owner.fileChanged(e.file, e.fsEvent);
+    void readEvents()
+    {
+        alignas(inotify_event) char buffer[64 * 1024];
+
+        while (true) {
+            auto const numRead = read(inotifyFd, buffer, sizeof(buffer));
+            if (numRead <= 0)
+                break;
+
+            ScopedLock sl(lock);
+            for (char* ptr = buffer; ptr < buffer + numRead;) {
+                auto const* event = reinterpret_cast<inotify_event const*>(ptr);
+                ptr += sizeof(inotify_event) + event->len;
+                handleEvent(*event);
+            }
+        }
+    }
+
+    struct FolderToWatch {
+        File folder;
+        bool recursive;
+        bool reportContents;
+    };
+
+    void handleEvent(inotify_event const& event);
+    void deliverChanges();
+    void addChange(File const& file, FileSystemEvent fsEvent);
+    void watchFolder(File const& folder, bool recursive, bool reportContents);
+    void unwatchFolder(File const& folder);
+    bool isWatchedByAnyRoot(File const& folder) const;
+    bool isWatchedRecursively(File const& folder) const;
+
+    int inotifyFd = -1;
+    int wakeFd = -1;
+    int epollFd = -1;
+
+    CriticalSection lock;
+    SmallArray<Impl*> roots;
+    SmallArray<FolderToWatch> foldersToWatch;
+    UnorderedMap<int, File> watches;
+    UnorderedMap<Impl*, SmallArray<Change>> pendingChanges;
+    uint32 firstChangeTime = 0;
+    uint32 lastChangeTime = 0;
+};
+
+class FileSystemWatcher::Impl final : private AsyncUpdater {
+public:
+    Impl(FileSystemWatcher& o, File f, bool const isRecursive)
+        : owner(o)
+        , folder(std::move(f))
+        , recursive(isRecursive)
+    {
+        service->addRoot(this);
+    }
 
-        events.clear();
+    ~Impl() override
+    {
+        service->removeRoot(this);
+        cancelPendingUpdate();
+    }
+
+    // Called by the service, with its lock held
+    void addChanges(SmallArray<Change> const& changes)
+    {
+        ScopedLock sl(lock);
+        for (auto& change : changes)
+            events.add_unique(change);
+
+        triggerAsyncUpdate();
     }
 
-    std::atomic<bool> shouldQuit = false;
     FileSystemWatcher& owner;
-    File folder;
+    File const folder;
+    bool const recursive;
 
-    CriticalSection lock;
-    SmallArray<Event> events;
+private:
+    void handleAsyncUpdate() override
+    {
+        SmallArray<Change> changes;
+        {
+            ScopedLock sl(lock);
+            std::swap(changes, events);
+        }
 
-    int fd;
-    int wd;
+        owner.filesChanged(changes);
+    }
+
+    SharedResourcePointer<Service> service;
+
+    CriticalSection lock;
+    SmallArray<Change> events;
 };
 
-#elif JUCE_WINDOWS
-class FileSystemWatcher::Impl : private AsyncUpdater
-    , private Thread {
-public:
-    struct Event {
-        File file;
-        FileSystemEvent fsEvent;
+void FileSystemWatcher::Service::addRoot(Impl* impl)
+{
+    {
+        ScopedLock sl(lock);
+        roots.add(impl);
+        foldersToWatch.add({ impl->folder, impl->recursive, false });
+    }
+
+    wake();
+}
+
+void FileSystemWatcher::Service::removeRoot(Impl* impl)
+{
+    ScopedLock sl(lock);
+    roots.remove_one(impl);
+    pendingChanges.erase(impl);
+
+    // Stop watching folders that no other watcher is interested in
+    for (auto it = watches.begin(); it != watches.end();) {
+        if (!isWatchedByAnyRoot(it->second)) {
+            inotify_rm_watch(inotifyFd, it->first);
+            it = watches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool FileSystemWatcher::Service::isWatchedByAnyRoot(File const& folder) const
+{
+    for (auto const* root : roots) {
+        if (folder == root->folder || (root->recursive && folder.isAChildOf(root->folder)))
+            return true;
+    }
+    return false;
+}
+
+bool FileSystemWatcher::Service::isWatchedRecursively(File const& folder) const
+{
+    for (auto const* root : roots) {
+        if (root->recursive && (folder == root->folder || folder.isAChildOf(root->folder)))
+            return true;
+    }
+    return false;
+}
+
+// Watcher thread only. The lock is only taken to record each watch, so adding and removing roots doesn't wait for the walk
+void FileSystemWatcher::Service::watchFolder(File const& folder, bool const recursive, bool const reportContents)
+{
+    SmallArray<File> folders = { folder };
+    SmallArray<File> contents;
+    while (folders.not_empty()) {
+        auto const current = folders.back();
+        folders.pop_back();
+
+        if (isIgnored(current))
+            continue;
+
+        auto const wd = inotify_add_watch(inotifyFd, current.getFullPathName().toRawUTF8(), watchMask);
+        if (wd < 0)
+            continue;
 
-        bool operator==(Event const& other) const
         {
-            return file == other.file && fsEvent == other.fsEvent;
+            // The root might have been removed while we were walking it
+            ScopedLock sl(lock);
+            if (!isWatchedByAnyRoot(current)) {
+                if (watches.find(wd) == watches.end())
+                    inotify_rm_watch(inotifyFd, wd);
+                continue;
+            }
+
+            watches[wd] = current;
         }
-    };
 
-    Impl(FileSystemWatcher& o, File f)
+        if (!recursive && !reportContents)
+            continue;
+
+        // Files that were created in a new folder before we started watching it won't get their own events
+        contents.clear();
+        for (auto const& entry : RangedDirectoryIterator(current, false, "*", File::findFilesAndDirectories | File::ignoreHiddenFiles)) {
+            auto const& file = entry.getFile();
+            if (reportContents)
+                contents.add(file);
+
+            if (recursive && entry.isDirectory() && !file.isSymbolicLink())
+                folders.add(file);
+        }
+
+        if (contents.not_empty()) {
+            ScopedLock sl(lock);
+            for (auto const& file : contents)
+                addChange(file, fileCreated);
+        }
+    }
+}
+
+void FileSystemWatcher::Service::unwatchFolder(File const& folder)
+{
+    for (auto it = watches.begin(); it != watches.end();) {
+        if (it->second == folder || it->second.isAChildOf(folder)) {
+            inotify_rm_watch(inotifyFd, it->first);
+            it = watches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void FileSystemWatcher::Service::handleEvent(inotify_event const& event)
+{
+    // The kernel dropped events, so we don't know what changed. Report the watched folders themselves as updated
+    if (event.mask & IN_Q_OVERFLOW) {
+        for (auto const* root : roots)
+            addChange(root->folder, fileUpdated);
+        return;
+    }
+
+    auto const it = watches.find(event.wd);
+    if (it == watches.end())
+        return;
+
+    if (event.mask & IN_IGNORED) {
+        watches.erase(it);
+        return;
+    }
+
+    auto const folder = it->second;
+    auto const file = event.len > 0 ? folder.getChildFile(String::fromUTF8(event.name)) : folder;
+
+    FileSystemEvent fsEvent;
+    if (event.mask & IN_CREATE)
+        fsEvent = fileCreated;
+    else if (event.mask & (IN_CLOSE_WRITE | IN_ATTRIB))
+        fsEvent = fileUpdated;
+    else if (event.mask & IN_MOVED_FROM)
+        fsEvent = fileRenamedOldName;
+    else if (event.mask & IN_MOVED_TO)
+        fsEvent = fileRenamedNewName;
+    else if (event.mask & IN_DELETE)
+        fsEvent = fileDeleted;
+    else if (event.mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+        // Subfolders are reported by their parent already, only report the watched folders themselves
+        for (auto const* root : roots) {
+            if (root->folder == folder) {
+                addChange(folder, fileDeleted);
+                break;
+            }
+        }
+        return;
+    } else
+        return;
+
+    addChange(file, fsEvent);
+
+    // Start watching new subfolders, and everything that was created in them before we got here
+    if ((event.mask & IN_ISDIR) && (event.mask & (IN_CREATE | IN_MOVED_TO)) && isWatchedRecursively(folder))
+        foldersToWatch.add({ file, true, true });
+
+    // Watches follow the folder when it's moved, so their paths would be wrong from now on
+    if ((event.mask & IN_ISDIR) && (event.mask & IN_MOVED_FROM))
+        unwatchFolder(file);
+}
+
+void FileSystemWatcher::Service::addChange(File const& file, FileSystemEvent const fsEvent)
+{
+    auto const now = Time::getMillisecondCounter();
+    if (pendingChanges.empty())
+        firstChangeTime = now;
+    lastChangeTime = now;
+
+    for (auto* root : roots) {
+        auto const isInRoot = root->recursive ? file.isAChildOf(root->folder) : file.getParentDirectory() == root->folder;
+        if (file == root->folder || isInRoot)
+            pendingChanges[root].add_unique({ file, fsEvent });
+    }
+}
+
+void FileSystemWatcher::Service::deliverChanges()
+{
+    ScopedLock sl(lock);
+    if (pendingChanges.empty())
+        return;
+
+    auto const now = Time::getMillisecondCounter();
+    if (static_cast<int>(now - lastChangeTime) < debounceMs && static_cast<int>(now - firstChangeTime) < maxLatencyMs)
+        return;
+
+    for (auto& [impl, changes] : pendingChanges)
+        impl->addChanges(changes);
+
+    pendingChanges.clear();
+}
+
+#elif JUCE_WINDOWS
+class FileSystemWatcher::Impl : private AsyncUpdater
+    , private Thread {
+public:
+    Impl(FileSystemWatcher& o, File f, bool)
         : Thread("FileSystemWatcher::Impl")
         , owner(o)
         , folder(f)
@@ -215,37 +468,28 @@ public:
                 while (true) {
                     FILE_NOTIFY_INFORMATION* fni = (FILE_NOTIFY_INFORMATION*)rawData;
 
-                    Event e;
+                    Change e;
                     e.file = folder.getChildFile(String(fni->FileName, fni->FileNameLength / sizeof(wchar_t)));
 
                     switch (fni->Action) {
                     case FILE_ACTION_ADDED:
-                        e.fsEvent = fileCreated;
+                        e.event = fileCreated;
                         break;
                     case FILE_ACTION_RENAMED_NEW_NAME:
-                        e.fsEvent = fileRenamedNewName;
+                        e.event = fileRenamedNewName;
                         break;
                     case FILE_ACTION_MODIFIED:
-                        e.fsEvent = fileUpdated;
+                        e.event = fileUpdated;
                         break;
                     case FILE_ACTION_REMOVED:
-                        e.fsEvent = fileDeleted;
+                        e.event = fileDeleted;
                         break;
                     case FILE_ACTION_RENAMED_OLD_NAME:
-                        e.fsEvent = fileRenamedOldName;
+                        e.event = fileRenamedOldName;
                         break;
                     }
 
-                    bool duplicateEvent = false;
-                    for (auto existing : events) {
-                        if (e == existing) {
-                            duplicateEvent = true;
-                            break;
-                        }
-                    }
-
-                    if (!duplicateEvent)
-                        events.add(e);
+                    events.add_unique(e);
 
                     if (fni->NextEntryOffset > 0)
                         rawData += fni->NextEntryOffset;
@@ -261,19 +505,20 @@ public:
 
     void handleAsyncUpdate() override
     {
-        ScopedLock sl(lock);
-
-        for (auto e : events)
-            owner.fileChanged(e.file, e.fsEvent);
+        SmallArray<Change> changes;
+        {
+            ScopedLock sl(lock);
+            std::swap(changes, events);
+        }
 
-        events.clear();
+        owner.filesChanged(changes);
     }
 
     FileSystemWatcher& owner;
     File const folder;
 
     CriticalSection lock;
-    SmallArray<Event> events;
+    SmallArray<Change> events;
 
     HANDLE folderHandle;
 };
@@ -282,7 +527,7 @@ public:
 #elif JUCE_BSD
 class FileSystemWatcher::Impl {
 public:
-    Impl(FileSystemWatcher& o, File f)
+    Impl(FileSystemWatcher& o, File f, bool)
         : owner(o)
         , folder(f)
     {
@@ -306,14 +551,14 @@ FileSystemWatcher::~FileSystemWatcher()
 {
 }
 
-void FileSystemWatcher::addFolder(File const& folder)
+void FileSystemWatcher::addFolder(File const& folder, bool const recursive)
 {
     SmallArray<File> allFolders;
     for (auto w : watched)
         allFolders.add(w->folder);
 
     if (!allFolders.contains(folder))
-        watched.add(new Impl(*this, folder));
+        watched.add(new Impl(*this, folder, recursive));
 }
 
 void FileSystemWatcher::removeFolder(File const& folder)
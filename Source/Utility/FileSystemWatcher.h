@@ -18,8 +18,11 @@ For more information visit www.rabiensoftware.com
     created, modified, deleted or renamed in the watched
     folder.
 
-    FileSystemWatcher will also recursively watch all subfolders on
-    macOS and windows and will not on Linux.
+    FileSystemWatcher will also recursively watch all subfolders. On
+    Linux, subfolders can be left out by passing recursive = false,
+    other platforms always watch them.
+
+    Changes are delivered on the message thread, in batches.
 
  */
 class FileSystemWatcher {
@@ -27,7 +30,7 @@ public:
     FileSystemWatcher();
     ~FileSystemWatcher();
 
-    void addFolder(File const& folder);
+    void addFolder(File const& folder, bool recursive = true);
     void removeFolder(File const& folder);
     void removeAllFolders();
 
@@ -39,6 +42,16 @@ public:
         fileRenamedNewName
     };
 
+    struct Change {
+        File file;
+        FileSystemEvent event;
+
+        bool operator==(Change const& other) const
+        {
+            return file == other.file && event == other.event;
+        }
+    };
+
     /** Receives callbacks from the FileSystemWatcher when a file changes */
     class Listener : public AsyncUpdater {
     public:
@@ -57,6 +70,14 @@ public:
             triggerAsyncUpdate();
         }
 
+        /* Called for every batch of changes. By default, this calls fileChanged for
+           each of them. Override this to handle all changes at once */
+        virtual void filesChanged(SmallArray<Change> const& changes)
+        {
+            for (auto const& change : changes)
+                fileChanged(change.file, change.event);
+        }
+
         virtual void filesystemChanged() { }
     };
 
@@ -72,36 +93,57 @@ public:
 
     static void addGlobalIgnorePath(File const& pathToIgnore)
     {
+        ScopedLock lock(pathsToIgnoreLock);
         pathsToIgnore.add_unique(pathToIgnore);
     }
 
     static void removeGlobalIgnorePath(File const& pathToIgnore)
     {
+        ScopedLock lock(pathsToIgnoreLock);
         pathsToIgnore.remove_one(pathToIgnore);
     }
 
 private:
     class Impl;
+    class Service;
 
-    void fileChanged(File const& f, FileSystemEvent fsEvent)
+    static bool isIgnored(File const& f)
     {
-        // By default, don't respond to hidden files (which would be .settings and .autosave)
-        // If you want that to respond to hidden file changes, override this
-        if (f.isHidden() || f.getFileName().startsWith("."))
-            return;
-
+        ScopedLock lock(pathsToIgnoreLock);
         for (auto const& pathToIgnore : pathsToIgnore) {
             if (f.isAChildOf(pathToIgnore) || f == pathToIgnore) {
-                return;
+                return true;
             }
         }
+        return false;
+    }
+
+    void fileChanged(File const& f, FileSystemEvent fsEvent)
+    {
+        filesChanged({ Change { f, fsEvent } });
+    }
+
+    void filesChanged(SmallArray<Change> const& changes)
+    {
+        SmallArray<Change> relevantChanges;
+        for (auto const& change : changes) {
+            // By default, don't respond to hidden files (which would be .settings and .autosave)
+            // If you want that to respond to hidden file changes, override this
+            if (change.file.isHidden() || change.file.getFileName().startsWith("."))
+                continue;
+
+            if (!isIgnored(change.file))
+                relevantChanges.add(change);
+        }
 
-        listeners.call(&FileSystemWatcher::Listener::fileChanged, f, fsEvent);
+        if (relevantChanges.not_empty())
+            listeners.call(&FileSystemWatcher::Listener::filesChanged, relevantChanges);
     }
 
     ListenerList<Listener> listeners;
     OwnedArray<Impl> watched;
     static inline SmallArray<File> pathsToIgnore;
+    static inline CriticalSection pathsToIgnoreLock;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FileSystemWatcher)
 };
@@ -10,7 +10,7 @@ using namespace juce;
 class FileSystemWatcher::Impl
 {
 public:
-    Impl (FileSystemWatcher& o, File f) : owner (o), folder (f)
+    Impl (FileSystemWatcher& o, File f, bool) : owner (o), folder (f)
     {
         NSString* newPath = [NSString stringWithUTF8String:folder.getFullPathName().toRawUTF8()];
 
@@ -51,6 +51,7 @@ public:
 
         char** files = (char**)eventPaths;
 
+        SmallArray<Change> changes;
         for (int i = 0; i < int (numEvents); i++)
         {
             char* file = files[i];
@@ -58,14 +59,17 @@ public:
 
             File path = String::fromUTF8 (file);
             if (evt & kFSEventStreamEventFlagItemModified)
-                impl->owner.fileChanged (path, FileSystemEvent::fileUpdated);
+                changes.add_unique ({ path, FileSystemEvent::fileUpdated });
             else if (evt & kFSEventStreamEventFlagItemRemoved)
-                impl->owner.fileChanged (path, FileSystemEvent::fileDeleted);
+                changes.add_unique ({ path, FileSystemEvent::fileDeleted });
             else if (evt & kFSEventStreamEventFlagItemRenamed)
-                impl->owner.fileChanged (path, path.exists() ? FileSystemEvent::fileRenamedNewName : FileSystemEvent::fileRenamedOldName);
+                changes.add_unique ({ path, path.exists() ? FileSystemEvent::fileRenamedNewName : FileSystemEvent::fileRenamedOldName });
             else if (evt & kFSEventStreamEventFlagItemCreated)
-                impl->owner.fileChanged (path, FileSystemEvent::fileCreated);
+                changes.add_unique ({ path, FileSystemEvent::fileCreated });
         }
+
+        // FSEvents already groups changes that happen within its latency, so every callback is one batch
+        impl->owner.filesChanged (changes);
     }
 
     FileSystemWatcher& owner;
@@ -81,7 +85,7 @@ public:
 class FileSystemWatcher::Impl
 {
 public:
-    Impl (FileSystemWatcher& o, File f) : owner (o), folder (f), fileDescriptor(-1), dispatchSource(nullptr)
+    Impl (FileSystemWatcher& o, File f, bool) : owner (o), folder (f), fileDescriptor(-1), dispatchSource(nullptr)
     {
         NSString* path = [NSString stringWithUTF8String:folder.getFullPathName().toRawUTF8()];
 
@@ -176,14 +180,14 @@ FileSystemWatcher::~FileSystemWatcher()
 {
 }
 
-void FileSystemWatcher::addFolder (const File& folder)
+void FileSystemWatcher::addFolder (const File& folder, bool recursive)
 {
     SmallArray<File> allFolders;
     for (auto w : watched)
         allFolders.add (w->folder);
 
     if ( !allFolders.contains (folder))
-        watched.add (new Impl (*this, folder));
+        watched.add (new Impl (*this, folder, recursive));
 }
 
 void FileSystemWatcher::removeFolder (const File& folder)
@@ -41,6 +41,22 @@ struct Fonts {
 
     static void setCurrentFont(Font const& font) { instance->currentTypeface = font.getTypefacePtr(); }
 
+    // Name of the same typeface in NanoVG, or nullptr if NVGSurface doesn't load it (like fonts that come with a patch)
+    static char const* getNanoVGFontFace(Font const& font)
+    {
+        auto const* typeface = font.getTypefacePtr().get();
+        auto const isTypeface = [typeface](Typeface::Ptr const& other) {
+            return typeface == other.get() || (typeface && typeface->getName() == other->getName() && typeface->getStyle() == other->getStyle());
+        };
+
+        if (isTypeface(instance->defaultTypeface))
+            return "Inter-Regular";
+        if (isTypeface(instance->boldTypeface))
+            return "Inter-Bold";
+
+        return nullptr;
+    }
+
     static float getStringWidth(String text, Font font)
     {
         return GlyphArrangement().getStringWidth(font, text);
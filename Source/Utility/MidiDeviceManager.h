@@ -6,14 +6,20 @@
 
 #pragma once
 #include <juce_audio_utils/juce_audio_utils.h>
-#include <concurrentqueue/concurrentqueue.h>
 #include "Utility/Containers.h"
+#include "Utility/MidiEventRing.h"
 
 class MidiDeviceManager final : public ChangeListener
     , public AsyncUpdater
-    , public MidiInputCallback {
+    , public MidiInputCallback
+    , private Timer {
 
 public:
+    // Largest SysEx message we accept from MIDI devices, larger ones are dropped
+    static constexpr int maxInputSysExSize = 1 << 14;
+    // Largest SysEx message that Pd can send, [midiout] collects it in a buffer of this size
+    static constexpr int maxOutputSysExSize = 512;
+
     MidiDeviceManager()
     {
 #if !JUCE_WINDOWS && !JUCE_IOS
@@ -32,17 +38,40 @@ public:
         midiBufferOut.ensureSize(2048);
         midiInputHistory.ensureSize(2048);
         midiOutputHistory.ensureSize(2048);
+
+        startTimer(1000);
     }
 
     ~MidiDeviceManager() override
     {
+        stopTimer();
         saveMidiSettings();
     }
 
-    void prepareToPlay(float const sampleRate)
+    // Not thread-safe, only call this while the audio thread isn't processing
+    // outputLatency is how many samples the audio output of a Pd block is delayed, before it reaches the host
+    void prepareToPlay(double const sampleRate, int const maxBlockSize, int const pdBlockSize, int const outputLatency)
     {
         currentSampleRate = sampleRate;
-        lastCallbackTime = Time::getMillisecondCounterHiRes();
+        inputClock.prepare(sampleRate, maxBlockSize, pdBlockSize);
+        midiOutputLatency = outputLatency;
+        hostBlockStart = 0;
+        hostBlockSize = 0;
+        pdBlockStart = 0;
+        pdSamplePosition = 0;
+
+        for (auto& port : inputPorts)
+            port.events.clear();
+        for (auto& port : outputPorts)
+            port.events.clear();
+    }
+
+    // Called at the start of every host block, with the number of samples Pd will see
+    void beginHostBlock(int const numSamples)
+    {
+        inputClock.beginHostBlock(numSamples, getCurrentTime());
+        hostBlockStart += hostBlockSize;
+        hostBlockSize = numSamples;
     }
 
     void updateMidiDevices()
@@ -185,29 +214,15 @@ public:
         triggerAsyncUpdate();
     }
 
-    // Function to enqueue external MIDI (like the DAW's MIDI coming in with processBlock)
-    void enqueueMidiInput(int const port, MidiBuffer const& buffer)
-    {
-        auto& inputPort = inputPorts[port + 1];
-        if (inputPort.enabled) {
-            for (auto m : buffer) {
-                auto message = m.getMessage();
-                auto sampleNumber = static_cast<int>((message.getTimeStamp() - 0.001 * lastCallbackTime) * currentSampleRate);
-                inputPort.queue.enqueue({ message, sampleNumber });
-            }
-        }
-    }
-
-    // Handle midi input events in a callback
+    // Handle midi input events in a callback, called before every Pd block
+    // Every event is placed at the sample it arrived at, one host block later, so the time between events is kept
     void dequeueMidiInput(int const numSamples, std::function<void(int, MidiBuffer const&)> inputCallback)
     {
-        auto const timeNow = Time::getMillisecondCounterHiRes();
-        auto const msElapsed = timeNow - lastCallbackTime;
+        pdBlockStart = pdSamplePosition;
+        pdSamplePosition += numSamples;
 
-        lastCallbackTime = timeNow;
-        int numSourceSamples = jmax(1, roundToInt(msElapsed * 0.001 * currentSampleRate));
-        int startSample = 0;
-        int scale = 1 << 16;
+        auto const blockStart = static_cast<double>(pdBlockStart);
+        auto const blockEnd = static_cast<double>(pdSamplePosition);
 
         int port = 0;
         for (auto& inputPort : inputPorts) {
@@ -215,35 +230,18 @@ public:
                 continue;
 
             midiBufferIn.clear();
-            std::pair<MidiMessage, int> message;
-
-            if (numSourceSamples > numSamples) {
-                int const maxBlockLengthToUse = numSamples << 5;
-                if (numSourceSamples > maxBlockLengthToUse) {
-                    // TODO: check if this is correct
-                    startSample = numSourceSamples - maxBlockLengthToUse;
-                    numSourceSamples = maxBlockLengthToUse;
-                }
-
-                scale = (numSamples << 10) / numSourceSamples;
-
-                while (inputPort.queue.try_dequeue(message)) {
-                    auto& [midiMessage, samplePosition] = message;
-                    auto const pos = (samplePosition - startSample) * scale >> 10;
-                    midiBufferIn.addEvent(midiMessage, pos);
-                    midiInputHistory.addEvent(midiMessage, pos);
-                }
-                inputCallback(port, midiBufferIn);
-            } else {
-                startSample = numSamples - numSourceSamples;
-                while (inputPort.queue.try_dequeue(message)) {
-                    auto& [midiMessage, samplePosition] = message;
-                    auto const pos = jlimit(0, numSamples - 1, samplePosition + startSample);
-                    midiBufferIn.addEvent(midiMessage, pos);
-                    midiInputHistory.addEvent(midiMessage, pos);
-                }
-                inputCallback(port, midiBufferIn);
-            }
+            inputPort.events.read([this, blockStart, blockEnd, numSamples](double const timestamp, uint8 const* data, int const size) {
+                auto const position = inputClock.getSamplePosition(timestamp);
+                if (position >= blockEnd)
+                    return false;
+
+                // Events that came in too late for their block go at the start of this one
+                auto const offset = std::clamp(static_cast<int>(position - blockStart), 0, numSamples - 1);
+                midiBufferIn.addEvent(data, size, offset);
+                midiInputHistory.addEvent(data, size, offset);
+                return true;
+            });
+            inputCallback(port, midiBufferIn);
             port++;
         }
     }
@@ -258,13 +256,14 @@ public:
         return internalSynthPort;
     }
 
-    // Adds output message to buffer
-    void enqueueMidiOutput(int const port, MidiMessage const& message, int samplePosition)
+    // Adds an output message, offset is the sample within the current Pd block where it was sent
+    void enqueueMidiOutput(int const port, MidiMessage const& message, int const offset)
     {
         auto& outputPort = outputPorts[port + 1];
         auto dawPort = !ProjectInfo::isStandalone && port == 0;
         if (outputPort.enabled || dawPort || internalSynthPort == port) {
-            outputPort.queue.enqueue({ message, samplePosition });
+            auto const samplePosition = pdBlockStart + offset + midiOutputLatency;
+            outputPort.events.write(static_cast<double>(samplePosition), message.getRawData(), static_cast<size_t>(message.getRawDataSize()));
         }
     }
 
@@ -275,21 +274,29 @@ public:
         buffer.addEvents(outputPort.buffer, 0, numSamples, 0);
     }
 
-    // Sends pending MIDI output messages, and return a block with all messages
+    // Sends MIDI output messages that belong to the current host block, and return a block with all messages
+    // Messages for later samples, which Pd can produce ahead of time when it runs on a fifo, wait for their block
     void sendAndCollectMidiOutput(MidiBuffer& dawOutput)
     {
+        auto const blockStart = static_cast<double>(hostBlockStart);
+        auto const blockEnd = static_cast<double>(hostBlockStart + hostBlockSize);
+        auto const lastSample = std::max(0, hostBlockSize - 1);
+
         for (int i = 0; i < outputPorts.size(); i++) {
             auto& outputPort = outputPorts[i];
             auto dawPort = !ProjectInfo::isStandalone && i == 1;
             if (outputPort.enabled || dawPort || i == internalSynthPort + 1) {
-                std::pair<MidiMessage, int> message;
-                while (outputPort.queue.try_dequeue(message)) {
-                    auto& [midiMessage, samplePosition] = message;
-                    outputPort.buffer.addEvent(midiMessage, samplePosition);
-                    midiOutputHistory.addEvent(midiMessage, samplePosition);
+                outputPort.events.read([this, &outputPort, &dawOutput, i, blockStart, blockEnd, lastSample](double const time, uint8 const* data, int const size) {
+                    if (time >= blockEnd)
+                        return false;
+
+                    auto const samplePosition = std::clamp(static_cast<int>(time - blockStart), 0, lastSample);
+                    outputPort.buffer.addEvent(data, size, samplePosition);
+                    midiOutputHistory.addEvent(data, size, samplePosition);
                     if (i == 1)
-                        dawOutput.addEvent(midiMessage, samplePosition);
-                }
+                        dawOutput.addEvent(data, size, samplePosition);
+                    return true;
+                });
 
                 if (!outputPort.buffer.isEmpty()) {
                     for (auto* device : outputPort.devices) {
@@ -326,6 +333,36 @@ public:
         return midiOutputHistory;
     }
 
+    // Total number of MIDI events that didn't fit in the input or output rings
+    int getNumDroppedEvents() const
+    {
+        int numDropped = 0;
+        for (auto const& port : inputPorts)
+            numDropped += port.events.getNumDroppedEvents();
+        for (auto const& port : outputPorts)
+            numDropped += port.events.getNumDroppedEvents();
+        return numDropped;
+    }
+
+    // Called on the message thread with the number of events that were dropped since the last call
+    std::function<void(int)> onEventsDropped = [](int) { };
+
+#if ENABLE_TESTING
+    // Lets tests send MIDI through the first port without devices, on a clock they control
+    void enableTestPort(double (*testClock)())
+    {
+        inputPorts[1].enabled = true;
+        outputPorts[1].enabled = true;
+        getCurrentTime = testClock;
+    }
+
+    // Adds input to the first port, as if one of its devices received the message
+    void addTestInput(MidiMessage const& message)
+    {
+        writeMidiInput(1, message);
+    }
+#endif
+
     // Load last MIDI settings from our settings file
     void loadMidiSettings()
     {
@@ -407,9 +444,14 @@ private:
             return 0;
         }();
 
+        writeMidiInput(port, message);
+    }
+
+    // JUCE timestamps device input in seconds, on the same clock as Time::getMillisecondCounterHiRes()
+    void writeMidiInput(int const port, MidiMessage const& message)
+    {
         if (inputPorts[port].enabled) {
-            auto sampleNumber = static_cast<int>((message.getTimeStamp() - 0.001f * lastCallbackTime) * currentSampleRate);
-            inputPorts[port].queue.enqueue({ message, sampleNumber });
+            inputPorts[port].events.write(message.getTimeStamp() * 1000.0, message.getRawData(), static_cast<size_t>(message.getRawDataSize()));
         }
     }
 
@@ -418,25 +460,50 @@ private:
         saveMidiSettings();
     }
 
+    // The rings only count what they drop, so that the MIDI and audio threads don't have to report it themselves
+    void timerCallback() override
+    {
+        auto const numDropped = getNumDroppedEvents();
+        if (numDropped > numReportedDroppedEvents) {
+            onEventsDropped(numDropped - numReportedDroppedEvents);
+            numReportedDroppedEvents = numDropped;
+        }
+    }
+
     void changeListenerCallback(ChangeBroadcaster* origin) override
     {
         updateMidiDevices();
     }
 
-    float currentSampleRate = 44100.f;
-    AtomicValue<float> lastCallbackTime = 0.0f;
+    double currentSampleRate = 44100.0;
+
+    // The clock that device input is timestamped with
+    double (*getCurrentTime)() = &Time::getMillisecondCounterHiRes;
+
+    // Sample positions are counted from prepareToPlay, in Pd's sample rate
+    // Pd's audio input is never delayed relative to the host, so host and Pd positions only differ by the output latency
+    MidiInputClock inputClock;
+    int64 hostBlockStart = 0;
+    int hostBlockSize = 0;
+    int64 pdBlockStart = 0;
+    int64 pdSamplePosition = 0;
+    int midiOutputLatency = 0;
+
+    int numReportedDroppedEvents = 0;
 
     struct MidiInputPort {
         AtomicValue<bool> enabled = false;
         OwnedArray<MidiInput> devices;
-        moodycamel::ConcurrentQueue<std::pair<MidiMessage, int>> queue;
+        // Timestamped in milliseconds
+        MidiEventRing events { maxInputSysExSize };
     };
 
     struct MidiOutputPort {
         AtomicValue<bool> enabled = false;
         OwnedArray<MidiOutput> devices;
-        // We need this queue because we are not inside the global Pd lock, and MIDI data can be enqueued from the message thread (but inside the audio lock)
-        moodycamel::ConcurrentQueue<std::pair<MidiMessage, int>> queue;
+        // MIDI data can be enqueued from the message thread (but inside the audio lock), timestamped in samples
+        // SysEx messages get a start and end byte on top of what Pd sent
+        MidiEventRing events { maxOutputSysExSize + 2 };
         MidiBuffer buffer;
     };
 
@@ -0,0 +1,183 @@
+/*
+ // Copyright (c) 2025 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include "Utility/Containers.h"
+
+// Ring of raw MIDI events with a timestamp, read by the audio thread without locking or allocating
+// Writers take a spinlock, since a port can have several MIDI devices that call us from different threads
+// Events are stored as a header followed by their bytes, and an event never wraps around the end of the ring
+// Events that don't fit are dropped and counted, see getNumDroppedEvents()
+class MidiEventRing {
+public:
+    // The ring always has room for a few of the largest events, and for many short ones
+    explicit MidiEventRing(size_t const maxEventSize)
+        : capacity(std::max(minCapacity, 4 * getRecordSize(maxEventSize)))
+        , storage(capacity)
+    {
+    }
+
+    // Returns false if the ring is full or the event is too large, the event is then dropped
+    bool write(double const time, uint8 const* data, size_t const size)
+    {
+        auto const recordSize = getRecordSize(size);
+        if (recordSize > capacity) {
+            numDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        SpinLock::ScopedLockType lock(writeLock);
+
+        auto const position = writePosition.load(std::memory_order_relaxed);
+        auto const offset = position % capacity;
+        auto const padding = offset + recordSize > capacity ? capacity - offset : 0;
+        if (position + padding + recordSize - readPosition.load(std::memory_order_acquire) > capacity) {
+            numDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // Tell the reader to continue at the start of the ring
+        if (padding >= sizeof(Header))
+            getHeader(offset).size = wrapMarker;
+
+        auto& header = getHeader((position + padding) % capacity);
+        header.time = time;
+        header.size = static_cast<uint32>(size);
+        std::copy_n(data, size, storage.data() + (position + padding) % capacity + sizeof(Header));
+
+        writePosition.store(position + padding + recordSize, std::memory_order_release);
+        return true;
+    }
+
+    // Number of events that were dropped since the ring was created
+    int getNumDroppedEvents() const { return numDroppedEvents.load(std::memory_order_relaxed); }
+
+    // Calls callback(time, data, size) for events in the order they were written
+    // When the callback returns false, that event and everything after it stay in the ring for the next read
+    template<typename Callback>
+    void read(Callback&& callback)
+    {
+        auto position = readPosition.load(std::memory_order_relaxed);
+        auto const end = writePosition.load(std::memory_order_acquire);
+
+        while (position < end) {
+            auto const offset = position % capacity;
+            if (capacity - offset < sizeof(Header) || getHeader(offset).size == wrapMarker) {
+                position += capacity - offset;
+                continue;
+            }
+
+            auto const& header = getHeader(offset);
+            if (!callback(header.time, storage.data() + offset + sizeof(Header), static_cast<int>(header.size)))
+                break;
+
+            position += getRecordSize(header.size);
+        }
+
+        readPosition.store(position, std::memory_order_release);
+    }
+
+    // Only call this from the reading thread
+    void clear()
+    {
+        readPosition.store(writePosition.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    struct Header {
+        double time;
+        uint32 size;
+    };
+
+    static constexpr uint32 wrapMarker = 0xFFFFFFFF;
+    static constexpr size_t minCapacity = 1 << 14;
+
+    static size_t getRecordSize(size_t const size)
+    {
+        return sizeof(Header) + (size + alignof(Header) - 1) / alignof(Header) * alignof(Header);
+    }
+
+    Header& getHeader(size_t const offset)
+    {
+        return *reinterpret_cast<Header*>(storage.data() + offset);
+    }
+
+    size_t const capacity;
+
+    // Heap allocations are aligned for any scalar type, so headers can be stored at any multiple of their alignment
+    HeapArray<uint8> storage;
+
+    // Total number of bytes written and read, the offset in the ring is this modulo the capacity
+    std::atomic<uint64> writePosition = 0;
+    std::atomic<uint64> readPosition = 0;
+
+    std::atomic<int> numDroppedEvents = 0;
+
+    SpinLock writeLock;
+};
+
+// Converts the millisecond timestamps of MIDI device input into sample positions, on the audio thread
+// The time of every host block is predicted from the number of samples processed so far, instead of measured, so the
+// jitter of audio callbacks doesn't end up in the MIDI timing. The prediction is only nudged towards the measured time,
+// slowly enough to follow the drift between the audio and system clocks, and reset after dropouts
+// Events are placed one host block, one Pd block and a few milliseconds for callback jitter later than they arrived,
+// so they are never too late for their block
+class MidiInputClock {
+public:
+    void prepare(double const newSampleRate, int const maxBlockSize, int const pdBlockSize)
+    {
+        sampleRate = newSampleRate;
+        extraLatency = pdBlockSize + static_cast<int64>(std::ceil(maxCallbackJitterMs * sampleRate / 1000.0));
+        latency = maxBlockSize + extraLatency;
+        synchronised = false;
+    }
+
+    // Called at the start of every host block, with the current time from Time::getMillisecondCounterHiRes()
+    void beginHostBlock(int const numSamples, double const timeNow)
+    {
+        auto const msPerSample = 1000.0 / sampleRate;
+        auto const expectedTime = blockTime + static_cast<double>(samplePosition - blockSample) * msPerSample;
+        auto const error = timeNow - expectedTime;
+
+        if (!synchronised || std::abs(error) > std::max(maxErrorMs, 4.0 * numSamples * msPerSample)) {
+            blockTime = timeNow;
+            synchronised = true;
+        } else {
+            // At most 100 ppm per block, which is more than any audio interface drifts
+            auto const maxCorrection = numSamples * msPerSample * 1e-4;
+            blockTime = expectedTime + std::clamp(error * correctionAmount, -maxCorrection, maxCorrection);
+        }
+
+        // Hosts can send larger blocks than they promised
+        latency = std::max<int64>(latency, numSamples + extraLatency);
+
+        blockSample = samplePosition;
+        samplePosition += numSamples;
+    }
+
+    // Position of a timestamp in the stream of samples, fractional so timing can be measured below one sample
+    double getSamplePosition(double const timestampMs) const
+    {
+        return static_cast<double>(blockSample + latency) + (timestampMs - blockTime) * sampleRate / 1000.0;
+    }
+
+private:
+    static constexpr double maxErrorMs = 20.0;
+    static constexpr double maxCallbackJitterMs = 2.0;
+    static constexpr double correctionAmount = 1e-3;
+
+    double sampleRate = 44100.0;
+    int64 latency = 0;
+    int64 extraLatency = 0;
+
+    bool synchronised = false;
+    double blockTime = 0.0;
+    int64 blockSample = 0;
+    int64 samplePosition = 0;
+};
@@ -0,0 +1,119 @@
+/*
+ // Copyright (c) 2025 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include "Utility/Containers.h"
+
+// Level-of-detail cache for drawing large arrays
+// Every level stores the minimum and maximum of blocks of samples, and each level's blocks are branchFactor times larger than
+// the ones in the level below. That way, the range of any number of samples can be found by looking at a handful of blocks,
+// so drawing an array costs O(pixels) instead of O(samples). Changing samples only updates the blocks that contain them
+class MinMaxPyramid {
+public:
+    static constexpr size_t branchFactor = 8;
+
+    struct MinMax {
+        float min;
+        float max;
+    };
+
+    // Rebuilds all levels for a new set of samples
+    void build(std::span<float const> samples)
+    {
+        resize(samples.size());
+        update(samples, 0, numSamples);
+    }
+
+    // Allocates the levels for numSamples samples that are all zero, which can then be filled in with update()
+    void resize(size_t const size)
+    {
+        levels.clear();
+        numSamples = size;
+
+        for (auto levelSize = numSamples; levelSize > branchFactor; levelSize = getNumBlocks(levelSize)) {
+            levels.emplace_back(getNumBlocks(levelSize));
+        }
+    }
+
+    // Updates the blocks that contain the samples between start and end, after they have changed
+    void update(std::span<float const> samples, size_t start, size_t end)
+    {
+        jassert(samples.size() == numSamples);
+        end = std::min(end, numSamples);
+
+        for (size_t level = 0; level < levels.size() && start < end; level++) {
+            auto& blocks = levels[level];
+            auto const firstBlock = start / branchFactor;
+            auto const lastBlock = getNumBlocks(end);
+            auto const childSize = level == 0 ? numSamples : levels[level - 1].size();
+
+            for (auto block = firstBlock; block < lastBlock; block++) {
+                auto const childStart = block * branchFactor;
+                auto const childEnd = std::min(childStart + branchFactor, childSize);
+
+                MinMax result = { std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest() };
+                for (auto child = childStart; child < childEnd; child++) {
+                    auto const value = level == 0 ? MinMax { samples[child], samples[child] } : levels[level - 1][child];
+                    result.min = std::min(result.min, value.min);
+                    result.max = std::max(result.max, value.max);
+                }
+                blocks[block] = result;
+            }
+
+            start = firstBlock;
+            end = lastBlock;
+        }
+    }
+
+    // Returns the minimum and maximum of the samples between start and end
+    // Partial blocks at the edges are read from the level below, so the result is exact
+    MinMax getMinMax(std::span<float const> samples, size_t start, size_t end) const
+    {
+        MinMax result = { std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest() };
+        end = std::min(end, numSamples);
+
+        auto scan = [&](size_t const level, size_t const from, size_t const to) {
+            for (auto i = from; i < to; i++) {
+                auto const value = level == 0 ? MinMax { samples[i], samples[i] } : levels[level - 1][i];
+                result.min = std::min(result.min, value.min);
+                result.max = std::max(result.max, value.max);
+            }
+        };
+
+        for (size_t level = 0; start < end; level++) {
+            auto const alignedStart = (start + branchFactor - 1) / branchFactor * branchFactor;
+            auto const alignedEnd = end / branchFactor * branchFactor;
+
+            if (level == levels.size() || alignedStart >= alignedEnd) {
+                scan(level, start, end);
+                break;
+            }
+
+            scan(level, start, alignedStart);
+            scan(level, alignedEnd, end);
+
+            start = alignedStart / branchFactor;
+            end = alignedEnd / branchFactor;
+        }
+
+        return result;
+    }
+
+    size_t size() const
+    {
+        return numSamples;
+    }
+
+private:
+    static size_t getNumBlocks(size_t const size)
+    {
+        return (size + branchFactor - 1) / branchFactor;
+    }
+
+    SmallArray<HeapArray<MinMax>> levels;
+    size_t numSamples = 0;
+};
@@ -0,0 +1,182 @@
+/*
+ // Copyright (c) 2025 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include "Pd/Instance.h"
+
+// Everything [playhead] can report about the host transport, as it was at the start of a host block
+// Each message [playhead] understands has up to three values. Messages the host doesn't provide have no values, and aren't sent
+struct PlayheadState {
+    enum Message : uint8 {
+        Playing,
+        Recording,
+        Looping,
+        EditTime,
+        FrameRate,
+        Bpm,
+        LastBar,
+        TimeSig,
+        Position,
+        NumMessages
+    };
+
+    static constexpr char const* selectors[NumMessages] = { "playing", "recording", "looping", "edittime", "framerate", "bpm", "lastbar", "timesig", "position" };
+
+    double values[NumMessages][3] = {};
+    uint8 sizes[NumMessages] = {};
+
+    void set(Message const message, double const a)
+    {
+        values[message][0] = a;
+        sizes[message] = 1;
+    }
+
+    void set(Message const message, double const a, double const b, double const c = 0.0, uint8 const size = 2)
+    {
+        values[message][0] = a;
+        values[message][1] = b;
+        values[message][2] = c;
+        sizes[message] = size;
+    }
+
+    bool differs(PlayheadState const& other, int const message) const
+    {
+        return sizes[message] != other.sizes[message] || !std::equal(values[message], values[message] + sizes[message], other.values[message]);
+    }
+
+    // Moves the position forward, for Pd blocks that start later than the host block
+    void advance(int const numSamples, double const sampleRate)
+    {
+        if (!sizes[Position] || values[Playing][0] == 0.0 || sampleRate <= 0.0)
+            return;
+
+        auto const seconds = static_cast<double>(numSamples) / sampleRate;
+        auto* position = values[Position];
+        if (sizes[Bpm])
+            position[0] += seconds * values[Bpm][0] / 60.0;
+        position[1] += static_cast<double>(numSamples);
+        position[2] += seconds;
+    }
+
+    static PlayheadState fromPosition(AudioPlayHead::PositionInfo const& info)
+    {
+        PlayheadState state;
+        state.set(Playing, info.getIsPlaying());
+        state.set(Recording, info.getIsRecording());
+
+        auto const loopPoints = info.getLoopPoints();
+        state.set(Looping, info.getIsLooping(), loopPoints ? loopPoints->ppqStart : 0.0, loopPoints ? loopPoints->ppqEnd : 0.0, 3);
+
+        if (auto const editTime = info.getEditOriginTime())
+            state.set(EditTime, *editTime);
+        if (auto const frameRate = info.getFrameRate())
+            state.set(FrameRate, frameRate->getEffectiveRate());
+        if (auto const bpm = info.getBpm())
+            state.set(Bpm, *bpm);
+        if (auto const lastBar = info.getPpqPositionOfLastBarStart())
+            state.set(LastBar, *lastBar);
+        if (auto const timeSignature = info.getTimeSignature())
+            state.set(TimeSig, timeSignature->numerator, timeSignature->denominator);
+
+        auto const ppq = info.getPpqPosition();
+        auto const samples = info.getTimeInSamples();
+        auto const seconds = info.getTimeInSeconds();
+        if (ppq || samples || seconds)
+            state.set(Position, ppq.orFallback(0.0), static_cast<double>(samples.orFallback(0)), seconds.orFallback(0.0), 3);
+
+        return state;
+    }
+};
+
+// Sends the host transport to [playhead], only when something changed and only if there is a [playhead] to receive it
+// update() is called once per host block, and send() once per Pd block. When the transport isn't moving, or when no patch
+// contains a [playhead], send() returns without locking Pd and without sending anything
+class PlayheadSender {
+public:
+    // Has to be called after the Pd instance was initialised, so the symbols belong to it
+    explicit PlayheadSender(pd::Instance& pdInstance)
+        : instance(pdInstance)
+        , receiverSymbol(pdInstance.generateSymbol("__playhead"))
+    {
+        for (int i = 0; i < PlayheadState::NumMessages; i++) {
+            selectorSymbols[i] = instance.generateSymbol(PlayheadState::selectors[i]);
+        }
+    }
+
+    void update(AudioPlayHead const* playhead)
+    {
+        if (!playhead)
+            return;
+
+        if (auto const info = playhead->getPosition())
+            state = PlayheadState::fromPosition(*info);
+    }
+
+    // sampleOffset is where the Pd block starts within the host block, so the position stays accurate within the host block
+    void send(int const sampleOffset, double const sampleRate)
+    {
+        // Only a hint, since we don't hold the lock yet. It's checked again before anything gets sent
+        auto* const receiver = receiverSymbol->s_thing;
+        if (EXPECT_LIKELY(!receiver)) {
+            lastReceiver = nullptr;
+            return;
+        }
+
+        auto current = state;
+        if (sampleOffset > 0)
+            current.advance(sampleOffset, sampleRate);
+
+        // A new receiver hasn't seen any of the values yet
+        auto const sendAll = receiver != lastReceiver || outdated.exchange(false, std::memory_order_relaxed);
+
+        uint32 changed = 0;
+        for (int i = 0; i < PlayheadState::NumMessages; i++) {
+            if (current.sizes[i] && (sendAll || current.differs(lastSent, i)))
+                changed |= 1u << i;
+        }
+
+        if (EXPECT_LIKELY(!changed))
+            return;
+
+        ScopedLock lock(instance.audioLock);
+        if (auto* const target = receiverSymbol->s_thing) {
+            for (int i = 0; i < PlayheadState::NumMessages; i++) {
+                if (!(changed & (1u << i)))
+                    continue;
+
+                t_atom atoms[3];
+                for (int j = 0; j < current.sizes[i]; j++) {
+                    SETFLOAT(atoms + j, static_cast<float>(current.values[i][j]));
+                }
+                pd_typedmess(target, selectorSymbols[i], current.sizes[i], atoms);
+            }
+        }
+
+        lastSent = current;
+        lastReceiver = receiver;
+    }
+
+    // Called when a new [playhead] is created, which could share a receiver with an existing one, so we can't tell it's there
+    void resendAll()
+    {
+        outdated.store(true, std::memory_order_relaxed);
+    }
+
+private:
+    pd::Instance& instance;
+
+    t_symbol* receiverSymbol;
+    t_symbol* selectorSymbols[PlayheadState::NumMessages];
+
+    PlayheadState state;
+    PlayheadState lastSent;
+    t_pd* lastReceiver = nullptr;
+
+    std::atomic<bool> outdated = true;
+};
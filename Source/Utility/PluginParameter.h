@@ -89,6 +89,10 @@ public:
         StackArray<char, 128> name = { };
         std::copy_n(newName.data(), newName.length(), name.data());
         parameterName.store(name);
+
+        // Makes the audio thread look up the receiver symbol again
+        nameVersion.fetch_add(1, std::memory_order_release);
+        processor.parameterNamesChanged();
     }
 
     String getName(int const maximumStringLength) const override
@@ -109,6 +113,30 @@ public:
     void setEnabled(bool const shouldBeEnabled)
     {
         enabled = shouldBeEnabled;
+        processor.parameterNamesChanged();
+    }
+
+    // Only called from the audio thread, with the audio lock held
+    // The symbol is looked up once, and then again only when the parameter gets renamed
+    t_symbol* getReceiverSymbol()
+    {
+        auto const version = nameVersion.load(std::memory_order_acquire);
+        if (!receiverSymbol || receiverVersion != version) {
+            receiverSymbol = processor.generateSymbol(getTitle());
+            receiverVersion = version;
+        }
+        return receiverSymbol;
+    }
+
+    // Same as getReceiverSymbol(), for the symbol that [param~] objects for this parameter are bound to
+    t_symbol* getSignalReceiverSymbol()
+    {
+        auto const version = nameVersion.load(std::memory_order_acquire);
+        if (!signalReceiverSymbol || signalReceiverVersion != version) {
+            signalReceiverSymbol = processor.generateSymbol(getTitle().toString() + "-param~");
+            signalReceiverVersion = version;
+        }
+        return signalReceiverSymbol;
     }
 
     NormalisableRange<float> const& getNormalisableRange() const override
@@ -136,7 +164,8 @@ public:
         auto const oldValue = value.load();
         value = std::clamp(newValue, range.start, range.end);
         sendValueChangedMessageToListeners(getValue());
-        valueChanged = valueChanged || oldValue != value;
+        if (oldValue != value)
+            setChanged();
     }
 
     float getValue() const override
@@ -150,7 +179,8 @@ public:
         auto const range = getNormalisableRange();
         auto const oldValue = value.load();
         value = range.convertFrom0to1(newValue);
-        valueChanged = valueChanged || oldValue != value;
+        if (oldValue != value)
+            setChanged();
     }
 
     void setDefaultValue(float const newDefaultValue)
@@ -302,19 +332,17 @@ public:
         }
     }
 
-    bool wasChanged() const
-    {
-        return valueChanged;
-    }
-
+    // Changes are collected by the processor, so it only has to send the parameters that changed to Pd
     void setUnchanged()
     {
-        valueChanged = false;
+        if (auto const slot = getParameterIndex(); slot >= 0)
+            processor.clearParameterChanged(slot);
     }
 
     void setChanged()
     {
-        valueChanged = true;
+        if (auto const slot = getParameterIndex(); slot >= 0)
+            processor.markParameterChanged(slot);
     }
 
     float getGestureState() const
@@ -350,7 +378,6 @@ private:
     float defaultValue;
     bool loadedFromDAW = false;
 
-    AtomicValue<bool> valueChanged;
     AtomicValue<float> gestureState = 0.0f;
     AtomicValue<int> index;
     AtomicValue<float> value;
@@ -362,6 +389,13 @@ private:
     AtomicValue<float> rangeSkew = 1;
 
     AtomicValue<StackArray<char, 128>> parameterName;
+    std::atomic<uint32> nameVersion = 0;
+
+    // Owned by the audio thread
+    t_symbol* receiverSymbol = nullptr;
+    uint32 receiverVersion = 0;
+    t_symbol* signalReceiverSymbol = nullptr;
+    uint32 signalReceiverVersion = 0;
     NormalisableRange<float> normalisableRangeRet;
 
     Mode mode;
@@ -0,0 +1,74 @@
+/*
+ // Copyright (c) 2025 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "PollScheduler.h"
+#include "Pd/Instance.h"
+
+PollScheduler::PollScheduler(pd::Instance* instance, Component& surface)
+    : pd(instance)
+    , surface(surface)
+{
+}
+
+void PollScheduler::addPoller(Poller* poller, Component* component, int const interval)
+{
+    poller->pollComponent = component;
+    poller->pollInterval = interval;
+    poller->pollRequested = true; // Make sure we get an initial state
+    pollers.add_unique(poller);
+}
+
+void PollScheduler::removePoller(Poller* poller)
+{
+    pollers.remove_one(poller);
+
+    // In case we're removed from inside a poll callback
+    for (auto& due : duePollers) {
+        if (due == poller)
+            due = nullptr;
+    }
+}
+
+bool PollScheduler::isVisible(Component const* component) const
+{
+    if (!component->isShowing())
+        return false;
+
+    return surface.getLocalArea(component, component->getLocalBounds()).intersects(surface.getLocalBounds());
+}
+
+void PollScheduler::poll()
+{
+    auto const now = Time::getMillisecondCounterHiRes();
+
+    duePollers.clear();
+    for (auto* poller : pollers) {
+        auto const intervalPassed = poller->pollInterval >= 0 && now - poller->lastPollTime >= poller->pollInterval;
+        if ((intervalPassed || poller->pollRequested) && isVisible(poller->pollComponent)) {
+            duePollers.add(poller);
+        }
+    }
+
+    if (duePollers.empty())
+        return;
+
+    auto const lockStart = Time::getHighResolutionTicks();
+    pd->lockAudioThread();
+    for (auto* poller : duePollers) {
+        poller->pollSnapshot();
+        poller->lastPollTime = now;
+        poller->pollRequested = false;
+    }
+    pd->unlockAudioThread();
+
+    auto const lockHoldTime = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - lockStart) * 1000.0;
+    maxLockHoldTime = std::max(maxLockHoldTime, lockHoldTime);
+
+    for (auto* poller : duePollers) {
+        if (poller)
+            poller->pollApply();
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ // Copyright (c) 2025 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "Utility/Config.h"
+
+namespace pd {
+class Instance;
+}
+
+// Services GUI objects that need to read state from Pd on an interval, like scopes, keyboards and numbox~
+// Instead of every object running its own timer and taking the audio lock separately, the editor polls all of them
+// from the NVGSurface vblank, inside a single audio lock per frame. Pollers that aren't visible on screen are skipped
+class PollScheduler {
+public:
+    class Poller {
+    public:
+        virtual ~Poller() = default;
+
+        // Called with the audio lock held. Only copy what you need out of Pd here, and do the rest in pollApply
+        virtual void pollSnapshot() = 0;
+
+        // Called after the audio lock has been released
+        virtual void pollApply() { }
+
+        // Minimum time between polls in milliseconds, or -1 to only poll after requestPoll()
+        void setPollInterval(int const interval) { pollInterval = interval; }
+
+        // Polls on the next frame where this poller is visible
+        void requestPoll() { pollRequested = true; }
+
+    private:
+        Component* pollComponent = nullptr;
+        int pollInterval = -1;
+        double lastPollTime = 0.0;
+        bool pollRequested = false;
+
+        friend class PollScheduler;
+    };
+
+    PollScheduler(pd::Instance* instance, Component& surface);
+
+    // The poller only gets polled while component is showing and inside the surface
+    void addPoller(Poller* poller, Component* component, int interval);
+    void removePoller(Poller* poller);
+
+    // Called once per frame
+    void poll();
+
+    // Longest time a frame held the audio lock for since the last call, in milliseconds. Shown in the CPU meter tooltip
+    double takeMaxLockHoldTime() { return std::exchange(maxLockHoldTime, 0.0); }
+
+private:
+    bool isVisible(Component const* component) const;
+
+    pd::Instance* pd;
+    Component& surface;
+
+    SmallArray<Poller*> pollers;
+    SmallArray<Poller*> duePollers;
+
+    double maxLockHoldTime = 0.0;
+};
@@ -324,7 +324,7 @@ void SettingsFile::resetSettingsState()
 
 void SettingsFile::startChangeListener()
 {
-    settingsFileWatcher.addFolder(settingsFile.getParentDirectory());
+    settingsFileWatcher.addFolder(settingsFile.getParentDirectory(), false);
     settingsFileWatcher.addListener(this);
 }
 
@@ -624,9 +624,15 @@ void SettingsFile::reloadSettings()
     }
 }
 
-void SettingsFile::filesystemChanged()
+void SettingsFile::filesChanged(SmallArray<FileSystemWatcher::Change> const& changes)
 {
-    reloadSettings();
+    // Other files in the same folder change all the time, only reload when it's the settings file
+    for (auto const& change : changes) {
+        if (change.file == settingsFile) {
+            reloadSettings();
+            return;
+        }
+    }
 }
 
 void SettingsFile::triggerSettingsChange(String const& name)
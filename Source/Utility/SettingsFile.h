@@ -55,7 +55,7 @@ public:
 
     void reloadSettings();
 
-    void filesystemChanged() override;
+    void filesChanged(SmallArray<FileSystemWatcher::Change> const& changes) override;
 
     void triggerSettingsChange(String const&);
     void valueChanged(Value& v) override;
@@ -0,0 +1,208 @@
+/*
+ // Copyright (c) 2025 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include "Utility/Containers.h"
+
+// Uniform grid that maps canvas areas to the items that overlap them
+// Items are updated incrementally when they move, so rendering, lasso selection and path finding
+// only need to look at the part of the canvas they care about, instead of every item on it
+// Query results are returned in the order items were added, or the order set with setOrder()
+template<typename T>
+class SpatialIndex {
+    static constexpr int cellSize = 256;
+
+    // Items that cover more cells than this are kept in a separate list that every query checks
+    // Otherwise a single long connection across a huge patch would end up in thousands of cells
+    static constexpr int maxCellsPerItem = 64;
+
+    struct Entry {
+        Rectangle<int> bounds;
+        Rectangle<int> cells;
+        uint32_t order;
+        uint32_t queryStamp;
+        bool oversized;
+    };
+
+public:
+    void update(T* item, Rectangle<int> const bounds)
+    {
+        auto const cells = getCellRange(bounds);
+        auto const oversized = cells.getWidth() * cells.getHeight() > maxCellsPerItem;
+
+        auto [it, inserted] = entries.try_emplace(item, Entry { bounds, cells, nextOrder, 0, oversized });
+        auto& entry = it->second;
+
+        if (inserted) {
+            nextOrder++;
+            addToCells(item, entry);
+            return;
+        }
+
+        entry.bounds = bounds;
+        if (entry.cells == cells && entry.oversized == oversized)
+            return;
+
+        removeFromCells(item, entry);
+        entry.cells = cells;
+        entry.oversized = oversized;
+        addToCells(item, entry);
+    }
+
+    void remove(T* item)
+    {
+        auto const it = entries.find(item);
+        if (it == entries.end())
+            return;
+
+        removeFromCells(item, it->second);
+        entries.erase(it);
+    }
+
+    void setOrder(T* item, uint32_t const order)
+    {
+        if (auto const it = entries.find(item); it != entries.end()) {
+            it->second.order = order;
+            nextOrder = std::max(nextOrder, order + 1);
+        }
+    }
+
+    void clear()
+    {
+        entries.clear();
+        grid.clear();
+        oversizedItems.clear();
+        nextOrder = 0;
+    }
+
+    // Collects all items whose bounds intersect with area, sorted by their order
+    template<typename Container>
+    void query(Rectangle<int> const area, Container& result)
+    {
+        result.clear();
+
+        if (++currentStamp == 0) {
+            // Stamp wrapped around, make sure no entry looks like it was already visited
+            for (auto& [item, entry] : entries)
+                entry.queryStamp = 0;
+            currentStamp = 1;
+        }
+
+        auto const cells = getCellRange(area);
+
+        // When zoomed far out, walking all cells would be slower than checking every item
+        if (static_cast<size_t>(cells.getWidth()) * static_cast<size_t>(cells.getHeight()) > entries.size()) {
+            for (auto& [item, entry] : entries) {
+                if (entry.bounds.intersects(area))
+                    result.add(item);
+            }
+        } else {
+            for (int y = cells.getY(); y < cells.getBottom(); y++) {
+                for (int x = cells.getX(); x < cells.getRight(); x++) {
+                    auto const cell = grid.find(getCellKey(x, y));
+                    if (cell == grid.end())
+                        continue;
+
+                    for (auto* item : cell->second)
+                        visit(item, area, result);
+                }
+            }
+
+            for (auto* item : oversizedItems)
+                visit(item, area, result);
+        }
+
+        std::sort(result.begin(), result.end(), [this](T* a, T* b) {
+            return entries[a].order < entries[b].order;
+        });
+    }
+
+    template<typename Container>
+    void query(Point<int> const position, Container& result)
+    {
+        query(Rectangle<int>(position.x, position.y, 1, 1), result);
+    }
+
+    size_t size() const
+    {
+        return entries.size();
+    }
+
+private:
+    template<typename Container>
+    void visit(T* item, Rectangle<int> const area, Container& result)
+    {
+        auto& entry = entries[item];
+        if (entry.queryStamp == currentStamp)
+            return;
+
+        entry.queryStamp = currentStamp;
+        if (entry.bounds.intersects(area))
+            result.add(item);
+    }
+
+    void addToCells(T* item, Entry const& entry)
+    {
+        if (entry.oversized) {
+            oversizedItems.add(item);
+            return;
+        }
+
+        for (int y = entry.cells.getY(); y < entry.cells.getBottom(); y++) {
+            for (int x = entry.cells.getX(); x < entry.cells.getRight(); x++) {
+                grid[getCellKey(x, y)].add(item);
+            }
+        }
+    }
+
+    void removeFromCells(T* item, Entry const& entry)
+    {
+        if (entry.oversized) {
+            oversizedItems.remove_one(item);
+            return;
+        }
+
+        for (int y = entry.cells.getY(); y < entry.cells.getBottom(); y++) {
+            for (int x = entry.cells.getX(); x < entry.cells.getRight(); x++) {
+                auto const cell = grid.find(getCellKey(x, y));
+                if (cell == grid.end())
+                    continue;
+
+                cell->second.remove_one(item);
+                if (cell->second.empty())
+                    grid.erase(cell);
+            }
+        }
+    }
+
+    static int getCell(int const coordinate)
+    {
+        // Round towards negative infinity, so negative coordinates don't share a cell with positive ones
+        return coordinate >= 0 ? coordinate / cellSize : (coordinate + 1) / cellSize - 1;
+    }
+
+    static Rectangle<int> getCellRange(Rectangle<int> const bounds)
+    {
+        auto const left = getCell(bounds.getX());
+        auto const top = getCell(bounds.getY());
+        auto const right = getCell(bounds.getRight()) + 1;
+        auto const bottom = getCell(bounds.getBottom()) + 1;
+        return { left, top, right - left, bottom - top };
+    }
+
+    static uint64_t getCellKey(int const x, int const y)
+    {
+        return static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32 | static_cast<uint32_t>(y);
+    }
+
+    UnorderedMap<T*, Entry> entries;
+    UnorderedMap<uint64_t, SmallArray<T*, 8>> grid;
+    SmallArray<T*> oversizedItems;
+
+    uint32_t nextOrder = 0;
+    uint32_t currentStamp = 0;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+// Counts heap allocations on the current thread while enabled, so we can check that code is real-time safe
+// This replaces the global allocation functions, which is fine because this header is only part of test builds
+static thread_local bool countAllocations = false;
+static thread_local int numAllocations = 0;
+
+static void* countedAllocation(std::size_t size)
+{
+    if(countAllocations)
+        numAllocations++;
+
+    if(auto* ptr = std::malloc(size ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) { return countedAllocation(size); }
+void* operator new[](std::size_t size) { return countedAllocation(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
@@ -0,0 +1,88 @@
+#include "Statusbar.h"
+
+class AudioLevelMeterTest : public PlugDataUnitTest
+{
+public:
+    AudioLevelMeterTest(PluginEditor* editor) : PlugDataUnitTest(editor, "Audio Level Meter Test")
+    {
+    }
+
+private:
+    void perform() override
+    {
+        bool result = measuresLevels();
+        result = keepsPeaksBetweenReads() && result;
+        signalDone(result);
+    }
+
+    // Negative samples should count towards the peak, and the RMS of a full scale square wave is 1
+    bool measuresLevels()
+    {
+        beginTest("Peak, RMS and clipping");
+
+        constexpr int numChannels = 8;
+        constexpr int blockSize = 37; // Not a multiple of the vector size, so the remainder gets tested too
+
+        StatusbarSource::AudioLevelMeter meter;
+        meter.reset(numChannels);
+
+        AudioBuffer<float> buffer(numChannels, blockSize);
+        buffer.clear();
+        for(int i = 0; i < blockSize; i++)
+        {
+            buffer.setSample(0, i, i % 2 ? 1.0f : -1.0f);
+            buffer.setSample(1, i, -0.5f);
+        }
+        buffer.setSample(numChannels - 1, blockSize - 1, 1.5f);
+
+        meter.write(buffer);
+        auto const& levels = meter.read();
+
+        bool result = levels.size() == numChannels;
+        result = result && approximatelyEqual(levels[0].peak, 1.0f) && approximatelyEqual(levels[0].rms, 1.0f) && levels[0].clipped;
+        result = result && approximatelyEqual(levels[1].peak, 0.5f) && approximatelyEqual(levels[1].rms, 0.5f) && !levels[1].clipped;
+        result = result && levels[2].peak == 0.0f && levels[2].rms == 0.0f;
+        result = result && approximatelyEqual(levels[numChannels - 1].peak, 1.5f) && levels[numChannels - 1].clipped;
+        expect(result, "Measured levels are wrong");
+        return result;
+    }
+
+    // Many small blocks between two reads should give the same peak as one large block
+    bool keepsPeaksBetweenReads()
+    {
+        beginTest("Accumulate small blocks");
+
+        constexpr int blockSize = 32;
+        constexpr int numBlocks = 100;
+
+        StatusbarSource::AudioLevelMeter meter;
+        meter.reset(2);
+
+        AudioBuffer<float> buffer(2, blockSize);
+        float expectedPeak = 0.0f;
+        for(int block = 0; block < numBlocks; block++)
+        {
+            for(int i = 0; i < blockSize; i++)
+            {
+                auto const sample = rng.nextFloat() * 1.8f - 0.9f;
+                buffer.setSample(0, i, sample);
+                buffer.setSample(1, i, sample);
+                expectedPeak = std::max(expectedPeak, std::abs(sample));
+            }
+            meter.write(buffer);
+        }
+
+        bool result = approximatelyEqual(meter.read()[0].peak, expectedPeak);
+
+        // Nothing was processed since, so the same levels should come back
+        result = result && approximatelyEqual(meter.read()[1].peak, expectedPeak);
+
+        // After a read, measuring starts over
+        buffer.clear();
+        meter.write(buffer);
+        result = result && meter.read()[0].peak == 0.0f;
+
+        expect(result, "Peaks between reads were lost");
+        return result;
+    }
+};
@@ -0,0 +1,184 @@
+#include "Utility/AudioMidiFifo.h"
+#include "AllocationCounter.h"
+
+class AudioMidiFifoTest : public PlugDataUnitTest
+{
+public:
+    AudioMidiFifoTest(PluginEditor* editor) : PlugDataUnitTest(editor, "Audio Midi Fifo Test")
+    {
+    }
+
+private:
+    void perform() override
+    {
+        bool result = processRandomBlockSizes();
+        result = overflowKeepsEvents(AudioMidiFifo::MidiOverflowPolicy::DropNewest) && result;
+        result = overflowKeepsEvents(AudioMidiFifo::MidiOverflowPolicy::DropOldest) && result;
+        result = parameterChangesFollowAudio() && result;
+        signalDone(result);
+    }
+
+    // Does the same as PluginProcessor::processVariable, with random host block sizes and a note on every other sample
+    // Every note number encodes the position it was sent at, so we can check that the timing survives the fifo
+    bool processRandomBlockSizes()
+    {
+        beginTest("Random host block sizes with dense MIDI");
+
+        constexpr int maxHostBlockSize = 4096;
+        constexpr int pdBlockSize = 64;
+        constexpr int numBlocks = 2000;
+
+        AudioMidiFifo inputFifo(2, maxHostBlockSize * 3);
+        AudioMidiFifo outputFifo(2, maxHostBlockSize * 3);
+        outputFifo.writeSilence(pdBlockSize);
+
+        AudioBuffer<float> hostBuffer(2, maxHostBlockSize);
+        AudioBuffer<float> pdBuffer(2, pdBlockSize);
+        hostBuffer.clear();
+
+        MidiBuffer hostMidi, pdMidi, noMidi;
+        hostMidi.ensureSize(maxHostBlockSize * 16);
+        pdMidi.ensureSize(pdBlockSize * 16);
+
+        int64 hostPosition = 0;
+        int64 pdPosition = 0;
+        int numSent = 0;
+        int numReceived = 0;
+        bool timingCorrect = true;
+
+        numAllocations = 0;
+        countAllocations = true;
+        for(int block = 0; block < numBlocks; block++)
+        {
+            auto const blockSize = rng.nextInt({ 1, maxHostBlockSize + 1 });
+            auto hostBlock = dsp::AudioBlock<float>(hostBuffer).getSubBlock(0, blockSize);
+
+            hostMidi.clear();
+            for(int i = static_cast<int>(hostPosition % 2); i < blockSize; i += 2)
+            {
+                uint8 const noteOn[3] = { 0x90, static_cast<uint8>((hostPosition + i) % 128), 100 };
+                hostMidi.addEvent(noteOn, 3, i);
+                numSent++;
+            }
+            inputFifo.writeAudioAndMidi(hostBlock, hostMidi);
+            hostPosition += blockSize;
+
+            while(outputFifo.getNumSamplesAvailable() < blockSize)
+            {
+                pdMidi.clear();
+                inputFifo.readAudioAndMidi(pdBuffer, pdMidi);
+
+                for(auto const metadata : pdMidi)
+                {
+                    timingCorrect = timingCorrect && metadata.data[1] == (pdPosition + metadata.samplePosition) % 128;
+                    numReceived++;
+                }
+                pdPosition += pdBlockSize;
+
+                outputFifo.writeAudioAndMidi(pdBuffer, noMidi);
+            }
+
+            hostMidi.clear();
+            outputFifo.readAudioAndMidi(hostBlock, hostMidi);
+        }
+        countAllocations = false;
+
+        // Whatever Pd hasn't processed yet is still in the input fifo
+        auto const numPending = static_cast<int>((hostPosition - pdPosition + 1) / 2);
+
+        expectEquals(numAllocations, 0, "Allocated on the audio thread");
+        expect(timingCorrect, "MIDI events arrived at the wrong sample position");
+        expectEquals(numReceived + numPending, numSent, "MIDI events went missing");
+        expectEquals(inputFifo.getNumDroppedMidiEvents(), 0);
+
+        return numAllocations == 0 && timingCorrect && numReceived + numPending == numSent && inputFifo.getNumDroppedMidiEvents() == 0;
+    }
+
+    // Sends much more MIDI than the fifo can hold, the overflow policy decides which events survive
+    bool overflowKeepsEvents(AudioMidiFifo::MidiOverflowPolicy policy)
+    {
+        auto const dropOldest = policy == AudioMidiFifo::MidiOverflowPolicy::DropOldest;
+        beginTest(dropOldest ? "Overflow drops oldest events" : "Overflow drops newest events");
+
+        constexpr int blockSize = 4096;
+
+        AudioMidiFifo fifo(1, blockSize, policy);
+        AudioBuffer<float> buffer(1, blockSize);
+        buffer.clear();
+
+        MidiBuffer midi;
+        for(int i = 0; i < blockSize; i++)
+        {
+            midi.addEvent(MidiMessage::controllerEvent(1, 1, i % 128), i);
+        }
+        fifo.writeAudioAndMidi(buffer, midi);
+
+        midi.clear();
+        fifo.readAudioAndMidi(buffer, midi);
+
+        auto const numReceived = midi.getNumEvents();
+        auto const firstPosition = midi.getFirstEventTime();
+        auto const lastPosition = midi.getLastEventTime();
+
+        bool const countsMatch = numReceived + fifo.getNumDroppedMidiEvents() == blockSize && fifo.getNumDroppedMidiEvents() > 0;
+        bool const keptRightEvents = dropOldest ? lastPosition == blockSize - 1 : firstPosition == 0;
+
+        expect(countsMatch, "Dropped events weren't counted");
+        expect(keptRightEvents, "Overflow policy kept the wrong events");
+        logMessage(String(numReceived) + " events kept, " + String(fifo.getNumDroppedMidiEvents()) + " dropped");
+
+        return countsMatch && keptRightEvents;
+    }
+
+    // Writes a parameter change at the start of every host block, where the value is the block's position
+    // Every change should come out in the Pd block that contains that position, at the right offset
+    bool parameterChangesFollowAudio()
+    {
+        beginTest("Parameter changes stay aligned with audio");
+
+        constexpr int maxHostBlockSize = 1024;
+        constexpr int pdBlockSize = 64;
+        constexpr int numBlocks = 2000;
+
+        AudioMidiFifo fifo(1, maxHostBlockSize * 3);
+        AudioBuffer<float> hostBuffer(1, maxHostBlockSize);
+        AudioBuffer<float> pdBuffer(1, pdBlockSize);
+        hostBuffer.clear();
+
+        MidiBuffer noMidi;
+        int64 hostPosition = 0;
+        int64 pdPosition = 0;
+        int numSent = 0;
+        int numReceived = 0;
+        bool timingCorrect = true;
+
+        for(int block = 0; block < numBlocks; block++)
+        {
+            auto const blockSize = rng.nextInt({ 1, maxHostBlockSize + 1 });
+            fifo.writeParameterChange(block % 8, static_cast<float>(hostPosition), 0, blockSize);
+            fifo.writeAudioAndMidi(dsp::AudioBlock<float>(hostBuffer).getSubBlock(0, blockSize), noMidi);
+            hostPosition += blockSize;
+            numSent++;
+
+            while(fifo.getNumSamplesAvailable() >= pdBlockSize)
+            {
+                fifo.readParameterChanges(pdBlockSize, [&](AudioMidiFifo::ParameterChange const& change) {
+                    timingCorrect = timingCorrect && change.value == static_cast<float>(pdPosition + change.offset) && change.offset < pdBlockSize;
+                    numReceived++;
+                });
+                fifo.readAudioAndMidi(pdBuffer, noMidi);
+                pdPosition += pdBlockSize;
+            }
+        }
+
+        // Drain what is left, in case the last host blocks started after the last full Pd block
+        fifo.readParameterChanges(maxHostBlockSize * 3, [&](AudioMidiFifo::ParameterChange const&) {
+            numReceived++;
+        });
+
+        expect(timingCorrect, "Parameter changes arrived at the wrong sample position");
+        expectEquals(numReceived, numSent, "Parameter changes went missing");
+
+        return timingCorrect && numReceived == numSent;
+    }
+};
@@ -0,0 +1,145 @@
+class CanvasSynchroniseTest : public PlugDataUnitTest
+{
+public:
+    CanvasSynchroniseTest(PluginEditor* editor) : PlugDataUnitTest(editor, "Canvas Synchronise Test")
+    {
+    }
+
+private:
+    void perform() override
+    {
+        bool result = true;
+        for(auto numObjects : { 100, 1000, 10000 })
+        {
+            result = synchroniseGeneratedPatch(numObjects) && result;
+        }
+        result = synchronisesChanges() && result;
+
+        signalDone(result);
+    }
+
+    // Generates a chain of [+ 1] objects, connected in series, and measures how long it takes to synchronise it
+    bool synchroniseGeneratedPatch(int numObjects)
+    {
+        beginTest("Synchronise " + String(numObjects) + " objects");
+
+        String patch = "#N canvas 0 0 1000 1000 12;\n";
+        for(int i = 0; i < numObjects; i++)
+        {
+            patch += "#X obj " + String((i % 40) * 50) + " " + String((i / 40) * 30) + " + 1;\n";
+        }
+        for(int i = 1; i < numObjects; i++)
+        {
+            patch += "#X connect " + String(i - 1) + " 0 " + String(i) + " 0;\n";
+        }
+
+        auto& tabbar = editor->getTabComponent();
+        auto* cnv = tabbar.openPatch(patch);
+
+        constexpr int numRounds = 10;
+        auto const startTime = Time::getMillisecondCounterHiRes();
+        for(int round = 0; round < numRounds; round++)
+        {
+            cnv->performSynchronise();
+        }
+        auto const elapsed = (Time::getMillisecondCounterHiRes() - startTime) / numRounds;
+
+        logMessage(String(numObjects) + " objects: " + String(elapsed, 2) + " ms per synchronise");
+
+        bool result = cnv->objects.size() == numObjects && cnv->connections.size() == numObjects - 1;
+        expect(result, "Canvas doesn't match the generated patch");
+
+        // The spatial index should find exactly the same objects as checking all of them
+        auto const area = Rectangle<int>(cnv->canvasOrigin.x + 300, cnv->canvasOrigin.y + 300, 400, 200);
+        SmallArray<Object*> found;
+        cnv->objectSpatialIndex.query(area, found);
+
+        SmallArray<Object*> expected;
+        for(auto* object : cnv->objects)
+        {
+            if(object->getBounds().intersects(area))
+                expected.add(object);
+        }
+
+        bool const indexMatches = found == expected;
+        expect(indexMatches, "Spatial index query doesn't match the objects in the area");
+        result = result && indexMatches;
+
+        tabbar.closeTab(cnv);
+        return result;
+    }
+
+    // Changes the patch in pd the way editing, undo and dynamic patching do, and checks that the canvas picks up every change
+    // Plain text boxes that didn't change are skipped when synchronising, so this makes sure that changes are never mistaken for no change
+    bool synchronisesChanges()
+    {
+        auto& tabbar = editor->getTabComponent();
+        auto* cnv = tabbar.openPatch("#N canvas 0 0 1000 1000 12;\n#X obj 20 20 + 1;\n#X obj 120 20 - 2;\n#X obj 220 20 * 3;\n#X connect 0 0 1 0;\n");
+        auto& patch = cnv->patch;
+        auto* glist = patch.getRawPointer();
+
+        auto getPdObject = [&patch](int index) {
+            auto objects = patch.getObjects();
+            return index < objects.size() ? objects[index].getRaw<t_gobj>() : nullptr;
+        };
+
+        auto synchroniseAndCheck = [this, cnv, &patch](String const& change) {
+            cnv->performSynchronise();
+
+            auto pdObjects = patch.getObjects();
+            bool matches = cnv->objects.size() == pdObjects.size();
+            for(int i = 0; matches && i < pdObjects.size(); i++)
+            {
+                auto* object = cnv->objects[i];
+                auto* checkedObject = pd::Interface::checkObject(pdObjects[i].getRaw<t_gobj>());
+                matches = object->getPointer() == pdObjects[i].getRaw<t_gobj>() && object->gui && checkedObject;
+                matches = matches && object->getObjectBounds() == object->gui->getPdBounds();
+                matches = matches && object->iolets.size() == pd::Interface::numInlets(checkedObject) + pd::Interface::numOutlets(checkedObject);
+            }
+            expect(matches, "Canvas doesn't match the patch after " + change);
+            return matches;
+        };
+
+        bool result = true;
+
+        beginTest("Synchronise edited objects");
+        editor->pd->lockAudioThread();
+        patch.moveObjectTo(getPdObject(0), 60, 300);
+        editor->pd->unlockAudioThread();
+        result = synchroniseAndCheck("moving an object") && result;
+
+        editor->pd->lockAudioThread();
+        pd::Interface::checkObject(getPdObject(1))->te_width = 20;
+        editor->pd->unlockAudioThread();
+        result = synchroniseAndCheck("resizing an object") && result;
+
+        editor->pd->lockAudioThread();
+        patch.renameObject(pd::Interface::checkObject(getPdObject(2)), "t b b b");
+        editor->pd->unlockAudioThread();
+        result = synchroniseAndCheck("retyping an object") && result;
+
+        beginTest("Synchronise added objects");
+        editor->pd->lockAudioThread();
+        patch.createObject(320, 20, "+ 5");
+        patch.createObject(420, 20, "f");
+        editor->pd->unlockAudioThread();
+        result = synchroniseAndCheck("adding objects") && result;
+
+        beginTest("Synchronise reordered objects");
+        editor->pd->lockAudioThread();
+        pd::Interface::toFront(glist, getPdObject(0));
+        pd::Interface::toBack(glist, getPdObject(3));
+        editor->pd->unlockAudioThread();
+        result = synchroniseAndCheck("reordering objects") && result;
+
+        beginTest("Synchronise removed objects");
+        editor->pd->lockAudioThread();
+        patch.removeObjects({ getPdObject(1), getPdObject(3) });
+        patch.finishRemove();
+        editor->pd->unlockAudioThread();
+        result = synchroniseAndCheck("removing objects") && result;
+
+        tabbar.closeTab(cnv);
+        return result;
+    }
+};
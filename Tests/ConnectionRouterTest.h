@@ -0,0 +1,129 @@
+#include "Utility/ConnectionRouter.h"
+
+class ConnectionRouterTest : public PlugDataUnitTest
+{
+public:
+    ConnectionRouterTest(PluginEditor* editor) : PlugDataUnitTest(editor, "Connection Router Test")
+    {
+    }
+
+private:
+    void perform() override
+    {
+        bool result = routesAroundObstacle();
+        result = routesLargeBatch() && result;
+        signalDone(result);
+    }
+
+    // A single object between outlet and inlet should be avoided, without going through either of the connected objects
+    bool routesAroundObstacle()
+    {
+        beginTest("Route around obstacle");
+
+        auto const source = Rectangle<int>(100, 100, 60, 30);
+        auto const obstacle = Rectangle<int>(80, 200, 100, 30);
+        auto const sink = Rectangle<int>(100, 300, 60, 30);
+
+        ConnectionRouter router;
+        router.setObstacles({ source, obstacle, sink });
+
+        auto const path = router.route({ 120.0f, 128.0f }, { 120.0f, 302.0f }, source, sink);
+        expect(path.size() >= 2, "No path was found");
+
+        bool const avoidsObjects = !pathIntersects(path, obstacle) && !pathIntersects(path, source.withTrimmedBottom(3)) && !pathIntersects(path, sink.withTrimmedTop(3));
+        expect(avoidsObjects, "Path goes through an object");
+
+        return path.size() >= 2 && avoidsObjects;
+    }
+
+    // Routes connections through a dense grid of objects, this should take well under a second
+    // There is always a way through the gaps between the objects, so nearly all of them should be routed rather than fall back to the default path
+    // Every path that was found has to be valid: orthogonal, connecting the outlet to the inlet, and not going through any object
+    bool routesLargeBatch()
+    {
+        beginTest("Route 500 connections");
+
+        constexpr double maxMilliseconds = 1000.0;
+        constexpr int minRouted = 490;
+
+        SmallArray<Rectangle<int>> objects;
+        for(int i = 0; i < 1000; i++)
+        {
+            objects.add(Rectangle<int>((i % 40) * 90, (i / 40) * 60, 60, 25));
+        }
+
+        ConnectionRouter router;
+        router.setObstacles(objects);
+
+        struct RoutedPath
+        {
+            int source;
+            int sink;
+            Point<float> start;
+            Point<float> end;
+            ConnectionRouter::Path path;
+        };
+        SmallArray<RoutedPath> paths;
+
+        auto const startTime = Time::getMillisecondCounterHiRes();
+        for(int i = 0; i < 500; i++)
+        {
+            auto const sinkIndex = (i * 7 + 43) % objects.size();
+            auto const& source = objects[i];
+            auto const& sink = objects[sinkIndex];
+            auto const start = source.getBottomLeft().toFloat() + Point<float>(5, -2);
+            auto const end = sink.getTopLeft().toFloat() + Point<float>(5, 2);
+            auto path = router.route(start, end, source, sink);
+            if(path.not_empty())
+                paths.add({ i, static_cast<int>(sinkIndex), start, end, std::move(path) });
+        }
+        auto const elapsed = Time::getMillisecondCounterHiRes() - startTime;
+
+        auto const numRouted = static_cast<int>(paths.size());
+        auto const& statistics = router.getStatistics();
+        logMessage(String(numRouted) + " of 500 connections routed in " + String(elapsed, 2) + " ms, " + String(statistics.numOverBudget) + " over budget, " + String(statistics.numUnreachable) + " without a path");
+        expect(numRouted >= minRouted, String(500 - numRouted) + " connections fell back to the default path");
+        expectEquals(statistics.numOverBudget + statistics.numUnreachable, 500 - numRouted, "Fallbacks weren't counted");
+        expect(elapsed < maxMilliseconds, "Routing took " + String(elapsed, 2) + " ms, that's more than " + String(maxMilliseconds, 0) + " ms");
+
+        int numInvalid = 0;
+        for(auto const& routed : paths)
+        {
+            auto const& path = routed.path;
+            bool valid = path.size() >= 2 && path.front() == routed.start && path.back() == routed.end;
+
+            for(int i = 1; valid && i < path.size(); i++)
+            {
+                valid = path[i - 1].x == path[i].x || path[i - 1].y == path[i].y;
+            }
+
+            // The path leaves its source through the bottom edge, and enters its sink through the top edge
+            for(int object = 0; valid && object < objects.size(); object++)
+            {
+                auto bounds = objects[object];
+                if(object == routed.source)
+                    bounds = bounds.withTrimmedBottom(3);
+                if(object == routed.sink)
+                    bounds = bounds.withTrimmedTop(3);
+
+                valid = !pathIntersects(path, bounds);
+            }
+
+            numInvalid += !valid;
+        }
+        expectEquals(numInvalid, 0, "Paths were not orthogonal, not connected, or went through objects");
+
+        return numRouted >= minRouted && elapsed < maxMilliseconds && numInvalid == 0;
+    }
+
+    static bool pathIntersects(ConnectionRouter::Path const& path, Rectangle<int> const bounds)
+    {
+        for(int i = 1; i < path.size(); i++)
+        {
+            auto const segment = Rectangle<float>(path[i - 1], path[i]).expanded(0.5f);
+            if(segment.intersects(bounds.toFloat()))
+                return true;
+        }
+        return false;
+    }
+};
@@ -0,0 +1,120 @@
+#include "Pd/DirectMessageQueue.h"
+
+class DirectMessageQueueTest : public PlugDataUnitTest
+{
+public:
+    DirectMessageQueueTest(PluginEditor* editor) : PlugDataUnitTest(editor, "Direct Message Queue Test")
+    {
+    }
+
+private:
+    void perform() override
+    {
+        bool result = coalescesPerTarget();
+        result = overflowsWhenFull() && result;
+        result = deliversBeforeQueuedFunctions() && result;
+        signalDone(result);
+    }
+
+    // Only the newest coalescing message per target is delivered, other messages all arrive in order
+    bool coalescesPerTarget()
+    {
+        beginTest("Coalesce per target");
+
+        int targets[2];
+        pd::DirectMessageQueue queue(editor->pd);
+
+        for(int i = 0; i < 10; i++)
+        {
+            auto const value = pd::Atom(static_cast<float>(i));
+            queue.push(&targets[0], pd::DirectMessageQueue::SetAndBang, nullptr, &value, 1, true);
+            queue.push(&targets[1], pd::DirectMessageQueue::Float, nullptr, &value, 1);
+        }
+
+        SmallArray<std::pair<void*, float>> delivered;
+        editor->pd->lockAudioThread();
+        queue.drain([&delivered](pd::DirectMessageQueue::Command const& command) {
+            delivered.add({ command.target, command.atoms[0].getFloat() });
+        });
+        editor->pd->unlockAudioThread();
+
+        bool result = delivered.size() == 11 && !queue.hasPendingMessages();
+        for(int i = 0; result && i < 10; i++)
+        {
+            result = delivered[i].first == &targets[1] && delivered[i].second == static_cast<float>(i);
+        }
+        result = result && delivered.back().first == &targets[0] && delivered.back().second == 9.0f;
+        expect(result, "Coalesced messages were not delivered once, or the other messages were out of order");
+        return result;
+    }
+
+    // A full queue refuses new messages and counts them, so the caller can send them synchronously
+    bool overflowsWhenFull()
+    {
+        beginTest("Overflow");
+
+        int target = 0;
+        pd::DirectMessageQueue queue(editor->pd);
+        auto const value = pd::Atom(1.0f);
+
+        int numPushed = 0;
+        for(int i = 0; i < pd::DirectMessageQueue::Capacity + 10; i++)
+        {
+            numPushed += queue.push(&target, pd::DirectMessageQueue::Float, nullptr, &value, 1);
+        }
+
+        expectEquals(numPushed, pd::DirectMessageQueue::Capacity);
+        auto const numOverflowed = queue.takeNumOverflowed();
+        expectEquals(numOverflowed, 10);
+        expectEquals(queue.takeNumOverflowed(), 0, "The overflow count wasn't reset");
+
+        // Draining makes room again
+        int numDelivered = 0;
+        editor->pd->lockAudioThread();
+        queue.drain([&numDelivered](pd::DirectMessageQueue::Command const&) { numDelivered++; });
+        editor->pd->unlockAudioThread();
+        auto const acceptsAgain = queue.push(&target, pd::DirectMessageQueue::Float, nullptr, &value, 1);
+        expect(acceptsAgain, "The queue didn't accept messages after draining");
+
+        return numPushed == pd::DirectMessageQueue::Capacity && numOverflowed == 10 && numDelivered == numPushed && acceptsAgain;
+    }
+
+    // Direct messages used to be sent right away, so they have to arrive before functions that were queued around them
+    bool deliversBeforeQueuedFunctions()
+    {
+        beginTest("Order relative to queued functions");
+
+        // A processor of its own, so that the audio thread of the app doesn't run the queues while we fill them
+        auto processor = std::make_unique<PluginProcessor>();
+        processor->setThis();
+        auto patch = processor->loadPatch("#N canvas 0 0 400 300 12;\n#X obj 20 20 value dmq_test_value;\n");
+        auto objects = patch->getObjects();
+        auto* value = objects.size() == 1 ? objects[0].getRaw<t_pd>() : nullptr;
+        expect(value != nullptr, "Couldn't create [value]");
+
+        SmallArray<float> seen;
+        auto readValue = [&seen]() {
+            t_float result = -1.0f;
+            value_getfloat(gensym("dmq_test_value"), &result);
+            seen.add(result);
+        };
+
+        if(value)
+        {
+            processor->enqueueFunctionAsync(readValue);
+            processor->sendDirectMessage(value, 1.0f);
+            processor->enqueueFunctionAsync(readValue);
+            processor->sendDirectMessage(value, 2.0f);
+            processor->sendMessagesFromQueue();
+        }
+
+        auto const result = seen.size() == 2 && seen[0] == 2.0f && seen[1] == 2.0f;
+        expect(result, "Queued functions ran before the direct messages that were sent around them");
+
+        patch = nullptr;
+        processor.reset();
+        editor->pd->setThis();
+
+        return result;
+    }
+};
@@ -0,0 +1,90 @@
+#include "Pd/Library.h"
+
+#if JUCE_MAC
+#    include <mach/mach.h>
+#elif JUCE_LINUX || JUCE_BSD
+#    include <unistd.h>
+#endif
+
+class DocumentationSharingTest : public PlugDataUnitTest
+{
+public:
+    DocumentationSharingTest(PluginEditor* editor) : PlugDataUnitTest(editor, "Documentation Sharing Test")
+    {
+    }
+
+private:
+    void perform() override
+    {
+        bool result = true;
+        for(auto numInstances : { 1, 4, 8 })
+        {
+            result = sharesDocumentation(numInstances) && result;
+        }
+
+        // Creating processors changes the active pd instance
+        editor->pd->setThis();
+
+        signalDone(result);
+    }
+
+    // Creates plugin processors, like a host would for every plugin instance, they should all use the documentation that was already loaded
+    // Measures how much resident memory every processor adds, which would include the documentation if it wasn't shared
+    bool sharesDocumentation(int numInstances)
+    {
+        beginTest("Share documentation between " + String(numInstances) + " processors");
+
+        auto& documentation = editor->pd->objectLibrary->getDocumentation();
+        auto const documentationSize = documentation.getMemoryUsage();
+
+        auto const memoryBefore = getResidentMemory();
+        auto const startTime = Time::getMillisecondCounterHiRes();
+
+        OwnedArray<PluginProcessor> processors;
+        for(int i = 0; i < numInstances; i++)
+        {
+            processors.add(new PluginProcessor());
+        }
+        auto const elapsed = Time::getMillisecondCounterHiRes() - startTime;
+        auto const memoryAfter = getResidentMemory();
+
+        bool allShared = true;
+        for(auto* processor : processors)
+        {
+            allShared = allShared && &processor->objectLibrary->getDocumentation() == &documentation;
+        }
+        expect(allShared, "Processor loaded its own copy of the documentation");
+
+        String message = String(numInstances) + " processors ready in " + String(elapsed, 2) + " ms";
+        if(memoryBefore > 0 && memoryAfter > 0)
+        {
+            auto const perInstance = (memoryAfter - std::min(memoryBefore, memoryAfter)) / static_cast<size_t>(numInstances);
+            message += ", " + File::descriptionOfSizeInBytes(static_cast<int64>(perInstance)) + " resident memory per processor";
+        }
+        message += ", the shared documentation is " + File::descriptionOfSizeInBytes(static_cast<int64>(documentationSize));
+        logMessage(message);
+
+        processors.clear();
+        editor->pd->setThis();
+
+        return allShared;
+    }
+
+    // Resident memory of this process in bytes, or 0 if we can't tell on this platform
+    static size_t getResidentMemory()
+    {
+#if JUCE_LINUX || JUCE_BSD
+        // The second field is the number of resident pages
+        auto const fields = StringArray::fromTokens(File("/proc/self/statm").loadFileAsString(), true);
+        return fields.size() > 1 ? static_cast<size_t>(fields[1].getLargeIntValue()) * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#elif JUCE_MAC
+        mach_task_basic_info info;
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if(task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+            return 0;
+        return static_cast<size_t>(info.resident_size);
+#else
+        return 0;
+#endif
+    }
+};
@@ -0,0 +1,64 @@
+#include "Utility/Decompress.h"
+
+class FilesystemExtractionTest : public PlugDataUnitTest
+{
+public:
+    FilesystemExtractionTest(PluginEditor* editor) : PlugDataUnitTest(editor, "Filesystem Extraction Test")
+    {
+    }
+
+private:
+    void perform() override
+    {
+        signalDone(extractsBundledFilesystem());
+    }
+
+    // Extracts the bundled filesystem the same way we do on first launch, and compares it with the one that was installed
+    // Also serves as a benchmark for first-run extraction
+    bool extractsBundledFilesystem()
+    {
+        beginTest("Extract bundled filesystem");
+
+        auto const tempDir = File::createTempFile("plugdata_extraction_test");
+        tempDir.createDirectory();
+
+        auto const resourceStream = BinaryData::createInputStream(BinaryData::Filesystem);
+        expect(resourceStream != nullptr, "Could not open resource file");
+        if(!resourceStream)
+            return false;
+
+        auto const& resource = BinaryData::resources[BinaryData::Filesystem];
+        SubregionStream filesystem(resourceStream.get(), resource.offset, resource.size, false);
+
+        auto const startTime = Time::getMillisecondCounterHiRes();
+        bool const extracted = Decompress::extractTarXz(filesystem, tempDir);
+        auto const elapsed = Time::getMillisecondCounterHiRes() - startTime;
+
+        expect(extracted, "Extraction failed");
+
+        int numFiles = 0;
+        int64 numBytes = 0;
+        bool allMatch = true;
+        auto const extractedDir = tempDir.getChildFile("plugdata_version");
+        for(auto const& entry : RangedDirectoryIterator(extractedDir, true, "*", File::findFiles))
+        {
+            auto const& file = entry.getFile();
+            auto const installed = ProjectInfo::versionDataDir.getChildFile(file.getRelativePathFrom(extractedDir));
+            if(!installed.existsAsFile() || installed.getSize() != file.getSize())
+            {
+                logMessage("Mismatch: " + file.getRelativePathFrom(extractedDir));
+                allMatch = false;
+            }
+
+            numFiles++;
+            numBytes += file.getSize();
+        }
+
+        logMessage(String(numFiles) + " files (" + File::descriptionOfSizeInBytes(numBytes) + ") extracted in " + String(elapsed, 2) + " ms");
+        expect(numFiles > 0, "No files were extracted");
+        expect(allMatch, "Extracted files don't match the installed filesystem");
+
+        tempDir.deleteRecursively();
+        return extracted && numFiles > 0 && allMatch;
+    }
+};
@@ -57,9 +57,10 @@ private:
         }
 
         StringArray errors;
-        for(auto& [ptr, message, type, length, repeats] : pd->getConsoleMessages())
+        auto& history = pd->getConsoleHistory();
+        for(auto line = history.getVisibleStart(); line < history.getEndLine(); line++)
         {
-            if(type == 1) errors.add(message);
+            if(history.getLine(line).type == 1) errors.add(history.getString(line));
         }
 
         if(!errors.isEmpty())
@@ -0,0 +1,92 @@
+#include "Pd/MessageListener.h"
+
+class MessageDispatcherTest : public PlugDataUnitTest, public pd::MessageListener
+{
+public:
+    MessageDispatcherTest(PluginEditor* editor) : PlugDataUnitTest(editor, "Message Dispatcher Test")
+    {
+    }
+
+private:
+    void perform() override
+    {
+        auto* pd = editor->pd;
+        auto* dispatcher = pd->messageDispatcher.get();
+
+        // Every message gets its own target, otherwise the dispatcher would collapse them into one
+        for(auto& target : targets)
+        {
+            dispatcher->addMessageListener(&target, this);
+        }
+
+        beginTest("Long lists arrive intact");
+
+        HeapArray<t_atom> longList(1000);
+        for(int i = 0; i < longList.size(); i++)
+        {
+            SETFLOAT(&longList[i], static_cast<float>(i));
+        }
+
+        receivedAtoms.clear();
+        enqueue(targets.data(), longList.size(), longList.data());
+        flush();
+
+        bool longListIntact = receivedAtoms.size() == longList.size();
+        for(int i = 0; longListIntact && i < receivedAtoms.size(); i++)
+        {
+            longListIntact = receivedAtoms[i].isFloat() && receivedAtoms[i].getFloat() == static_cast<float>(i);
+        }
+        expect(longListIntact, "List of " + String(longList.size()) + " atoms was not delivered intact");
+
+        beginTest("Dispatch throughput");
+
+        // Goes through the same lock, queue, flush and listener lookup as messages from Pd objects
+        numReceived = 0;
+        auto const startTime = Time::getMillisecondCounterHiRes();
+        for(int round = 0; round < numRounds; round++)
+        {
+            pd->lockAudioThread();
+            for(auto& target : targets)
+            {
+                dispatcher->enqueueMessage(pd, 0, &target, gensym("list"), 4, longList.data());
+            }
+            pd->unlockAudioThread();
+            flush();
+        }
+        auto const elapsed = Time::getMillisecondCounterHiRes() - startTime;
+
+        expectEquals(numReceived, numRounds * static_cast<int>(targets.size()));
+        logMessage(String(numReceived / (elapsed / 1000.0), 0) + " messages per second");
+
+        for(auto& target : targets)
+        {
+            dispatcher->removeMessageListener(&target, this);
+        }
+
+        signalDone(true);
+    }
+
+    void enqueue(void* target, int argc, t_atom* argv)
+    {
+        editor->pd->lockAudioThread();
+        pd::MessageDispatcher::enqueueMessage(editor->pd, 0, target, gensym("list"), argc, argv);
+        editor->pd->unlockAudioThread();
+    }
+
+    // Messages get written to the back buffer, it takes two flushes before that becomes the front buffer
+    void flush()
+    {
+        editor->pd->doubleFlushMessageQueue();
+    }
+
+    void receiveMessage(t_symbol* symbol, std::span<pd::Atom const> atoms) override
+    {
+        receivedAtoms.assign(atoms.begin(), atoms.end());
+        numReceived++;
+    }
+
+    static constexpr int numRounds = 1000;
+    StackArray<char, 1024> targets;
+    SmallArray<pd::Atom> receivedAtoms;
+    int numReceived = 0;
+};
@@ -0,0 +1,146 @@
+#include "AllocationCounter.h"
+
+class MidiTimingTest : public PlugDataUnitTest
+{
+public:
+    MidiTimingTest(PluginEditor* editor) : PlugDataUnitTest(editor, "MIDI Timing Test")
+    {
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr double seconds = 5.0;
+    static constexpr double startTime = 1000.0;
+
+    // The time that the MIDI devices and the audio callback see, so we can run faster than real time
+    static inline double currentTime = 0.0;
+    static double getCurrentTime() { return currentTime; }
+
+    void perform() override
+    {
+        // A processor of its own, so the MIDI devices and audio callback of the app don't get in the way
+        auto processor = std::make_unique<PluginProcessor>();
+        processor->oversampling = 0;
+
+        auto& midiDeviceManager = processor->getMidiDeviceManager();
+        midiDeviceManager.setInternalSynthPort(-1);
+        midiDeviceManager.enableTestPort(&getCurrentTime);
+
+        processor->setThis();
+        processor->loadPatch("#N canvas 0 0 400 300 12;\n#X obj 20 20 notein;\n#X obj 20 80 noteout;\n#X connect 0 0 1 0;\n#X connect 0 1 1 1;\n#X connect 0 2 1 2;\n");
+        processor->lockAudioThread();
+        processor->sendMessage("pd", "dsp", { 1.0f });
+        processor->unlockAudioThread();
+
+        // Block sizes that aren't a multiple of Pd's block size go through the audio fifo
+        bool result = true;
+        for(auto hostBlockSize : { 64, 100, 128, 441, 512, 1024, 4096 })
+        {
+            result = loopbackKeepsTiming(*processor, hostBlockSize) && result;
+        }
+
+        processor.reset();
+        editor->pd->setThis();
+
+        signalDone(result);
+    }
+
+    // Sends device input through a [notein] into a [noteout], and collects the output the way a host would
+    // Every event should come out with the same latency, so the time between events is kept to within one sample
+    bool loopbackKeepsTiming(PluginProcessor& processor, int hostBlockSize)
+    {
+        beginTest("Loopback with " + String(hostBlockSize) + " sample host blocks");
+
+        auto& midiDeviceManager = processor.getMidiDeviceManager();
+        processor.prepareToPlay(sampleRate, hostBlockSize);
+
+        auto const msPerSample = 1000.0 / sampleRate;
+        auto const numCallbacks = static_cast<int>(seconds * sampleRate / hostBlockSize);
+
+        AudioBuffer<float> buffer(std::max(1, std::max(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels())), hostBlockSize);
+        MidiBuffer midiBuffer;
+        midiBuffer.ensureSize(4096);
+
+        // Events are numbered by their note and velocity. They are sent in the middle of a sample, so rounding
+        // to the sample they come out at is the same for every event
+        HeapArray<double> expectedPositions(128 * 127, 0.0);
+        HeapArray<double> sentPositions;
+        sentPositions.reserve(static_cast<size_t>(seconds * 1000.0 / 0.1));
+        int nextEvent = 0;
+        int64 nextEventSample = 0;
+
+        int64 hostPosition = 0;
+        int numSent = 0;
+        int numReceived = 0;
+        double minLatency = std::numeric_limits<double>::max();
+        double maxLatency = std::numeric_limits<double>::lowest();
+
+        auto processHostBlock = [&]() {
+            currentTime = startTime + static_cast<double>(hostPosition) * msPerSample;
+
+            buffer.clear();
+            midiBuffer.clear();
+            processor.processBlock(buffer, midiBuffer);
+
+            for(auto const event : midiBuffer)
+            {
+                if(event.numBytes != 3 || (event.data[0] & 0xF0) != 0x90)
+                    continue;
+
+                auto const latency = static_cast<double>(hostPosition + event.samplePosition) - expectedPositions[event.data[1] + (event.data[2] - 1) * 128];
+                minLatency = std::min(minLatency, latency);
+                maxLatency = std::max(maxLatency, latency);
+                numReceived++;
+            }
+
+            hostPosition += hostBlockSize;
+        };
+
+        numAllocations = 0;
+        for(int callback = 0; callback < numCallbacks; callback++)
+        {
+            // The MIDI device thread, events 0.1 to 5 ms apart, that all arrived before this callback
+            while(nextEventSample < hostPosition)
+            {
+                auto message = MidiMessage::noteOn(1, nextEvent % 128, static_cast<uint8>(nextEvent / 128 + 1));
+                message.setTimeStamp((startTime + (static_cast<double>(nextEventSample) + 0.5) * msPerSample) / 1000.0);
+
+                countAllocations = true;
+                midiDeviceManager.addTestInput(message);
+                countAllocations = false;
+
+                expectedPositions[nextEvent] = static_cast<double>(nextEventSample) + 0.5;
+                sentPositions.add(expectedPositions[nextEvent]);
+                nextEvent = (nextEvent + 1) % static_cast<int>(expectedPositions.size());
+                nextEventSample += 5 + rng.nextInt(236);
+                numSent++;
+            }
+
+            processHostBlock();
+        }
+
+        // Events that are still on their way are the ones that should come out after the last block
+        auto const endPosition = static_cast<double>(hostPosition);
+        auto const expectedPending = std::ranges::count_if(sentPositions, [endPosition, maxLatency](double position) {
+            return position + maxLatency >= endPosition;
+        });
+        auto const numPending = numSent - numReceived;
+
+        // Without new input, everything that is left should come out within the latency, which is less than two host blocks and 8192 samples
+        for(int callback = 0; callback < 2 + 8192 / hostBlockSize && numReceived < numSent; callback++)
+        {
+            processHostBlock();
+        }
+
+        logMessage(String(numSent) + " events, latency between " + String(minLatency, 2) + " and " + String(maxLatency, 2) + " samples, " + String(numPending) + " pending after the last block");
+
+        auto const timingCorrect = numReceived > 0 && maxLatency - minLatency < 1.0;
+        expect(timingCorrect, "Latency changed by " + String(maxLatency - minLatency, 2) + " samples");
+        expectEquals(numPending, static_cast<int>(expectedPending), "Wrong number of events pending after the last block");
+        expectEquals(numReceived, numSent, "Events went missing");
+        expectEquals(numAllocations, 0, "Allocated while writing device input");
+        expectEquals(midiDeviceManager.getNumDroppedEvents(), 0, "Events were dropped");
+
+        return timingCorrect && numPending == expectedPending && numReceived == numSent && numAllocations == 0 && midiDeviceManager.getNumDroppedEvents() == 0;
+    }
+};
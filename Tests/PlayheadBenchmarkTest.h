@@ -0,0 +1,191 @@
+#include "Utility/PlayheadSender.h"
+
+class PlayheadBenchmarkTest : public PlugDataUnitTest
+{
+public:
+    PlayheadBenchmarkTest(PluginEditor* editor) : PlugDataUnitTest(editor, "Playhead Benchmark Test")
+    {
+    }
+
+private:
+    static constexpr int hostBlockSize = 32;
+    static constexpr double sampleRate = 96000.0;
+    static constexpr int numBlocks = 30000; // 10 seconds of audio
+
+    // Host transport at 120 bpm in 4/4, that only moves when we tell it to
+    struct TestPlayHead : public AudioPlayHead
+    {
+        Optional<PositionInfo> getPosition() const override
+        {
+            auto const seconds = static_cast<double>(position) / sampleRate;
+            PositionInfo info;
+            info.setIsPlaying(playing);
+            info.setBpm(120.0);
+            info.setTimeSignature(TimeSignature { 4, 4 });
+            info.setTimeInSamples(position);
+            info.setTimeInSeconds(seconds);
+            info.setPpqPosition(seconds * 2.0);
+            info.setPpqPositionOfLastBarStart(std::floor(seconds / 2.0) * 4.0);
+            info.setLoopPoints(LoopPoints { 0.0, 16.0 });
+            return info;
+        }
+
+        bool playing = false;
+        int64 position = 0;
+    };
+
+    void perform() override
+    {
+        bool result = advancesPosition();
+
+        // The idle cases should be cheaper than the old path, which locked and sent every message on every block
+        result = compareWithOldPath("Stopped transport, no [playhead]", false, false, true) && result;
+        result = compareWithOldPath("Stopped transport, with [playhead]", false, true, true) && result;
+        result = compareWithOldPath("Playing transport, with [playhead]", true, true, false) && result;
+
+        signalDone(result);
+    }
+
+    // Pd blocks later in the host block should get the position at their own start
+    bool advancesPosition()
+    {
+        beginTest("Advance position within a host block");
+
+        TestPlayHead playHead;
+        playHead.playing = true;
+        playHead.position = 48000;
+
+        auto state = PlayheadState::fromPosition(*playHead.getPosition());
+        state.advance(48000, sampleRate);
+
+        playHead.position = 96000;
+        auto const expected = PlayheadState::fromPosition(*playHead.getPosition());
+
+        auto const* position = state.values[PlayheadState::Position];
+        auto const* expectedPosition = expected.values[PlayheadState::Position];
+        bool result = true;
+        for(int i = 0; i < 3; i++)
+        {
+            result = result && std::abs(position[i] - expectedPosition[i]) < 1e-9;
+        }
+        expect(result, "Position wasn't advanced correctly");
+
+        // A stopped transport doesn't move
+        playHead.playing = false;
+        auto stopped = PlayheadState::fromPosition(*playHead.getPosition());
+        stopped.advance(48000, sampleRate);
+        auto const stoppedCorrectly = !stopped.differs(PlayheadState::fromPosition(*playHead.getPosition()), PlayheadState::Position);
+        expect(stoppedCorrectly, "Position moved while the transport was stopped");
+
+        return result && stoppedCorrectly;
+    }
+
+    bool compareWithOldPath(String const& name, bool playing, bool withReceiver, bool expectFaster)
+    {
+        beginTest(name);
+
+        auto& tabbar = editor->getTabComponent();
+        Canvas* cnv = nullptr;
+        if(withReceiver)
+            cnv = tabbar.openPatch("#N canvas 0 0 400 300 12;\n#X obj 20 20 playhead;\n");
+
+        auto* pd = editor->pd;
+        pd->setThis();
+
+        TestPlayHead playHead;
+        playHead.playing = playing;
+
+        SmallArray<pd::Atom> atoms;
+        atoms.reserve(3);
+        atoms.resize(1);
+
+        auto startTime = Time::getMillisecondCounterHiRes();
+        for(int block = 0; block < numBlocks; block++)
+        {
+            sendOldPlayhead(playHead, atoms);
+            if(playing)
+                playHead.position += hostBlockSize;
+        }
+        auto const oldElapsed = Time::getMillisecondCounterHiRes() - startTime;
+
+        PlayheadSender sender(*pd);
+        playHead.position = 0;
+
+        startTime = Time::getMillisecondCounterHiRes();
+        for(int block = 0; block < numBlocks; block++)
+        {
+            sender.update(&playHead);
+            sender.send(0, sampleRate);
+            if(playing)
+                playHead.position += hostBlockSize;
+        }
+        auto const newElapsed = Time::getMillisecondCounterHiRes() - startTime;
+
+        auto const toMicroseconds = 1000.0 / numBlocks;
+        logMessage(name + ": " + String(oldElapsed * toMicroseconds, 3) + " us per block before, " + String(newElapsed * toMicroseconds, 3) + " us per block now");
+
+        if(cnv)
+            tabbar.closeTab(cnv);
+
+        if(!expectFaster)
+            return true;
+
+        auto const result = newElapsed < oldElapsed;
+        expect(result, "Sending an unchanged playhead wasn't cheaper than before");
+        return result;
+    }
+
+    // How PluginProcessor::sendPlayhead used to work: lock, and send everything, on every block
+    void sendOldPlayhead(AudioPlayHead const& playhead, SmallArray<pd::Atom>& atoms)
+    {
+        auto* pd = editor->pd;
+        auto infos = playhead.getPosition();
+
+        pd->lockAudioThread();
+        pd->setThis();
+        if(infos.hasValue())
+        {
+            atoms[0] = infos->getIsPlaying();
+            pd->sendMessage("__playhead", "playing", atoms);
+
+            atoms[0] = infos->getIsRecording();
+            pd->sendMessage("__playhead", "recording", atoms);
+
+            atoms[0] = infos->getIsLooping();
+            auto loopPoints = infos->getLoopPoints();
+            atoms.emplace_back(loopPoints.hasValue() ? static_cast<float>(loopPoints->ppqStart) : 0.0f);
+            atoms.emplace_back(loopPoints.hasValue() ? static_cast<float>(loopPoints->ppqEnd) : 0.0f);
+            pd->sendMessage("__playhead", "looping", atoms);
+
+            if(infos->getBpm().hasValue())
+            {
+                atoms.resize(1);
+                atoms[0] = static_cast<float>(*infos->getBpm());
+                pd->sendMessage("__playhead", "bpm", atoms);
+            }
+
+            if(infos->getPpqPositionOfLastBarStart().hasValue())
+            {
+                atoms.resize(1);
+                atoms[0] = static_cast<float>(*infos->getPpqPositionOfLastBarStart());
+                pd->sendMessage("__playhead", "lastbar", atoms);
+            }
+
+            if(infos->getTimeSignature().hasValue())
+            {
+                atoms.resize(1);
+                atoms[0] = static_cast<float>(infos->getTimeSignature()->numerator);
+                atoms.emplace_back(static_cast<float>(infos->getTimeSignature()->denominator));
+                pd->sendMessage("__playhead", "timesig", atoms);
+            }
+
+            atoms.resize(3);
+            atoms[0] = static_cast<float>(infos->getPpqPosition().orFallback(0.0));
+            atoms[1] = static_cast<float>(infos->getTimeInSamples().orFallback(0));
+            atoms[2] = static_cast<float>(infos->getTimeInSeconds().orFallback(0.0));
+            pd->sendMessage("__playhead", "position", atoms);
+            atoms.resize(1);
+        }
+        pd->unlockAudioThread();
+    }
+};
@@ -2,6 +2,17 @@
 #include "ObjectFuzzTest.h"
 #include "HelpfileFuzzTest.h"
 #include "HelpfileErrorTest.h"
+#include "MessageDispatcherTest.h"
+#include "CanvasSynchroniseTest.h"
+#include "ConnectionRouterTest.h"
+#include "AudioMidiFifoTest.h"
+#include "DocumentationSharingTest.h"
+#include "FilesystemExtractionTest.h"
+#include "PlayheadBenchmarkTest.h"
+#include "AudioLevelMeterTest.h"
+#include "MidiTimingTest.h"
+#include "TextRenderBenchmarkTest.h"
+#include "DirectMessageQueueTest.h"
 
 void runTests(PluginEditor* editor)
 {
@@ -10,9 +21,20 @@ void runTests(PluginEditor* editor)
         ObjectFuzzTest objectFuzzer(editor);
         HelpFileFuzzTest helpfileFuzzer(editor);
         HelpFileErrorTest helpfileErrorTest(editor);
+        MessageDispatcherTest messageDispatcherTest(editor);
+        CanvasSynchroniseTest canvasSynchroniseTest(editor);
+        ConnectionRouterTest connectionRouterTest(editor);
+        AudioMidiFifoTest audioMidiFifoTest(editor);
+        DocumentationSharingTest documentationSharingTest(editor);
+        FilesystemExtractionTest filesystemExtractionTest(editor);
+        PlayheadBenchmarkTest playheadBenchmarkTest(editor);
+        AudioLevelMeterTest audioLevelMeterTest(editor);
+        MidiTimingTest midiTimingTest(editor);
+        TextRenderBenchmarkTest textRenderBenchmarkTest(editor);
+        DirectMessageQueueTest directMessageQueueTest(editor);
         
         UnitTestRunner runner;
-        runner.runTests({&helpfileFuzzer, &objectFuzzer, &helpfileErrorTest}, 23);
+        runner.runTests({&messageDispatcherTest, &directMessageQueueTest, &canvasSynchroniseTest, &connectionRouterTest, &audioMidiFifoTest, &documentationSharingTest, &filesystemExtractionTest, &playheadBenchmarkTest, &audioLevelMeterTest, &midiTimingTest, &textRenderBenchmarkTest, &helpfileFuzzer, &objectFuzzer, &helpfileErrorTest}, 23);
     });
     testRunnerThread.detach();
 }
@@ -0,0 +1,69 @@
+class TextRenderBenchmarkTest : public PlugDataUnitTest
+{
+public:
+    TextRenderBenchmarkTest(PluginEditor* editor) : PlugDataUnitTest(editor, "Text Render Benchmark Test")
+    {
+    }
+
+private:
+    static constexpr int numObjects = 5000;
+
+    void perform() override
+    {
+        signalDone(renderLargePatch());
+    }
+
+    // Renders a patch full of object boxes and comments, then zooms it
+    // Text should come from the shared glyph atlas, so rendering it shouldn't create any textures for objects
+    bool renderLargePatch()
+    {
+        beginTest("Render " + String(numObjects) + " text objects");
+
+        String patch = "#N canvas 0 0 1000 1000 12;\n";
+        for(int i = 0; i < numObjects; i++)
+        {
+            auto const position = String((i % 50) * 90) + " " + String((i / 50) * 25);
+            if(i % 2)
+                patch += "#X obj " + position + " osc~ " + String(i) + ";\n";
+            else
+                patch += "#X text " + position + " comment " + String(i) + ";\n";
+        }
+
+        auto& tabbar = editor->getTabComponent();
+        auto* cnv = tabbar.openPatch(patch);
+        setZoom(cnv, 0.5f);
+
+        auto& surface = editor->nvgSurface;
+        auto const imagesBefore = NVGImage::allImages.size();
+
+        auto startTime = Time::getMillisecondCounterHiRes();
+        surface.renderAll();
+        auto const firstPaint = Time::getMillisecondCounterHiRes() - startTime;
+
+        // Every zoom step used to render the text of every object into a new image
+        constexpr int numZoomSteps = 8;
+        startTime = Time::getMillisecondCounterHiRes();
+        for(int step = 0; step < numZoomSteps; step++)
+        {
+            setZoom(cnv, 0.5f + 0.1f * static_cast<float>(step + 1));
+            surface.renderAll();
+        }
+        auto const zoomLatency = (Time::getMillisecondCounterHiRes() - startTime) / numZoomSteps;
+
+        auto const imagesCreated = NVGImage::allImages.size() - std::min(imagesBefore, NVGImage::allImages.size());
+        logMessage(String(firstPaint, 2) + " ms first paint, " + String(zoomLatency, 2) + " ms per zoom step, " + String(imagesCreated) + " images created");
+
+        tabbar.closeTab(cnv);
+
+        // Some objects, like the iolets, can still have images of their own
+        auto const result = imagesCreated < numObjects / 10;
+        expect(result, "Text was rendered into an image per object");
+        return result;
+    }
+
+    static void setZoom(Canvas* cnv, float zoom)
+    {
+        cnv->zoomScale.setValue(zoom);
+        cnv->zoomScale.getValueSource().sendChangeMessage(true);
+    }
+};